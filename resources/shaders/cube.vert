@@ -1,14 +1,17 @@
 #version 460 core
-layout (location = 0) in vec3 aPos;
-layout (location = 1) in vec3 aNormal;
+// PackedVertex: position as UNORM16 over the mesh bounds, normal as SNORM16 octahedral.
+layout (location = 0) in vec4 aPos;
+layout (location = 1) in vec2 aNormal;
 
-struct TransformComponent {
-    mat4 localMatrix;
-    mat4 worldMatrix;
+// Written in draw order by the command gen passes: world matrix rows that also dequantise the
+// position, and normal matrix rows with the object's alpha in normal[0].w.
+struct InstanceData {
+    vec4 world[3];
+    vec4 normal[3];
 };
 
-layout(std430, binding = 2) buffer ObjectBuffer {
-    TransformComponent transforms[];
+layout(std430) readonly buffer InstanceBuffer {
+    InstanceData instances[];
 };
 
 layout (std140, binding = 0) uniform SceneData {
@@ -18,22 +21,31 @@ layout (std140, binding = 0) uniform SceneData {
     vec3 viewPos;
     vec3 lightColor;
     vec4 frustumPlanes[6];
+    vec4 lightGridParams;
+    uvec4 lightGridSize;
+    uint lightCount;
 } sceneData;
 
 out vec3 FragPos;
 out vec3 Normal;
+flat out float Alpha;
 
-layout(std430, binding = 5) readonly buffer VisibleObjectBuffer {
-    uint visibleObjects[];
-};
+vec3 decodeOctahedral(vec2 e) {
+    vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+    float t = max(-n.z, 0.0);
+    n.x += n.x >= 0.0 ? -t : t;
+    n.y += n.y >= 0.0 ? -t : t;
+    return normalize(n);
+}
 
 void main()
 {
-    uint baseInstance = gl_BaseInstance;
-    uint objectId = visibleObjects[baseInstance + gl_InstanceID];
-    mat4 modelMatrix = transforms[objectId].worldMatrix;
-    vec4 worldPos = modelMatrix * vec4(aPos, 1.0);
+    InstanceData instance = instances[gl_BaseInstance + gl_InstanceID];
+    vec4 position = vec4(aPos.xyz, 1.0);
+    vec4 worldPos = vec4(dot(instance.world[0], position), dot(instance.world[1], position), dot(instance.world[2], position), 1.0);
     FragPos = worldPos.xyz;
-    Normal = mat3(transpose(inverse(modelMatrix))) * aNormal;
+    vec3 normal = decodeOctahedral(aNormal);
+    Normal = vec3(dot(instance.normal[0].xyz, normal), dot(instance.normal[1].xyz, normal), dot(instance.normal[2].xyz, normal));
+    Alpha = instance.normal[0].w;
     gl_Position = sceneData.projection * sceneData.view * worldPos;
-}
\ No newline at end of file
+}
@@ -1,8 +0,0 @@
-#version 430 core
-
-layout(location = 0) out float FragColor;
-
-void main()
-{
-    FragColor = gl_FragCoord.z;
-}
\ No newline at end of file
@@ -0,0 +1,10 @@
+#version 460 core
+
+uniform sampler2D u_sceneColor;
+
+out vec4 FragColor;
+
+void main()
+{
+    FragColor = texelFetch(u_sceneColor, ivec2(gl_FragCoord.xy), 0);
+}
@@ -7,14 +7,64 @@ layout (std140, binding = 0) uniform SceneData {
     vec3 viewPos;
     vec3 lightColor;
     vec4 frustumPlanes[6];
+    vec4 lightGridParams;
+    uvec4 lightGridSize;
+    uint lightCount;
 } sceneData;
 
+struct PointLight {
+    vec4 positionRadius;
+    vec4 colorIntensity;
+};
+
+layout(std430) readonly buffer LightBuffer {
+    PointLight lights[];
+};
+
+layout(std430) readonly buffer FroxelLightCountBuffer {
+    uint froxelLightCounts[];
+};
+
+layout(std430) readonly buffer FroxelLightIndexBuffer {
+    uint froxelLightIndices[];
+};
+
 
 out vec4 FragColor;
 
 in vec3 Normal;
 in vec3 FragPos;
 
+// Point lights binned by light_bin.comp; same as cube.frag.
+uint froxelIndex(vec3 worldPos) {
+    uvec3 grid = sceneData.lightGridSize.xyz;
+    float viewDepth = max(-(sceneData.view * vec4(worldPos, 1.0)).z, sceneData.lightGridParams.x);
+    float slice = log2(viewDepth / sceneData.lightGridParams.x) / sceneData.lightGridParams.y * float(grid.z);
+    uvec2 tile = uvec2(gl_FragCoord.xy / sceneData.lightGridParams.zw * vec2(grid.xy));
+    uvec3 cell = min(uvec3(tile, uint(slice)), grid - 1u);
+    return (cell.z * grid.y + cell.y) * grid.x + cell.x;
+}
+
+vec3 shadePointLights(vec3 worldPos, vec3 norm, vec3 viewDir) {
+    uint froxel = froxelIndex(worldPos);
+    uint capacity = sceneData.lightGridSize.w;
+    uint count = min(froxelLightCounts[froxel], capacity);
+    vec3 result = vec3(0.0);
+    for (uint i = 0; i < count; ++i) {
+        PointLight light = lights[froxelLightIndices[froxel * capacity + i]];
+        vec3 toLight = light.positionRadius.xyz - worldPos;
+        float lightDistance = length(toLight);
+        float falloff = clamp(1.0 - lightDistance / light.positionRadius.w, 0.0, 1.0);
+        if (falloff <= 0.0) continue;
+
+        vec3 lightDir = toLight / max(lightDistance, 1e-4);
+        float diff = max(dot(norm, lightDir), 0.0);
+        float spec = pow(max(dot(viewDir, reflect(-lightDir, norm)), 0.0), 32);
+        result += (diff + 0.5 * spec) * falloff * falloff * light.colorIntensity.rgb * light.colorIntensity.w;
+    }
+    return result;
+}
+
 void main()
 {
     float ambientStrength = 0.1;
@@ -31,8 +81,10 @@ void main()
     float spec = pow(max(dot(viewDir, reflectDir), 0.0), 32);
     vec3 specular = specularStrength * spec * sceneData.lightColor;
 
+    vec3 pointLights = shadePointLights(FragPos, norm, viewDir);
+
     vec3 color = vec3(1.0, 0.0, 0.0);
 
-    vec3 result = (ambient + diffuse + specular) * color;
+    vec3 result = (ambient + diffuse + specular + pointLights) * color;
     FragColor = vec4(result, 1.0);
 }
\ No newline at end of file
@@ -32,11 +32,11 @@ export class Application {
     Entity m_parentEntity;
     std::string m_frameTimeText;
     std::string m_smallObjectThresholdText;
-    std::string m_largeObjectThresholdText;
 
     float m_textUpdateTimer = 0.0f;
     float m_nearPlane = 0.1f;
     float m_farPlane = 1000.0f;
     float m_smallObjectThreshold = 0.005f;
-    float m_largeObjectThreshold = 0.05f;
+    bool m_cpuTransforms = false;
+    bool m_validateTransforms = false;
 };
\ No newline at end of file
@@ -8,6 +8,7 @@ module;
 module Editor.application;
 
 import Engine.engine;
+import Engine.renderer;
 import Engine.mesh;
 import Engine.Render.scenedatabase;
 import Engine.Render.component;
@@ -74,12 +75,12 @@ Application::Application() {
     std::uniform_real_distribution<float> distribPos(-180.0f, 180.0f);
     std::uniform_int_distribution<unsigned int> distribMesh(0, 1);
 
+    const Entity firstEntity = m_sceneDatabase.createEntities(numObjects);
     for (int i = 0; i < numObjects; ++i) {
-        auto entity = m_sceneDatabase.createEntity();
+        const auto entity = static_cast<Entity>(firstEntity + i);
 
         glm::vec3 position(distribPos(gen), distribPos(gen), distribPos(gen));
-        glm::mat4 model = glm::translate(glm::mat4(1.0f), position);
-        m_sceneDatabase.transforms[entity].localMatrix = model;
+        m_sceneDatabase.transforms[entity].translation = position;
 
         m_sceneDatabase.renderables[entity].mesh_uuid = distribMesh(gen);
         m_sceneDatabase.renderables[entity].material_uuid = 0;
@@ -88,16 +89,30 @@ Application::Application() {
         m_sceneDatabase.renderables[entity].alpha = 1.0f;
     }
 
+    const int numLights = 4096;
+    std::uniform_real_distribution<float> distribColor(0.2f, 1.0f);
+    m_sceneDatabase.lights.resize(numLights);
+    for (PointLight& light : m_sceneDatabase.lights) {
+        light.position = glm::vec3(distribPos(gen), distribPos(gen), distribPos(gen));
+        light.radius = 15.0f;
+        light.color = glm::vec3(distribColor(gen), distribColor(gen), distribColor(gen));
+        light.intensity = 2.0f;
+    }
+
     m_parentEntity = m_sceneDatabase.createEntity();
-    m_sceneDatabase.transforms[m_parentEntity].localMatrix = glm::mat4(1.0f);
+    m_sceneDatabase.transforms[m_parentEntity].translation = glm::vec3(0.0f);
     m_sceneDatabase.renderables[m_parentEntity].mesh_uuid = 0;
     m_sceneDatabase.renderables[m_parentEntity].material_uuid = 0;
     m_sceneDatabase.renderables[m_parentEntity].shaderId = 0;
 
     for (int i = 0; i < numObjects / 2; ++i) {
-        m_sceneDatabase.hierarchies[i].parent = m_parentEntity;
+        m_sceneDatabase.setParent(static_cast<Entity>(i), m_parentEntity);
     }
-    m_sceneDatabase.markHierarchyDirty();
+
+    // Lay the scene out in hierarchy order; the parent is found again through its handle.
+    const EntityHandle parentHandle = m_sceneDatabase.getHandle(m_parentEntity);
+    m_sceneDatabase.defragment();
+    m_parentEntity = m_sceneDatabase.resolve(parentHandle);
 
     camera.setFarPlane(1000.0f);
 
@@ -120,7 +135,6 @@ void Application::update() {
     processInput(deltaTime);
 
     m_engine.setSmallObjectThreshold(m_smallObjectThreshold);
-    m_engine.setLargeObjectThreshold(m_largeObjectThreshold);
 
     m_engine.update(m_sceneDatabase, camera);
 
@@ -128,13 +142,11 @@ void Application::update() {
     if (m_textUpdateTimer >= 0.5f) {
         m_frameTimeText = "Frame time: " + std::to_string(deltaTime * 1000.0f) + " ms (" + std::to_string(1.0f / deltaTime) + " FPS)";
         m_smallObjectThresholdText = "smallObjectThreshold: " + std::to_string(m_smallObjectThreshold);
-        m_largeObjectThresholdText = "largeObjectThreshold: " + std::to_string(m_largeObjectThreshold);
 
         m_textUpdateTimer = 0.0f;
     }
     m_engine.AddText(m_frameTimeText, 10.0f, 690.0f, 0.5f, glm::vec3(1.0f, 1.0f, 1.0f));
     m_engine.AddText(m_smallObjectThresholdText, 10.0f, 670.0f, 0.5f, glm::vec3(1.0f, 1.0f, 1.0f));
-    m_engine.AddText(m_largeObjectThresholdText, 10.0f, 650.0f, 0.5f, glm::vec3(1.0f, 1.0f, 1.0f));
 
     InputManager::Update();
     glfwSwapBuffers(m_window);
@@ -167,39 +179,32 @@ void Application::processInput(float deltaTime) {
 
     bool dataChanged = false;
     if (InputManager::IsKeyHeld(GLFW_KEY_J)) {
-        m_sceneDatabase.transforms[m_parentEntity].localMatrix =
-            glm::translate(m_sceneDatabase.transforms[m_parentEntity].localMatrix, glm::vec3(-10.0f * deltaTime, 0.0f, 0.0f));
+        m_sceneDatabase.transforms[m_parentEntity].translation += glm::vec3(-10.0f * deltaTime, 0.0f, 0.0f);
         dataChanged = true;
     }
     if (InputManager::IsKeyHeld(GLFW_KEY_L)) {
-        m_sceneDatabase.transforms[m_parentEntity].localMatrix =
-            glm::translate(m_sceneDatabase.transforms[m_parentEntity].localMatrix, glm::vec3(10.0f * deltaTime, 0.0f, 0.0f));
+        m_sceneDatabase.transforms[m_parentEntity].translation += glm::vec3(10.0f * deltaTime, 0.0f, 0.0f);
         dataChanged = true;
     }
     if (InputManager::IsKeyHeld(GLFW_KEY_I)) {
-        m_sceneDatabase.transforms[m_parentEntity].localMatrix =
-            glm::translate(m_sceneDatabase.transforms[m_parentEntity].localMatrix, glm::vec3(0.0f, 0.0f, -10.0f * deltaTime));
+        m_sceneDatabase.transforms[m_parentEntity].translation += glm::vec3(0.0f, 0.0f, -10.0f * deltaTime);
         dataChanged = true;
     }
     if (InputManager::IsKeyHeld(GLFW_KEY_K)) {
-        m_sceneDatabase.transforms[m_parentEntity].localMatrix =
-            glm::translate(m_sceneDatabase.transforms[m_parentEntity].localMatrix, glm::vec3(0.0f, 0.0f, 10.0f * deltaTime));
+        m_sceneDatabase.transforms[m_parentEntity].translation += glm::vec3(0.0f, 0.0f, 10.0f * deltaTime);
         dataChanged = true;
     }
     if (InputManager::IsKeyHeld(GLFW_KEY_U)) {
-        m_sceneDatabase.transforms[m_parentEntity].localMatrix =
-            glm::translate(m_sceneDatabase.transforms[m_parentEntity].localMatrix, glm::vec3(0.0f, 10.0f * deltaTime, 0.0f));
+        m_sceneDatabase.transforms[m_parentEntity].translation += glm::vec3(0.0f, 10.0f * deltaTime, 0.0f);
         dataChanged = true;
     }
     if (InputManager::IsKeyHeld(GLFW_KEY_O)) {
-        m_sceneDatabase.transforms[m_parentEntity].localMatrix =
-            glm::translate(m_sceneDatabase.transforms[m_parentEntity].localMatrix, glm::vec3(0.0f, -10.0f * deltaTime, 0.0f));
+        m_sceneDatabase.transforms[m_parentEntity].translation += glm::vec3(0.0f, -10.0f * deltaTime, 0.0f);
         dataChanged = true;
     }
 
     if (dataChanged) {
-        m_sceneDatabase.markDataDirty();
-        Lit::Log::Info("markDataDirty() called due to input.");
+        m_sceneDatabase.markTransformDirty(m_parentEntity);
     }
 
     if (InputManager::IsKeyPressed(GLFW_KEY_1)) {
@@ -214,16 +219,15 @@ void Application::processInput(float deltaTime) {
         Lit::Log::Info("smallObjectThreshold: {}", m_smallObjectThreshold);
     }
 
-    if (InputManager::IsKeyPressed(GLFW_KEY_3)) {
-        m_largeObjectThreshold -= 0.01f;
-        if (m_largeObjectThreshold < 0.0f) {
-            m_largeObjectThreshold = 0.0f;
-        }
-        Lit::Log::Info("largeObjectThreshold: {}", m_largeObjectThreshold);
+    if (InputManager::IsKeyPressed(GLFW_KEY_B)) {
+        m_cpuTransforms = !m_cpuTransforms;
+        m_engine.setTransformBackend(m_cpuTransforms ? TransformBackend::Cpu : TransformBackend::Gpu);
+        Lit::Log::Info("Transform backend: {}", m_cpuTransforms ? "CPU" : "GPU");
     }
-    if (InputManager::IsKeyPressed(GLFW_KEY_4)) {
-        m_largeObjectThreshold += 0.01f;
-        Lit::Log::Info("largeObjectThreshold: {}", m_largeObjectThreshold);
+    if (InputManager::IsKeyPressed(GLFW_KEY_V)) {
+        m_validateTransforms = !m_validateTransforms;
+        m_engine.setTransformValidation(m_validateTransforms);
+        Lit::Log::Info("Transform validation: {}", m_validateTransforms ? "on" : "off");
     }
 
     glm::vec2 mouseDelta = InputManager::GetMouseDelta();
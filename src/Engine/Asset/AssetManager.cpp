@@ -9,18 +9,46 @@ module;
 #include <vector>
 #include <optional>
 #include <fstream>
+#include <span>
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <unordered_map>
 
 module Engine.asset;
 import Engine.mesh;
+import Engine.glm;
 
 namespace {
 
 struct AssetHeader {
     uint64_t vertexCount;
     uint64_t indexCount;
+    uint64_t meshletCount;
+    uint64_t lodCount;
+    // 2 when every index fits in 16 bits, 4 otherwise.
+    uint32_t indexSize;
+    float positionOffset[3];
+    float positionScale[3];
 };
 
+// Position followed by normal, as written by processMesh(). Meshlets and LODs are built from these
+// full-precision vertices; only the packed form is stored.
+constexpr size_t VERTEX_STRIDE = 6;
+constexpr size_t MESHLET_MAX_VERTICES = 64;
+constexpr size_t MESHLET_MAX_TRIANGLES = 124;
+// LOD 1 clusters vertices on a grid this many cells across the mesh; each further LOD halves it.
+constexpr uint32_t LOD_BASE_GRID_RESOLUTION = 32;
+// A level removing less than this fraction of the previous level's triangles ends the chain.
+constexpr float LOD_MIN_REDUCTION = 0.25f;
+// FIFO post-transform cache size optimizeVertexCache() plans for.
+constexpr uint32_t VERTEX_CACHE_SIZE = 16;
+
 void processMesh(aiMesh* mesh, std::vector<float>& vertices, std::vector<unsigned int>& indices) {
+    const unsigned int baseVertex = static_cast<unsigned int>(vertices.size() / VERTEX_STRIDE);
     for (unsigned int i = 0; i < mesh->mNumVertices; i++) {
         vertices.push_back(mesh->mVertices[i].x);
         vertices.push_back(mesh->mVertices[i].y);
@@ -35,9 +63,480 @@ void processMesh(aiMesh* mesh, std::vector<float>& vertices, std::vector<unsigne
     for (unsigned int i = 0; i < mesh->mNumFaces; i++) {
         aiFace face = mesh->mFaces[i];
         for (unsigned int j = 0; j < face.mNumIndices; j++) {
-            indices.push_back(face.mIndices[j]);
+            indices.push_back(baseVertex + face.mIndices[j]);
+        }
+    }
+}
+
+glm::vec3 vertexPosition(const std::vector<float>& vertices, unsigned int index) {
+    return glm::vec3(vertices[index * VERTEX_STRIDE], vertices[index * VERTEX_STRIDE + 1], vertices[index * VERTEX_STRIDE + 2]);
+}
+
+// Merges vertices whose position and normal are bitwise equal, across all of the scene's meshes.
+// Components are ordered by bit pattern, so -0.0 and 0.0 stay apart and NaNs still sort.
+void weldVertices(std::vector<float>& vertices, std::vector<unsigned int>& indices) {
+    const size_t vertexCount = vertices.size() / VERTEX_STRIDE;
+    auto vertexLess = [&](uint32_t a, uint32_t b) {
+        return std::lexicographical_compare(vertices.begin() + a * VERTEX_STRIDE, vertices.begin() + (a + 1) * VERTEX_STRIDE, vertices.begin() + b * VERTEX_STRIDE,
+                                            vertices.begin() + (b + 1) * VERTEX_STRIDE,
+                                            [](float x, float y) { return std::bit_cast<uint32_t>(x) < std::bit_cast<uint32_t>(y); });
+    };
+
+    std::vector<uint32_t> order(vertexCount);
+    std::iota(order.begin(), order.end(), 0u);
+    std::sort(order.begin(), order.end(), vertexLess);
+
+    std::vector<unsigned int> remap(vertexCount);
+    std::vector<float> welded;
+    welded.reserve(vertices.size());
+    for (size_t i = 0; i < vertexCount; ++i) {
+        const uint32_t vertex = order[i];
+        if (i == 0 || vertexLess(order[i - 1], vertex)) {
+            welded.insert(welded.end(), vertices.begin() + vertex * VERTEX_STRIDE, vertices.begin() + (vertex + 1) * VERTEX_STRIDE);
+        }
+        remap[vertex] = static_cast<unsigned int>(welded.size() / VERTEX_STRIDE - 1);
+    }
+
+    for (unsigned int& index : indices) {
+        index = remap[index];
+    }
+    vertices = std::move(welded);
+}
+
+// Bounding sphere around the meshlet's vertices and a cone around its triangle normals. A cutoff
+// of 1 marks a cone too wide to ever reject the meshlet.
+Meshlet computeMeshletBounds(const std::vector<float>& vertices, std::span<const unsigned int> meshletVertices, std::span<const unsigned int> meshletIndices, uint32_t firstIndex) {
+    glm::vec3 center(0.0f);
+    for (unsigned int vertex : meshletVertices) {
+        center = center + vertexPosition(vertices, vertex);
+    }
+    center = center / static_cast<float>(meshletVertices.size());
+
+    float radius = 0.0f;
+    for (unsigned int vertex : meshletVertices) {
+        radius = std::max(radius, glm::distance(center, vertexPosition(vertices, vertex)));
+    }
+
+    std::vector<glm::vec3> normals;
+    glm::vec3 normalSum(0.0f);
+    for (size_t i = 0; i + 2 < meshletIndices.size(); i += 3) {
+        const glm::vec3 a = vertexPosition(vertices, meshletIndices[i]);
+        const glm::vec3 b = vertexPosition(vertices, meshletIndices[i + 1]);
+        const glm::vec3 c = vertexPosition(vertices, meshletIndices[i + 2]);
+        const glm::vec3 normal = glm::cross(b - a, c - a);
+        const float area = glm::length(normal);
+        if (area > 0.0f) {
+            normals.push_back(normal / area);
+            normalSum = normalSum + normal / area;
+        }
+    }
+
+    glm::vec4 cone(0.0f, 0.0f, 0.0f, 1.0f);
+    const float sumLength = glm::length(normalSum);
+    if (sumLength > 0.0f) {
+        const glm::vec3 axis = normalSum / sumLength;
+        float minDot = 1.0f;
+        for (const glm::vec3& normal : normals) {
+            minDot = std::min(minDot, glm::dot(normal, axis));
+        }
+        // Past roughly 84 degrees of spread the cone would almost never reject anything.
+        if (minDot > 0.1f) {
+            cone = glm::vec4(axis, std::sqrt(1.0f - minDot * minDot));
+        }
+    }
+
+    return Meshlet{.boundingSphere = glm::vec4(center, radius),
+                   .cone = cone,
+                   .firstIndex = firstIndex,
+                   .indexCount = static_cast<uint32_t>(meshletIndices.size())};
+}
+
+// Splits the mesh into meshlets of at most MESHLET_MAX_VERTICES unique vertices and
+// MESHLET_MAX_TRIANGLES triangles and rewrites `indices` so each meshlet is a contiguous range.
+// A meshlet grows by the unassigned triangle that adds the fewest new vertices among those
+// touching it, which keeps clusters compact and their bounds tight.
+std::vector<Meshlet> buildMeshlets(const std::vector<float>& vertices, std::vector<unsigned int>& indices) {
+    const size_t vertexCount = vertices.size() / VERTEX_STRIDE;
+    const size_t triangleCount = indices.size() / 3;
+
+    // Triangles touching each vertex: vertex v owns [adjacencyOffsets[v], adjacencyOffsets[v + 1]).
+    std::vector<uint32_t> adjacencyOffsets(vertexCount + 1, 0);
+    for (size_t i = 0; i < triangleCount * 3; ++i) {
+        adjacencyOffsets[indices[i] + 1]++;
+    }
+    for (size_t v = 0; v < vertexCount; ++v) {
+        adjacencyOffsets[v + 1] += adjacencyOffsets[v];
+    }
+    std::vector<uint32_t> adjacency(adjacencyOffsets.back());
+    std::vector<uint32_t> adjacencyCursors(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+    for (size_t triangle = 0; triangle < triangleCount; ++triangle) {
+        for (size_t corner = 0; corner < 3; ++corner) {
+            adjacency[adjacencyCursors[indices[triangle * 3 + corner]]++] = static_cast<uint32_t>(triangle);
+        }
+    }
+
+    std::vector<bool> assigned(triangleCount, false);
+    std::vector<bool> inMeshlet(vertexCount, false);
+    std::vector<unsigned int> meshletVertices;
+    std::vector<uint32_t> meshletTriangles;
+    std::vector<unsigned int> reordered;
+    reordered.reserve(triangleCount * 3);
+    std::vector<Meshlet> meshlets;
+
+    auto newVertexCount = [&](uint32_t triangle) {
+        size_t count = 0;
+        for (size_t corner = 0; corner < 3; ++corner) {
+            const unsigned int vertex = indices[triangle * 3 + corner];
+            // A degenerate triangle repeats a vertex; count it once.
+            const bool repeated = (corner > 0 && indices[triangle * 3] == vertex) || (corner > 1 && indices[triangle * 3 + 1] == vertex);
+            if (!inMeshlet[vertex] && !repeated) {
+                count++;
+            }
+        }
+        return count;
+    };
+
+    auto flushMeshlet = [&]() {
+        if (meshletTriangles.empty()) {
+            return;
+        }
+        const uint32_t firstIndex = static_cast<uint32_t>(reordered.size());
+        for (uint32_t triangle : meshletTriangles) {
+            reordered.insert(reordered.end(), indices.begin() + triangle * 3, indices.begin() + triangle * 3 + 3);
+        }
+        meshlets.push_back(computeMeshletBounds(vertices, meshletVertices, std::span<const unsigned int>(reordered).subspan(firstIndex), firstIndex));
+
+        for (unsigned int vertex : meshletVertices) {
+            inMeshlet[vertex] = false;
+        }
+        meshletVertices.clear();
+        meshletTriangles.clear();
+    };
+
+    size_t nextSeed = 0;
+    while (true) {
+        int64_t best = -1;
+        size_t bestNewVertices = 4;
+        for (unsigned int vertex : meshletVertices) {
+            for (uint32_t i = adjacencyOffsets[vertex]; i < adjacencyOffsets[vertex + 1]; ++i) {
+                const uint32_t triangle = adjacency[i];
+                if (assigned[triangle]) {
+                    continue;
+                }
+                const size_t newVertices = newVertexCount(triangle);
+                if (newVertices < bestNewVertices) {
+                    best = triangle;
+                    bestNewVertices = newVertices;
+                }
+            }
+        }
+
+        // Nothing left around the current meshlet: continue from the next unassigned triangle.
+        if (best < 0) {
+            while (nextSeed < triangleCount && assigned[nextSeed]) {
+                nextSeed++;
+            }
+            if (nextSeed == triangleCount) {
+                break;
+            }
+            best = static_cast<int64_t>(nextSeed);
+            bestNewVertices = newVertexCount(static_cast<uint32_t>(best));
+        }
+
+        if (meshletVertices.size() + bestNewVertices > MESHLET_MAX_VERTICES || meshletTriangles.size() == MESHLET_MAX_TRIANGLES) {
+            flushMeshlet();
+        }
+
+        const uint32_t triangle = static_cast<uint32_t>(best);
+        assigned[triangle] = true;
+        meshletTriangles.push_back(triangle);
+        for (size_t corner = 0; corner < 3; ++corner) {
+            const unsigned int vertex = indices[triangle * 3 + corner];
+            if (!inMeshlet[vertex]) {
+                inMeshlet[vertex] = true;
+                meshletVertices.push_back(vertex);
+            }
         }
     }
+    flushMeshlet();
+
+    indices = std::move(reordered);
+    return meshlets;
+}
+
+// Sander et al.'s overdraw ordering applied to meshlets: clusters whose average normal points away
+// from the mesh centre come first, since on mostly convex shapes they occlude the others. Rewrites
+// `indices` and the meshlets' firstIndex to match.
+void orderMeshletsForOverdraw(const std::vector<float>& vertices, std::vector<unsigned int>& indices, std::vector<Meshlet>& meshlets) {
+    if (meshlets.size() < 2) {
+        return;
+    }
+
+    std::vector<glm::vec3> centers(meshlets.size(), glm::vec3(0.0f));
+    std::vector<glm::vec3> normals(meshlets.size(), glm::vec3(0.0f));
+    glm::vec3 meshCenter(0.0f);
+    float meshArea = 0.0f;
+    for (size_t m = 0; m < meshlets.size(); ++m) {
+        float area = 0.0f;
+        for (uint32_t i = meshlets[m].firstIndex; i + 2 < meshlets[m].firstIndex + meshlets[m].indexCount; i += 3) {
+            const glm::vec3 a = vertexPosition(vertices, indices[i]);
+            const glm::vec3 b = vertexPosition(vertices, indices[i + 1]);
+            const glm::vec3 c = vertexPosition(vertices, indices[i + 2]);
+            const glm::vec3 normal = glm::cross(b - a, c - a);
+            const float triangleArea = glm::length(normal);
+            centers[m] = centers[m] + (a + b + c) * (triangleArea / 3.0f);
+            normals[m] = normals[m] + normal;
+            area += triangleArea;
+        }
+        meshCenter = meshCenter + centers[m];
+        meshArea += area;
+        centers[m] = area > 0.0f ? centers[m] / area : glm::vec3(meshlets[m].boundingSphere.x, meshlets[m].boundingSphere.y, meshlets[m].boundingSphere.z);
+    }
+    if (meshArea > 0.0f) {
+        meshCenter = meshCenter / meshArea;
+    }
+
+    std::vector<float> scores(meshlets.size(), 0.0f);
+    for (size_t m = 0; m < meshlets.size(); ++m) {
+        const float normalLength = glm::length(normals[m]);
+        if (normalLength > 0.0f) {
+            scores[m] = glm::dot(centers[m] - meshCenter, normals[m] / normalLength);
+        }
+    }
+
+    std::vector<uint32_t> order(meshlets.size());
+    std::iota(order.begin(), order.end(), 0u);
+    std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return scores[a] > scores[b]; });
+
+    std::vector<unsigned int> reordered;
+    reordered.reserve(indices.size());
+    std::vector<Meshlet> sorted;
+    sorted.reserve(meshlets.size());
+    for (uint32_t m : order) {
+        Meshlet meshlet = meshlets[m];
+        reordered.insert(reordered.end(), indices.begin() + meshlet.firstIndex, indices.begin() + meshlet.firstIndex + meshlet.indexCount);
+        meshlet.firstIndex = static_cast<uint32_t>(reordered.size() - meshlet.indexCount);
+        sorted.push_back(meshlet);
+    }
+    indices = std::move(reordered);
+    meshlets = std::move(sorted);
+}
+
+// Tipsify (Sander et al.): fans around a vertex whose remaining triangles should still find it in
+// a cache of VERTEX_CACHE_SIZE entries, falling back to recently used vertices and then to any
+// unfinished one at dead ends. Reorders the triangles of `indices` in place without changing the
+// set of vertices it touches, so meshlet and LOD ranges stay intact.
+void optimizeVertexCache(std::span<unsigned int> indices) {
+    const size_t triangleCount = indices.size() / 3;
+    if (triangleCount < 2) {
+        return;
+    }
+
+    // Work on dense local vertex ids so a small range does not pay for the whole mesh.
+    std::vector<unsigned int> rangeVertices(indices.begin(), indices.end());
+    std::sort(rangeVertices.begin(), rangeVertices.end());
+    rangeVertices.erase(std::unique(rangeVertices.begin(), rangeVertices.end()), rangeVertices.end());
+    const size_t vertexCount = rangeVertices.size();
+    std::vector<uint32_t> local(triangleCount * 3);
+    for (size_t i = 0; i < local.size(); ++i) {
+        local[i] = static_cast<uint32_t>(std::lower_bound(rangeVertices.begin(), rangeVertices.end(), indices[i]) - rangeVertices.begin());
+    }
+
+    std::vector<uint32_t> adjacencyOffsets(vertexCount + 1, 0);
+    for (uint32_t vertex : local) {
+        adjacencyOffsets[vertex + 1]++;
+    }
+    for (size_t v = 0; v < vertexCount; ++v) {
+        adjacencyOffsets[v + 1] += adjacencyOffsets[v];
+    }
+    std::vector<uint32_t> adjacency(adjacencyOffsets.back());
+    std::vector<uint32_t> adjacencyCursors(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+    for (size_t i = 0; i < local.size(); ++i) {
+        adjacency[adjacencyCursors[local[i]]++] = static_cast<uint32_t>(i / 3);
+    }
+
+    std::vector<uint32_t> liveTriangles(vertexCount);
+    for (size_t v = 0; v < vertexCount; ++v) {
+        liveTriangles[v] = adjacencyOffsets[v + 1] - adjacencyOffsets[v];
+    }
+    std::vector<uint32_t> cacheTimestamps(vertexCount, 0);
+    std::vector<bool> emitted(triangleCount, false);
+    std::vector<uint32_t> deadEnd;
+    std::vector<uint32_t> candidates;
+    std::vector<unsigned int> reordered;
+    reordered.reserve(triangleCount * 3);
+
+    uint32_t timestamp = VERTEX_CACHE_SIZE + 1;
+    size_t cursor = 0;
+    int64_t fanningVertex = 0;
+    while (fanningVertex >= 0) {
+        candidates.clear();
+        const uint32_t fan = static_cast<uint32_t>(fanningVertex);
+        for (uint32_t i = adjacencyOffsets[fan]; i < adjacencyOffsets[fan + 1]; ++i) {
+            const uint32_t triangle = adjacency[i];
+            if (emitted[triangle]) {
+                continue;
+            }
+            emitted[triangle] = true;
+            for (size_t corner = 0; corner < 3; ++corner) {
+                const uint32_t vertex = local[triangle * 3 + corner];
+                reordered.push_back(indices[triangle * 3 + corner]);
+                deadEnd.push_back(vertex);
+                candidates.push_back(vertex);
+                liveTriangles[vertex]--;
+                if (timestamp - cacheTimestamps[vertex] > VERTEX_CACHE_SIZE) {
+                    cacheTimestamps[vertex] = timestamp++;
+                }
+            }
+        }
+
+        // Among the fan's vertices that still have triangles, prefer the oldest one that stays
+        // cached through its remaining triangles.
+        fanningVertex = -1;
+        int64_t bestPriority = -1;
+        for (uint32_t vertex : candidates) {
+            if (liveTriangles[vertex] == 0) {
+                continue;
+            }
+            int64_t priority = 0;
+            if (timestamp - cacheTimestamps[vertex] + 2 * liveTriangles[vertex] <= VERTEX_CACHE_SIZE) {
+                priority = timestamp - cacheTimestamps[vertex];
+            }
+            if (priority > bestPriority) {
+                bestPriority = priority;
+                fanningVertex = vertex;
+            }
+        }
+
+        while (fanningVertex < 0 && !deadEnd.empty()) {
+            const uint32_t vertex = deadEnd.back();
+            deadEnd.pop_back();
+            if (liveTriangles[vertex] > 0) {
+                fanningVertex = vertex;
+            }
+        }
+        while (fanningVertex < 0 && cursor < vertexCount) {
+            if (liveTriangles[cursor] > 0) {
+                fanningVertex = static_cast<int64_t>(cursor);
+            } else {
+                cursor++;
+            }
+        }
+    }
+
+    std::copy(reordered.begin(), reordered.end(), indices.begin());
+}
+
+// Renumbers vertices in order of first use so vertex fetches walk the buffer forwards, dropping
+// any vertex no index refers to.
+void optimizeVertexFetch(std::vector<float>& vertices, std::vector<unsigned int>& indices) {
+    constexpr unsigned int UNUSED = std::numeric_limits<unsigned int>::max();
+    std::vector<unsigned int> remap(vertices.size() / VERTEX_STRIDE, UNUSED);
+    std::vector<float> reordered;
+    reordered.reserve(vertices.size());
+    for (unsigned int& index : indices) {
+        if (remap[index] == UNUSED) {
+            remap[index] = static_cast<unsigned int>(reordered.size() / VERTEX_STRIDE);
+            reordered.insert(reordered.end(), vertices.begin() + index * VERTEX_STRIDE, vertices.begin() + (index + 1) * VERTEX_STRIDE);
+        }
+        index = remap[index];
+    }
+    vertices = std::move(reordered);
+}
+
+// Vertex clustering: every corner is replaced by the first vertex found in its grid cell and
+// triangles that collapse are dropped. The survivors are existing vertices, so all LODs share the
+// mesh's vertex data.
+std::vector<unsigned int> simplifyByClustering(const std::vector<float>& vertices, std::span<const unsigned int> indices, uint32_t gridResolution) {
+    glm::vec3 minBounds(std::numeric_limits<float>::max());
+    glm::vec3 maxBounds(std::numeric_limits<float>::lowest());
+    for (unsigned int vertex : indices) {
+        minBounds = glm::min(minBounds, vertexPosition(vertices, vertex));
+        maxBounds = glm::max(maxBounds, vertexPosition(vertices, vertex));
+    }
+
+    const glm::vec3 extent = maxBounds - minBounds;
+    const float cellSize = std::max({extent.x, extent.y, extent.z}) / static_cast<float>(gridResolution);
+    if (!(cellSize > 0.0f)) {
+        return {};
+    }
+
+    std::unordered_map<uint64_t, unsigned int> representatives;
+    auto representative = [&](unsigned int vertex) {
+        const glm::vec3 cell = (vertexPosition(vertices, vertex) - minBounds) / cellSize;
+        const uint64_t x = std::min(static_cast<uint64_t>(cell.x), uint64_t{gridResolution});
+        const uint64_t y = std::min(static_cast<uint64_t>(cell.y), uint64_t{gridResolution});
+        const uint64_t z = std::min(static_cast<uint64_t>(cell.z), uint64_t{gridResolution});
+        return representatives.try_emplace((x << 42) | (y << 21) | z, vertex).first->second;
+    };
+
+    std::vector<unsigned int> simplified;
+    for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+        const unsigned int a = representative(indices[i]);
+        const unsigned int b = representative(indices[i + 1]);
+        const unsigned int c = representative(indices[i + 2]);
+        if (a != b && b != c && a != c) {
+            simplified.insert(simplified.end(), {a, b, c});
+        }
+    }
+    return simplified;
+}
+
+// Appends up to MAX_MESH_LODS - 1 coarser levels after the full mesh, each simplified from the
+// one before, and stops early once a level no longer pays for itself.
+std::vector<MeshLod> buildLods(const std::vector<float>& vertices, std::vector<unsigned int>& indices) {
+    std::vector<MeshLod> lods = {{.firstIndex = 0, .indexCount = static_cast<uint32_t>(indices.size())}};
+    for (uint32_t level = 1; level < MAX_MESH_LODS; ++level) {
+        const MeshLod previous = lods.back();
+        std::vector<unsigned int> simplified = simplifyByClustering(vertices, std::span<const unsigned int>(indices).subspan(previous.firstIndex, previous.indexCount), LOD_BASE_GRID_RESOLUTION >> (level - 1));
+        if (simplified.empty() || static_cast<float>(simplified.size()) > static_cast<float>(previous.indexCount) * (1.0f - LOD_MIN_REDUCTION)) {
+            break;
+        }
+        lods.push_back({.firstIndex = static_cast<uint32_t>(indices.size()), .indexCount = static_cast<uint32_t>(simplified.size())});
+        indices.insert(indices.end(), simplified.begin(), simplified.end());
+    }
+    return lods;
+}
+
+// Maps the unit normal onto the octahedron |x| + |y| + |z| = 1 and unfolds the lower half over
+// the diagonals, giving a point in [-1, 1]^2; cube.vert inverts this.
+glm::vec2 encodeOctahedral(glm::vec3 normal) {
+    normal = normal / (std::abs(normal.x) + std::abs(normal.y) + std::abs(normal.z));
+    if (normal.z >= 0.0f) {
+        return glm::vec2(normal.x, normal.y);
+    }
+    return glm::vec2((1.0f - std::abs(normal.y)) * (normal.x >= 0.0f ? 1.0f : -1.0f), (1.0f - std::abs(normal.x)) * (normal.y >= 0.0f ? 1.0f : -1.0f));
+}
+
+// Quantises positions over the bounding box of the vertices, returning the box through
+// positionOffset and positionScale so the mesh can decode them.
+std::vector<PackedVertex> packVertices(const std::vector<float>& vertices, glm::vec3& positionOffset, glm::vec3& positionScale) {
+    const size_t vertexCount = vertices.size() / VERTEX_STRIDE;
+
+    glm::vec3 minBounds(std::numeric_limits<float>::max());
+    glm::vec3 maxBounds(std::numeric_limits<float>::lowest());
+    for (size_t i = 0; i < vertexCount; ++i) {
+        minBounds = glm::min(minBounds, vertexPosition(vertices, static_cast<unsigned int>(i)));
+        maxBounds = glm::max(maxBounds, vertexPosition(vertices, static_cast<unsigned int>(i)));
+    }
+    positionOffset = minBounds;
+    positionScale = maxBounds - minBounds;
+
+    auto quantizeUnorm = [](float value, float offset, float scale) {
+        const float normalized = scale > 0.0f ? (value - offset) / scale : 0.0f;
+        return static_cast<uint16_t>(std::lround(std::clamp(normalized, 0.0f, 1.0f) * 65535.0f));
+    };
+    auto quantizeSnorm = [](float value) { return static_cast<int16_t>(std::lround(std::clamp(value, -1.0f, 1.0f) * 32767.0f)); };
+
+    std::vector<PackedVertex> packed(vertexCount);
+    for (size_t i = 0; i < vertexCount; ++i) {
+        const float* vertex = &vertices[i * VERTEX_STRIDE];
+        const glm::vec2 normal = encodeOctahedral(glm::vec3(vertex[3], vertex[4], vertex[5]));
+        packed[i] = PackedVertex{.position = {quantizeUnorm(vertex[0], positionOffset.x, positionScale.x), quantizeUnorm(vertex[1], positionOffset.y, positionScale.y),
+                                              quantizeUnorm(vertex[2], positionOffset.z, positionScale.z), 0},
+                                 .normal = {quantizeSnorm(normal.x), quantizeSnorm(normal.y)}};
+    }
+    return packed;
 }
 
 void processNode(aiNode* node, const aiScene* scene, std::vector<float>& vertices, std::vector<unsigned int>& indices) {
@@ -55,7 +554,7 @@ void processNode(aiNode* node, const aiScene* scene, std::vector<float>& vertice
 
 bool AssetManager::bake(const std::string& sourcePath, const std::string& destinationPath) {
     Assimp::Importer importer;
-    const aiScene* scene = importer.ReadFile(sourcePath, aiProcess_Triangulate | aiProcess_FlipUVs | aiProcess_GenNormals);
+    const aiScene* scene = importer.ReadFile(sourcePath, aiProcess_Triangulate | aiProcess_FlipUVs | aiProcess_GenNormals | aiProcess_JoinIdenticalVertices);
 
     if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode) {
         Lit::Log::Error("ASSIMP failed to load model: {} with error: {}", sourcePath, importer.GetErrorString());
@@ -65,6 +564,23 @@ bool AssetManager::bake(const std::string& sourcePath, const std::string& destin
     std::vector<float> vertices;
     std::vector<unsigned int> indices;
     processNode(scene->mRootNode, scene, vertices, indices);
+    weldVertices(vertices, indices);
+
+    // Meshlets must stay contiguous, so the cache optimisation runs within each meshlet and each
+    // coarser LOD rather than over the whole index buffer.
+    std::vector<Meshlet> meshlets = buildMeshlets(vertices, indices);
+    orderMeshletsForOverdraw(vertices, indices, meshlets);
+    for (const Meshlet& meshlet : meshlets) {
+        optimizeVertexCache(std::span<unsigned int>(indices).subspan(meshlet.firstIndex, meshlet.indexCount));
+    }
+    const std::vector<MeshLod> lods = buildLods(vertices, indices);
+    for (size_t level = 1; level < lods.size(); ++level) {
+        optimizeVertexCache(std::span<unsigned int>(indices).subspan(lods[level].firstIndex, lods[level].indexCount));
+    }
+    optimizeVertexFetch(vertices, indices);
+    glm::vec3 positionOffset;
+    glm::vec3 positionScale;
+    const std::vector<PackedVertex> packedVertices = packVertices(vertices, positionOffset, positionScale);
 
     std::ofstream outFile(destinationPath, std::ios::binary);
     if (!outFile.is_open()) {
@@ -73,16 +589,30 @@ bool AssetManager::bake(const std::string& sourcePath, const std::string& destin
     }
 
     AssetHeader header;
-    header.vertexCount = vertices.size();
+    header.vertexCount = packedVertices.size();
     header.indexCount = indices.size();
+    header.meshletCount = meshlets.size();
+    header.lodCount = lods.size();
+    header.indexSize = packedVertices.size() <= 65536 ? sizeof(uint16_t) : sizeof(unsigned int);
+    for (int axis = 0; axis < 3; ++axis) {
+        header.positionOffset[axis] = positionOffset[axis];
+        header.positionScale[axis] = positionScale[axis];
+    }
 
     outFile.write(reinterpret_cast<const char*>(&header), sizeof(AssetHeader));
-    outFile.write(reinterpret_cast<const char*>(vertices.data()), vertices.size() * sizeof(float));
-    outFile.write(reinterpret_cast<const char*>(indices.data()), indices.size() * sizeof(unsigned int));
+    outFile.write(reinterpret_cast<const char*>(packedVertices.data()), packedVertices.size() * sizeof(PackedVertex));
+    if (header.indexSize == sizeof(uint16_t)) {
+        const std::vector<uint16_t> shortIndices(indices.begin(), indices.end());
+        outFile.write(reinterpret_cast<const char*>(shortIndices.data()), shortIndices.size() * sizeof(uint16_t));
+    } else {
+        outFile.write(reinterpret_cast<const char*>(indices.data()), indices.size() * sizeof(unsigned int));
+    }
+    outFile.write(reinterpret_cast<const char*>(meshlets.data()), meshlets.size() * sizeof(Meshlet));
+    outFile.write(reinterpret_cast<const char*>(lods.data()), lods.size() * sizeof(MeshLod));
 
     outFile.close();
 
-    Lit::Log::Info("Baking asset: {}", destinationPath);
+    Lit::Log::Info("Baking asset: {} ({} meshlets, {} LODs)", destinationPath, meshlets.size(), lods.size());
     return true;
 }
 
@@ -101,13 +631,31 @@ std::optional<Mesh> AssetManager::load(const std::string& assetPath) {
         return std::nullopt;
     }
 
-    std::vector<float> vertices(header.vertexCount);
-    inFile.read(reinterpret_cast<char*>(vertices.data()), vertices.size() * sizeof(float));
+    std::vector<PackedVertex> vertices(header.vertexCount);
+    inFile.read(reinterpret_cast<char*>(vertices.data()), vertices.size() * sizeof(PackedVertex));
 
-    std::vector<unsigned int> indices(header.indexCount);
-    inFile.read(reinterpret_cast<char*>(indices.data()), indices.size() * sizeof(unsigned int));
+    std::vector<unsigned int> indices;
+    std::vector<uint16_t> shortIndices;
+    if (header.indexSize == sizeof(uint16_t)) {
+        shortIndices.resize(header.indexCount);
+        inFile.read(reinterpret_cast<char*>(shortIndices.data()), shortIndices.size() * sizeof(uint16_t));
+    } else {
+        indices.resize(header.indexCount);
+        inFile.read(reinterpret_cast<char*>(indices.data()), indices.size() * sizeof(unsigned int));
+    }
+
+    std::vector<Meshlet> meshlets(header.meshletCount);
+    inFile.read(reinterpret_cast<char*>(meshlets.data()), meshlets.size() * sizeof(Meshlet));
+
+    std::vector<MeshLod> lods(std::min<uint64_t>(header.lodCount, MAX_MESH_LODS));
+    inFile.read(reinterpret_cast<char*>(lods.data()), lods.size() * sizeof(MeshLod));
 
     inFile.close();
 
-    return Mesh(std::move(vertices), std::move(indices));
+    const glm::vec3 positionOffset(header.positionOffset[0], header.positionOffset[1], header.positionOffset[2]);
+    const glm::vec3 positionScale(header.positionScale[0], header.positionScale[1], header.positionScale[2]);
+    if (!shortIndices.empty()) {
+        return Mesh(std::move(vertices), std::move(shortIndices), positionOffset, positionScale, std::move(meshlets), std::move(lods));
+    }
+    return Mesh(std::move(vertices), std::move(indices), positionOffset, positionScale, std::move(meshlets), std::move(lods));
 }
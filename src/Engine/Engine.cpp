@@ -27,4 +27,8 @@ void Engine::AddText(const std::string& text, float x, float y, float scale, con
 }
 
 void Engine::setSmallObjectThreshold(float threshold) { m_renderer.setSmallObjectThreshold(threshold); }
-void Engine::setLargeObjectThreshold(float threshold) { m_renderer.setLargeObjectThreshold(threshold); }
\ No newline at end of file
+void Engine::setClusterCullThreshold(float threshold) { m_renderer.setClusterCullThreshold(threshold); }
+void Engine::setTransformBackend(TransformBackend backend) { m_renderer.setTransformBackend(backend); }
+void Engine::setTransformValidation(bool enabled) { m_renderer.setTransformValidation(enabled); }
+void Engine::setSortKeyBudget(const SortKeyBudget& budget) { m_renderer.setSortKeyBudget(budget); }
+void Engine::setLodSelection(const LodSelection& selection) { m_renderer.setLodSelection(selection); }
\ No newline at end of file
@@ -24,7 +24,12 @@ export class Engine {
     void uploadMesh(const Mesh& mesh);
     void AddText(const std::string& text, float x, float y, float scale, const glm::vec3& color);
     void setSmallObjectThreshold(float threshold);
-    void setLargeObjectThreshold(float threshold);
+    void setClusterCullThreshold(float threshold);
+    void setTransformBackend(TransformBackend backend);
+    void setTransformValidation(bool enabled);
+    double getPropagateTime() const { return m_renderer.getPropagateTime(); }
+    void setSortKeyBudget(const SortKeyBudget& budget);
+    void setLodSelection(const LodSelection& selection);
 
   private:
     Renderer m_renderer;
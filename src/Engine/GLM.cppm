@@ -3,6 +3,7 @@ module;
 #define GLM_ENABLE_EXPERIMENTAL
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/quaternion.hpp>
 #include <glm/gtc/type_ptr.hpp>
 #include <glm/gtx/norm.hpp>
 
@@ -14,6 +15,9 @@ using ::glm::vec4;
 using ::glm::vec3;
 using ::glm::vec2;
 using ::glm::ivec2;
+using ::glm::quat;
+using ::glm::angleAxis;
+using ::glm::mat4_cast;
 using ::glm::ortho;
 using ::glm::lookAt;
 using ::glm::distance;
@@ -29,6 +33,10 @@ using ::glm::value_ptr;
 using ::glm::sin;
 using ::glm::cos;
 using ::glm::cross;
+using ::glm::dot;
+using ::glm::length;
+using ::glm::min;
+using ::glm::max;
 
 using ::glm::operator*;
 using ::glm::operator+;
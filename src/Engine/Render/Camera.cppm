@@ -21,6 +21,8 @@ export class Camera {
     void updateAspectRatio(float width, float height);
     void setNearPlane(float nearPlane) { m_nearPlane = nearPlane; }
     void setFarPlane(float farPlane) { m_farPlane = farPlane; }
+    float getNearPlane() const { return m_nearPlane; }
+    float getFarPlane() const { return m_farPlane; }
 
   private:
     void updateCameraVectors();
@@ -8,20 +8,52 @@ export module Engine.Render.component;
 import Engine.Render.entity;
 import Engine.glm;
 
+// Local transform as translation, rotation and scale (40 bytes). transform.comp expands it and
+// writes 3x4 world matrices on the GPU; world matrices are never stored on the CPU.
 export struct TransformComponent {
-    glm::mat4 localMatrix{1.0f};
-    glm::mat4 worldMatrix{1.0f};
+    glm::vec3 translation{0.0f};
+    glm::quat rotation{1.0f, 0.0f, 0.0f, 0.0f};
+    glm::vec3 scale{1.0f};
 };
+static_assert(sizeof(TransformComponent) == 40, "TransformComponent must match the GLSL layout in transform.comp");
+
+// Affine world matrix stored as its top three rows; the fourth row is (0, 0, 0, 1). Same layout
+// as the GPU object buffer written by transform.comp.
+export struct WorldTransform {
+    glm::vec4 rows[3];
+
+    glm::mat4 toMat4() const {
+        return glm::mat4(glm::vec4(rows[0].x, rows[1].x, rows[2].x, 0.0f), glm::vec4(rows[0].y, rows[1].y, rows[2].y, 0.0f),
+                         glm::vec4(rows[0].z, rows[1].z, rows[2].z, 0.0f), glm::vec4(rows[0].w, rows[1].w, rows[2].w, 1.0f));
+    }
+};
+
+// Static entities keep the world matrix and bounds computed the last time they or an ancestor
+// changed. Dynamic entities are re-uploaded and recomputed every frame without being marked.
+export enum class Mobility : std::uint8_t { Static, Dynamic };
 
 export struct HierarchyComponent {
     Entity parent = INVALID_ENTITY;
     uint32_t level = 0;
 };
 
+// mesh_uuid of a destroyed slot; culling passes skip it.
+export inline constexpr std::uint32_t INVALID_MESH = UINT32_MAX;
+
 export struct RenderableComponent {
     std::uint32_t mesh_uuid;
     std::uint32_t material_uuid;
     std::uint32_t shaderId;
     std::uint32_t objectId;
     alignas(4) float alpha = 1.0f;
-};
\ No newline at end of file
+};
+
+// Point light whose contribution fades to zero at `radius`. Lights are not entities; they live in
+// SceneDatabase::lights and are uploaded as-is to the light buffer read by light_bin.comp.
+export struct PointLight {
+    glm::vec3 position{0.0f};
+    float radius = 10.0f;
+    glm::vec3 color{1.0f};
+    float intensity = 1.0f;
+};
+static_assert(sizeof(PointLight) == 32, "PointLight must match the GLSL layout in light_bin.comp");
\ No newline at end of file
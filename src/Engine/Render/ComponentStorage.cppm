@@ -0,0 +1,105 @@
+module;
+
+#include <cstddef>
+#include <span>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+export module Engine.Render.componentstorage;
+
+// Structure-of-arrays store with one contiguous column per component type. Row operations apply
+// to every column, so adding a component type only means adding it to the template arguments.
+export template <typename... Components>
+class ComponentStorage {
+    static_assert(sizeof...(Components) > 0, "ComponentStorage needs at least one component type");
+
+  public:
+    size_t size() const { return std::get<0>(m_columns).size(); }
+    bool empty() const { return size() == 0; }
+
+    void reserve(size_t capacity) {
+        forEachColumn([&](auto& column) { column.reserve(capacity); });
+    }
+
+    void resize(size_t count) {
+        forEachColumn([&](auto& column) { column.resize(count); });
+    }
+
+    void clear() {
+        forEachColumn([](auto& column) { column.clear(); });
+    }
+
+    // Appends a value-initialised row and returns its index.
+    size_t emplaceBack() {
+        forEachColumn([](auto& column) { column.emplace_back(); });
+        return size() - 1;
+    }
+
+    void popBack() {
+        forEachColumn([](auto& column) { column.pop_back(); });
+    }
+
+    void resetRow(size_t index) {
+        forEachColumn([&](auto& column) { column[index] = {}; });
+    }
+
+    void copyRow(size_t from, size_t to) {
+        forEachColumn([&](auto& column) { column[to] = column[from]; });
+    }
+
+    // Rebuilds every column so that row i holds the old row order[i]. Rows not listed are dropped.
+    template <typename Index>
+    void gather(std::span<const Index> order) {
+        forEachColumn([&](auto& column) {
+            std::remove_reference_t<decltype(column)> gathered;
+            gathered.reserve(order.size());
+            for (const Index index : order) {
+                gathered.push_back(std::move(column[index]));
+            }
+            column.swap(gathered);
+        });
+    }
+
+    template <typename T>
+    std::vector<T>& column() {
+        return std::get<std::vector<T>>(m_columns);
+    }
+
+    template <typename T>
+    const std::vector<T>& column() const {
+        return std::get<std::vector<T>>(m_columns);
+    }
+
+    // Typed views stay valid until the storage grows; take them per pass rather than caching.
+    template <typename T>
+    std::span<T> view() {
+        return column<T>();
+    }
+
+    template <typename T>
+    std::span<const T> view() const {
+        return column<T>();
+    }
+
+    // Several columns at once, for passes that stream a few components in lockstep:
+    //   auto [transforms, hierarchies] = storage.views<TransformComponent, HierarchyComponent>();
+    template <typename... Ts>
+    std::tuple<std::span<Ts>...> views() {
+        return {view<Ts>()...};
+    }
+
+    template <typename... Ts>
+    std::tuple<std::span<const Ts>...> views() const {
+        return {view<Ts>()...};
+    }
+
+    template <typename Fn>
+    void forEachColumn(Fn&& fn) {
+        std::apply([&](auto&... columns) { (fn(columns), ...); }, m_columns);
+    }
+
+  private:
+    std::tuple<std::vector<Components>...> m_columns;
+};
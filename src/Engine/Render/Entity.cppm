@@ -6,4 +6,15 @@ module;
 export module Engine.Render.entity;
 
 export using Entity = std::uint32_t;
-export inline constexpr Entity INVALID_ENTITY = std::numeric_limits<Entity>::max();
\ No newline at end of file
+export inline constexpr Entity INVALID_ENTITY = std::numeric_limits<Entity>::max();
+
+// Stable reference to an entity. `index` addresses SceneDatabase's handle table rather than the
+// component arrays, so handles survive compaction; a stale generation resolves to INVALID_ENTITY.
+export struct EntityHandle {
+    std::uint32_t index = INVALID_ENTITY;
+    std::uint32_t generation = 0;
+
+    bool operator==(const EntityHandle&) const = default;
+};
+
+export inline constexpr EntityHandle INVALID_ENTITY_HANDLE{};
@@ -1,18 +1,77 @@
 module;
 
+#include <cstddef>
+#include <cstdint>
 #include <vector>
 
 export module Engine.mesh;
 
+import Engine.glm;
+
+// A cluster of nearby triangles stored as a contiguous range of its mesh's indices, so a cluster
+// is drawn with the mesh's vertices and an index sub-range. Bounds are in mesh space: the cone
+// axis and cutoff bound the triangle normals and let a cluster facing away be culled whole.
+export struct Meshlet {
+    glm::vec4 boundingSphere;
+    glm::vec4 cone;
+    uint32_t firstIndex;
+    uint32_t indexCount;
+    uint32_t padding0 = 0;
+    uint32_t padding1 = 0;
+};
+static_assert(sizeof(Meshlet) == 48, "Meshlet must match the GLSL layout in cluster_cull.comp");
+
+// Longest LOD chain a mesh carries; MeshInfo in the cull and command gen shaders has this many
+// slots.
+export constexpr uint32_t MAX_MESH_LODS = 4;
+
+// One level of detail as a range of its mesh's indices over the shared vertices. LOD 0 is the
+// full mesh and the range the meshlets subdivide.
+export struct MeshLod {
+    uint32_t firstIndex;
+    uint32_t indexCount;
+};
+
+// Vertex layout written by the asset baker, 12 bytes instead of six floats. The position is
+// quantised to 16 bits per axis over the mesh's bounding box and the normal is octahedral-encoded
+// in two signed 16-bit values; cube.vert reads both as normalized attributes and decodes them.
+export struct PackedVertex {
+    uint16_t position[4];
+    int16_t normal[2];
+};
+static_assert(sizeof(PackedVertex) == 12, "PackedVertex must match the vertex layout in cube.vert");
+
 export class Mesh {
   public:
-    std::vector<float> vertices;
+    std::vector<PackedVertex> vertices;
+    // Only one of the index lists is filled. Meshes with at most 65536 vertices come with 16-bit
+    // indices, which the renderer keeps in a separate 16-bit index buffer.
     std::vector<unsigned int> indices;
+    std::vector<uint16_t> shortIndices;
+    // A stored position p in [0, 1] decodes to positionOffset + p * positionScale.
+    glm::vec3 positionOffset;
+    glm::vec3 positionScale;
+    std::vector<Meshlet> meshlets;
+    // Empty when the mesh has a single level of detail spanning all of its indices.
+    std::vector<MeshLod> lods;
 
-    Mesh(std::vector<float>&& vertices, std::vector<unsigned int>&& indices)
-        : vertices(std::move(vertices)), indices(std::move(indices)) {}
+    Mesh(std::vector<PackedVertex>&& vertices, std::vector<unsigned int>&& indices, const glm::vec3& positionOffset, const glm::vec3& positionScale,
+         std::vector<Meshlet>&& meshlets = {}, std::vector<MeshLod>&& lods = {})
+        : vertices(std::move(vertices)), indices(std::move(indices)), positionOffset(positionOffset), positionScale(positionScale), meshlets(std::move(meshlets)),
+          lods(std::move(lods)) {}
+    Mesh(std::vector<PackedVertex>&& vertices, std::vector<uint16_t>&& shortIndices, const glm::vec3& positionOffset, const glm::vec3& positionScale,
+         std::vector<Meshlet>&& meshlets = {}, std::vector<MeshLod>&& lods = {})
+        : vertices(std::move(vertices)), shortIndices(std::move(shortIndices)), positionOffset(positionOffset), positionScale(positionScale),
+          meshlets(std::move(meshlets)), lods(std::move(lods)) {}
     ~Mesh() = default;
 
+    size_t indexCount() const { return shortIndices.empty() ? indices.size() : shortIndices.size(); }
+
+    glm::vec3 position(size_t vertex) const {
+        const uint16_t* p = vertices[vertex].position;
+        return positionOffset + glm::vec3(p[0], p[1], p[2]) / 65535.0f * positionScale;
+    }
+
     Mesh(const Mesh&) = delete;
     Mesh& operator=(const Mesh&) = delete;
 
@@ -12,7 +12,6 @@ module;
 #include "DiligentCore/Graphics/GraphicsEngine/interface/PipelineState.h"
 #include "DiligentCore/Graphics/GraphicsEngine/interface/ShaderResourceBinding.h"
 #include "DiligentCore/Graphics/GraphicsEngine/interface/Sampler.h"
-#include "DiligentCore/Graphics/GraphicsTools/interface/MapHelper.hpp"
 
 #include <GLFW/glfw3.h>
 
@@ -32,15 +31,22 @@ module;
 #include <GLFW/glfw3native.h>
 
 #include <vector>
+#include <initializer_list>
+#include <memory>
+#include <algorithm>
+#include <span>
+#include <utility>
 #include <optional>
 #include <unordered_map>
 #include <cmath>
 #include <string>
 #include <cstring>
 #include <cstddef>
+#include <cstdint>
 #include <fstream>
 #include <sstream>
 #include <chrono>
+#include <bit>
 #include "Engine/Log/Log.hpp"
 
 module Engine.renderer;
@@ -49,11 +55,16 @@ import Engine.glm;
 import Engine.camera;
 import Engine.Render.entity;
 import Engine.Render.scenedatabase;
+import Engine.Render.componentstorage;
+import Engine.Render.transformpropagator;
 import Engine.Render.component;
 
 import Engine.mesh;
 
 namespace {
+// Upper bound on uploaded ranges per component buffer per frame; sparser edits get merged.
+constexpr size_t MAX_DIRTY_UPLOAD_RANGES = 64;
+
 struct DrawElementsIndirectCommand {
     unsigned int count;
     unsigned int instanceCount;
@@ -62,13 +73,40 @@ struct DrawElementsIndirectCommand {
     unsigned int baseInstance;
 };
 
+// Per-instance record the command gen passes write in draw order for cube.vert: the world matrix
+// rows with the mesh's position dequantisation folded in, and the normal matrix rows with the
+// object's alpha in normal[0].w.
+struct InstanceData {
+    glm::vec4 world[3];
+    glm::vec4 normal[3];
+};
+static_assert(sizeof(InstanceData) == 96, "InstanceData must match the GLSL layout in cube.vert");
+
 struct MeshInfo {
     unsigned int indexCount;
     unsigned int firstIndex;
     unsigned int baseVertex;
     float boundingRadius;
     alignas(16) glm::vec4 boundingCenter;
+    uint32_t firstMeshlet;
+    uint32_t meshletCount;
+    uint32_t lodCount;
+    // INDEX_TYPE_UINT16 when firstIndex points into the 16-bit index buffer.
+    uint32_t indexType;
+    // Index ranges of the LOD chain relative to firstIndex; LOD 0 is indexCount at 0.
+    alignas(16) uint32_t lodFirstIndex[MAX_MESH_LODS];
+    uint32_t lodIndexCount[MAX_MESH_LODS];
+    // Decodes the mesh's quantised vertex positions; see Mesh::position().
+    alignas(16) glm::vec4 positionOffset;
+    alignas(16) glm::vec4 positionScale;
+    // Every mesh also has its indices in the 32-bit buffer, which the sorted transparent list is
+    // drawn from in a single call.
+    uint32_t wideFirstIndex;
+    uint32_t padding0;
+    uint32_t padding1;
+    uint32_t padding2;
 };
+static_assert(sizeof(MeshInfo) == 128, "MeshInfo must match the GLSL layout in cull.comp");
 
 struct SceneUniforms {
     glm::mat4 projection;
@@ -77,11 +115,11 @@ struct SceneUniforms {
     alignas(16) glm::vec3 viewPos;
     alignas(16) glm::vec3 lightColor;
     alignas(16) glm::vec4 frustumPlanes[6];
-};
-
-struct VisibleTransparentObject {
-    unsigned int objectId;
-    float distance;
+    // Near plane, log2(far / near), viewport width and height; see light_bin.comp.
+    alignas(16) glm::vec4 lightGridParams;
+    // Froxels along x, y and depth, and the light capacity of each froxel.
+    alignas(16) uint32_t lightGridSize[4];
+    uint32_t lightCount;
 };
 
 struct CullingUniforms {
@@ -92,42 +130,120 @@ struct CullingUniforms {
     float hizMaxMipLevel;
     float hizTextureSizeX;
     float hizTextureSizeY;
-    uint32_t padding;
+    // 0 draws last frame's visible set, 1 occlusion-tests the rest; see cull.comp.
+    uint32_t phase;
+    float clusterCullThreshold;
+    uint32_t maxClusterCandidates;
+    uint32_t maxClusterDraws;
+    alignas(16) glm::vec4 lodThresholds;
+    float lodHysteresis;
 };
 
 struct CommandGenUniforms {
-    uint32_t visibleObjectCount;
     uint32_t maxDraws;
     uint32_t padding0;
     uint32_t padding1;
+    uint32_t padding2;
 };
 
+// The list sort passes write the radix-sorted object ids back to their visible lists.
 struct SortConstants {
-    uint32_t k;
-    uint32_t j;
+    uint32_t maxCount;
     uint32_t padding0;
     uint32_t padding1;
+    uint32_t padding2;
 };
 
-struct LargeObjectCullUniforms {
-    uint32_t objectCount;
-    uint32_t maxDraws;
-    float largeObjectThreshold;
+// Field widths of the 64-bit keys the cull passes emit; see packSortKey() in cull.comp.
+struct SortKeyConstants {
+    uint32_t depthBits;
+    uint32_t meshBits;
+    uint32_t materialBits;
+    uint32_t shaderBits;
+    float depthRange;
+    // Low bits of the mesh field that hold the LOD.
+    uint32_t lodBits;
+    uint32_t padding1;
+    uint32_t padding2;
+};
+
+struct RadixSortConstants {
+    uint32_t shift;
+    uint32_t maxCount;
+    uint32_t padding0;
+    uint32_t padding1;
+};
+
+struct DispatchIndirectCommand {
+    uint32_t groupCountX;
+    uint32_t groupCountY;
+    uint32_t groupCountZ;
     uint32_t padding;
 };
 
-struct LargeObjectCommandGenUniforms {
-    unsigned int visibleLargeObjectCount;
-    unsigned int maxDraws;
-    unsigned int padding0;
-    unsigned int padding1;
+// Slots of the dispatch-args buffer. dispatch_args.comp fills them from the visible counters so
+// the passes over each visible list are sized without reading the counters back. The sort slot
+// counts radix tiles; the command-gen slot also sizes the per-element sort key stages.
+enum DispatchArgsSlot : uint32_t {
+    OPAQUE_SORT_ARGS,
+    OPAQUE_COMMAND_GEN_ARGS,
+    TRANSPARENT_SORT_ARGS,
+    TRANSPARENT_COMMAND_GEN_ARGS,
+    CLUSTER_CULL_ARGS,
+    DISPATCH_ARGS_SLOT_COUNT
+};
+
+struct DispatchArgsConstants {
+    uint32_t maxCount;
+    uint32_t firstSlot;
+    uint32_t slotCount;
+    uint32_t padding;
+    uint32_t groupSizes[4];
 };
 
-struct TransparentCommandGenUniforms {
-    unsigned int visibleTransparentCount;
-    unsigned int padding0;
-    unsigned int padding1;
-    unsigned int padding2;
+// Workgroup sizes of the passes dispatched through the dispatch-args buffer. A radix tile is one
+// workgroup of radix_histogram.comp / radix_scatter.comp.
+constexpr uint32_t RADIX_SORT_TILE_SIZE = 2048;
+constexpr uint32_t RADIX_SORT_BUCKETS = 256;
+// One pass per byte of a 64-bit key.
+constexpr uint32_t RADIX_SORT_MAX_PASSES = 8;
+// Depth is quantised through a float, so more bits than its mantissa add nothing.
+constexpr uint32_t MAX_SORT_KEY_DEPTH_BITS = 24;
+constexpr uint32_t COMMAND_GEN_WORKGROUP_SIZE = 256;
+constexpr uint32_t TRANSPARENT_COMMAND_GEN_WORKGROUP_SIZE = 256;
+
+// hiz_downsample.comp binds one image per Hi-Z mip and GL only guarantees eight compute image
+// uniforms, so the pyramid stops there. A footprint that needs a coarser level is tested against
+// all of the last level's texels it covers; see testHiZRect() in cull.comp.
+constexpr int HIZ_MAX_MIP_COUNT = 8;
+constexpr uint32_t HIZ_DOWNSAMPLE_TILE_SIZE = 64;
+
+// cluster_cull.comp runs one workgroup per candidate object and GL only guarantees 65535
+// workgroups per dimension; candidates past that are drawn whole. Each shader's bin of meshlet
+// draws is capped the same way as the object draws.
+constexpr uint32_t MAX_CLUSTER_CANDIDATES = 65535;
+constexpr uint32_t MAX_CLUSTER_DRAWS = 1 << 16;
+
+// A multi-draw reads one index buffer, so opaque and meshlet draws are binned by shader and index
+// type: bin shaderId * INDEX_TYPE_COUNT + indexType.
+constexpr uint32_t INDEX_TYPE_UINT32 = 0;
+constexpr uint32_t INDEX_TYPE_UINT16 = 1;
+constexpr uint32_t INDEX_TYPE_COUNT = 2;
+
+// Froxel grid of the clustered point lights: screen tiles of roughly 16:9 split into exponential
+// depth slices. Lights past a froxel's capacity are dropped from it.
+constexpr uint32_t LIGHT_GRID_SIZE_X = 16;
+constexpr uint32_t LIGHT_GRID_SIZE_Y = 9;
+constexpr uint32_t LIGHT_GRID_SIZE_Z = 24;
+constexpr uint32_t LIGHT_GRID_FROXEL_COUNT = LIGHT_GRID_SIZE_X * LIGHT_GRID_SIZE_Y * LIGHT_GRID_SIZE_Z;
+constexpr uint32_t MAX_LIGHTS_PER_FROXEL = 128;
+constexpr uint32_t LIGHT_BIN_WORKGROUP_SIZE = 64;
+
+struct DrawRunConstants {
+    uint32_t maxCount;
+    uint32_t runKeyShift;
+    uint32_t padding0;
+    uint32_t padding1;
 };
 
 struct TransparentCullUniforms {
@@ -140,20 +256,67 @@ struct TransparentCullUniforms {
 };
 
 std::vector<MeshInfo> s_meshInfos;
+std::vector<Meshlet> s_meshlets;
 size_t s_totalVertexSize = 0;
 size_t s_totalIndexSize = 0;
+size_t s_totalShortIndexSize = 0;
+
+// Same sphere as computeBounds() in transform.comp; used when world transforms come from the CPU.
+glm::vec4 computeWorldBounds(const WorldTransform& world, const MeshInfo& mesh) {
+    const glm::vec4 center(glm::vec3(mesh.boundingCenter), 1.0f);
+    auto dot4 = [](const glm::vec4& a, const glm::vec4& b) { return a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w; };
+    auto axisLengthSq = [&](int axis) {
+        return world.rows[0][axis] * world.rows[0][axis] + world.rows[1][axis] * world.rows[1][axis] + world.rows[2][axis] * world.rows[2][axis];
+    };
+
+    const float maxScaleSq = std::max(axisLengthSq(0), std::max(axisLengthSq(1), axisLengthSq(2)));
+    return glm::vec4(dot4(world.rows[0], center), dot4(world.rows[1], center), dot4(world.rows[2], center), mesh.boundingRadius * glm::sqrt(maxScaleSq));
+}
+
+// Same matrix as computeNormalMatrix() in transform.comp.
+WorldTransform computeNormalMatrix(const WorldTransform& world) {
+    const glm::vec3 r0(world.rows[0]);
+    const glm::vec3 r1(world.rows[1]);
+    const glm::vec3 r2(world.rows[2]);
+    const glm::vec3 c0 = glm::cross(r1, r2);
+    const float det = glm::dot(r0, c0);
+    const float invDet = det != 0.0f ? 1.0f / det : 1.0f;
+
+    WorldTransform normalMatrix;
+    normalMatrix.rows[0] = glm::vec4(c0 * invDet, 0.0f);
+    normalMatrix.rows[1] = glm::vec4(glm::cross(r2, r0) * invDet, 0.0f);
+    normalMatrix.rows[2] = glm::vec4(glm::cross(r0, r1) * invDet, 0.0f);
+    return normalMatrix;
+}
+
+// Transform validation allows this much error, relative once a reference value exceeds 1, for
+// the differing rounding of the GPU and CPU paths.
+constexpr float TRANSFORM_VALIDATION_TOLERANCE = 1e-4f;
+constexpr size_t MAX_LOGGED_TRANSFORM_MISMATCHES = 8;
 
-unsigned int nextPowerOfTwo(unsigned int n) {
-    n--;
-    n |= n >> 1;
-    n |= n >> 2;
-    n |= n >> 4;
-    n |= n >> 8;
-    n |= n >> 16;
-    n++;
-    return n;
+float maxRelativeError(const float* values, const float* reference, size_t count) {
+    float maxError = 0.0f;
+    for (size_t i = 0; i < count; ++i) {
+        maxError = std::max(maxError, std::abs(values[i] - reference[i]) / std::max(1.0f, std::abs(reference[i])));
+    }
+    return maxError;
+}
+
+// Ids are 32-bit, so shader and mesh always fit; material and then depth give way when the key
+// would pass 64 bits.
+SortKeyConstants makeSortKeyConstants(uint32_t shaderBits, uint32_t materialBits, uint32_t meshBits, uint32_t lodBits, uint32_t depthBits, float depthRange) {
+    SortKeyConstants constants = {};
+    constants.shaderBits = std::min(shaderBits, 32u);
+    constants.meshBits = std::min(meshBits + lodBits, 32u);
+    constants.lodBits = lodBits;
+    constants.materialBits = std::min({materialBits, 32u, 64u - constants.shaderBits - constants.meshBits});
+    constants.depthBits = std::min({depthBits, MAX_SORT_KEY_DEPTH_BITS, 64u - constants.shaderBits - constants.meshBits - constants.materialBits});
+    constants.depthRange = std::max(depthRange, 1e-6f);
+    return constants;
 }
 
+uint32_t sortKeyBits(const SortKeyConstants& constants) { return constants.depthBits + constants.meshBits + constants.materialBits + constants.shaderBits; }
+
 void extractFrustumPlanes(const glm::mat4& vp, glm::vec4* planes) {
     planes[0] = glm::vec4(vp[0][3] + vp[0][0], vp[1][3] + vp[1][0], vp[2][3] + vp[2][0], vp[3][3] + vp[3][0]);
     planes[1] = glm::vec4(vp[0][3] - vp[0][0], vp[1][3] - vp[1][0], vp[2][3] - vp[2][0], vp[3][3] - vp[3][0]);
@@ -178,6 +341,57 @@ static std::string LoadSourceFromFile(const std::string& filepath) {
     return buffer.str();
 }
 
+// Loads a compute shader and creates its pipeline with every listed variable mutable.
+static bool CreateComputePipeline(Diligent::IRenderDevice* pDevice, const char* path, const char* name, std::initializer_list<const char*> variableNames,
+                                  Diligent::RefCntAutoPtr<Diligent::IPipelineState>& pPSO) {
+    pPSO.Release();
+    std::string source = LoadSourceFromFile(path);
+    if (source.empty()) {
+        Lit::Log::Error("Failed to load {} compute shader source.", name);
+        return false;
+    }
+
+    size_t versionPos = source.find("#version");
+    if (versionPos != std::string::npos) {
+        size_t nextLine = source.find('\n', versionPos);
+        if (nextLine != std::string::npos)
+            source = source.substr(nextLine + 1);
+    }
+
+    const std::string shaderName = std::string(name) + " CS";
+    Diligent::ShaderCreateInfo ShaderCI;
+    ShaderCI.Source = source.c_str();
+    ShaderCI.SourceLanguage = Diligent::SHADER_SOURCE_LANGUAGE_GLSL;
+    ShaderCI.Desc.ShaderType = Diligent::SHADER_TYPE_COMPUTE;
+    ShaderCI.Desc.Name = shaderName.c_str();
+
+    Diligent::RefCntAutoPtr<Diligent::IShader> pCS;
+    pDevice->CreateShader(ShaderCI, &pCS);
+    if (!pCS) {
+        Lit::Log::Error("Failed to create {} shader", name);
+        return false;
+    }
+
+    std::vector<Diligent::ShaderResourceVariableDesc> Vars;
+    for (const char* variableName : variableNames)
+        Vars.push_back({Diligent::SHADER_TYPE_COMPUTE, variableName, Diligent::SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE});
+
+    const std::string psoName = std::string(name) + " PSO";
+    Diligent::ComputePipelineStateCreateInfo PSOCI;
+    PSOCI.PSODesc.Name = psoName.c_str();
+    PSOCI.PSODesc.PipelineType = Diligent::PIPELINE_TYPE_COMPUTE;
+    PSOCI.pCS = pCS;
+    PSOCI.PSODesc.ResourceLayout.Variables = Vars.data();
+    PSOCI.PSODesc.ResourceLayout.NumVariables = static_cast<Diligent::Uint32>(Vars.size());
+
+    pDevice->CreateComputePipelineState(PSOCI, &pPSO);
+    if (!pPSO) {
+        Lit::Log::Error("Failed to create {} PSO", name);
+        return false;
+    }
+    return true;
+}
+
 Diligent::RefCntAutoPtr<Diligent::IBuffer> CreateStructuredBuffer(Diligent::IRenderDevice* pDevice, const char* name, Diligent::Uint32 elementSize, Diligent::Uint32 elementCount, void* pInitData = nullptr, Diligent::BIND_FLAGS extraFlags = Diligent::BIND_NONE) {
     Diligent::BufferDesc Desc;
     Desc.Name = name;
@@ -212,6 +426,113 @@ Diligent::RefCntAutoPtr<Diligent::IBuffer> CreateIndirectBuffer(Diligent::IRende
     return pBuffer;
 }
 
+// Staging buffer for the CPU-to-GPU uploads of a frame. Each frame in flight owns one region,
+// which is only written after that frame's fence has passed, so it is mapped without
+// synchronisation and every upload costs one memcpy plus a GPU copy. GL cannot copy from a
+// mapped buffer, so the region stays mapped from begin() to end() and the copies are recorded
+// by end(); data that stays in the ring is copied later with copy().
+class UploadRing {
+  public:
+    static constexpr Diligent::Uint64 ALIGNMENT = 16;
+    static constexpr Diligent::Uint64 INITIAL_REGION_SIZE = 4 * 1024 * 1024;
+
+    void begin(Diligent::IRenderDevice* pDevice, Diligent::IDeviceContext* pContext, uint32_t frame, uint32_t frameCount) {
+        m_pDevice = pDevice;
+        m_pContext = pContext;
+        m_frame = frame;
+        m_frameCount = frameCount;
+        m_cursor = 0;
+        m_copies.clear();
+        if (!m_pBuffer) {
+            createBuffer(INITIAL_REGION_SIZE);
+        }
+        map();
+    }
+
+    // Writes `size` bytes of `pData` (zeros when null) into the region and returns their offset in
+    // it. With a destination the bytes are copied to `pDst` at `dstOffset` by end().
+    Diligent::Uint64 write(const void* pData, Diligent::Uint64 size, Diligent::IBuffer* pDst = nullptr, Diligent::Uint64 dstOffset = 0) {
+        const Diligent::Uint64 offset = m_cursor;
+        if (offset + size > m_regionSize) {
+            grow(offset + size);
+        }
+        if (pData) {
+            std::memcpy(m_pRegion + offset, pData, size);
+        } else {
+            std::memset(m_pRegion + offset, 0, size);
+        }
+        m_cursor = (offset + size + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+        if (pDst && size > 0) {
+            m_copies.push_back({offset, size, pDst, dstOffset});
+        }
+        return offset;
+    }
+
+    void end() {
+        m_pContext->UnmapBuffer(m_pBuffer, Diligent::MAP_WRITE);
+        m_pRegion = nullptr;
+        for (const PendingCopy& pending : m_copies) {
+            copy(pending.offset, pending.pDst, pending.dstOffset, pending.size);
+        }
+        m_copies.clear();
+    }
+
+    // Copies bytes written this frame; only valid after end().
+    void copy(Diligent::Uint64 offset, Diligent::IBuffer* pDst, Diligent::Uint64 dstOffset, Diligent::Uint64 size) {
+        m_pContext->CopyBuffer(m_pBuffer, m_frame * m_regionSize + offset, Diligent::RESOURCE_STATE_TRANSITION_MODE_TRANSITION, pDst, dstOffset, size,
+                               Diligent::RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+    }
+
+  private:
+    struct PendingCopy {
+        Diligent::Uint64 offset;
+        Diligent::Uint64 size;
+        Diligent::IBuffer* pDst;
+        Diligent::Uint64 dstOffset;
+    };
+
+    void createBuffer(Diligent::Uint64 regionSize) {
+        m_regionSize = regionSize;
+        Diligent::BufferDesc Desc;
+        Desc.Name = "Upload Ring";
+        Desc.Usage = Diligent::USAGE_DYNAMIC;
+        Desc.BindFlags = Diligent::BIND_NONE;
+        Desc.CPUAccessFlags = Diligent::CPU_ACCESS_WRITE;
+        Desc.Size = m_regionSize * m_frameCount;
+        m_pBuffer.Release();
+        m_pDevice->CreateBuffer(Desc, nullptr, &m_pBuffer);
+    }
+
+    void map() {
+        Diligent::PVoid pMapped = nullptr;
+        m_pContext->MapBuffer(m_pBuffer, Diligent::MAP_WRITE, Diligent::MAP_FLAG_NO_OVERWRITE, pMapped);
+        m_pRegion = static_cast<Diligent::Uint8*>(pMapped) + m_frame * m_regionSize;
+    }
+
+    // Nothing has been copied out of the region yet, so its contents move to a larger buffer and
+    // the offsets handed out so far stay valid. Frames still in flight keep the old buffer alive
+    // until their copies have executed.
+    void grow(Diligent::Uint64 requiredSize) {
+        Lit::Log::Info("Growing upload ring to {} bytes per frame.", requiredSize * 2);
+        Diligent::RefCntAutoPtr<Diligent::IBuffer> pOldBuffer = m_pBuffer;
+        const Diligent::Uint8* pOldRegion = m_pRegion;
+        createBuffer(requiredSize * 2);
+        map();
+        std::memcpy(m_pRegion, pOldRegion, m_cursor);
+        m_pContext->UnmapBuffer(pOldBuffer, Diligent::MAP_WRITE);
+    }
+
+    Diligent::IRenderDevice* m_pDevice = nullptr;
+    Diligent::IDeviceContext* m_pContext = nullptr;
+    Diligent::RefCntAutoPtr<Diligent::IBuffer> m_pBuffer;
+    Diligent::Uint8* m_pRegion = nullptr;
+    Diligent::Uint64 m_regionSize = 0;
+    Diligent::Uint64 m_cursor = 0;
+    uint32_t m_frame = 0;
+    uint32_t m_frameCount = 1;
+    std::vector<PendingCopy> m_copies;
+};
+
 } // namespace
 
 Diligent::RefCntAutoPtr<Diligent::IBuffer> CreateVertexBuffer(Diligent::IRenderDevice* pDevice, size_t size) {
@@ -236,6 +557,26 @@ Diligent::RefCntAutoPtr<Diligent::IBuffer> CreateIndexBuffer(Diligent::IRenderDe
     return pBuffer;
 }
 
+// Bindings that depend on the frame in flight, built by Renderer::createFrameBindings() whenever
+// the buffers are reallocated. Each SRB sees its frame's slice of the per-frame buffers, so
+// drawScene only selects m_currentFrame's set. The sort passes' value buffer still alternates
+// with the radix pass count, so its variables are kept.
+struct FrameBindings {
+    Diligent::RefCntAutoPtr<Diligent::IShaderResourceBinding> pCullingSRB;
+    Diligent::RefCntAutoPtr<Diligent::IShaderResourceBinding> pOpaqueSortSRB;
+    Diligent::RefCntAutoPtr<Diligent::IShaderResourceBinding> pCommandGenSRB;
+    std::vector<Diligent::RefCntAutoPtr<Diligent::IShaderResourceBinding>> pOpaqueSRBs;
+    Diligent::RefCntAutoPtr<Diligent::IShaderResourceBinding> pTransparentCullSRB;
+    Diligent::RefCntAutoPtr<Diligent::IShaderResourceBinding> pTransparentSortSRB;
+    Diligent::RefCntAutoPtr<Diligent::IShaderResourceBinding> pTransparentCommandGenSRB;
+    Diligent::RefCntAutoPtr<Diligent::IShaderResourceBinding> pTransparentSRB;
+    Diligent::RefCntAutoPtr<Diligent::IShaderResourceBinding> pClusterCullSRB;
+    std::vector<Diligent::RefCntAutoPtr<Diligent::IShaderResourceBinding>> pClusterSRBs;
+    Diligent::RefCntAutoPtr<Diligent::IShaderResourceBinding> pLightBinSRB;
+    Diligent::IShaderResourceVariable* pOpaqueSortValueVar = nullptr;
+    Diligent::IShaderResourceVariable* pTransparentSortValueVar = nullptr;
+};
+
 struct DiligentData {
     Diligent::RefCntAutoPtr<Diligent::IRenderDevice> pDevice;
     Diligent::RefCntAutoPtr<Diligent::IDeviceContext> pImmediateContext;
@@ -246,7 +587,11 @@ struct DiligentData {
     Diligent::RefCntAutoPtr<Diligent::IFence> pFences[NumFrames];
     Diligent::Uint64 FenceValues[NumFrames] = {0};
     Diligent::Uint64 CurrentFenceValue = 0;
+    UploadRing uploadRing;
     Diligent::RefCntAutoPtr<Diligent::IBuffer> pObjectBuffer;
+    Diligent::RefCntAutoPtr<Diligent::IBuffer> pLocalTransformBuffer;
+    Diligent::RefCntAutoPtr<Diligent::IBuffer> pBoundsBuffer;
+    Diligent::RefCntAutoPtr<Diligent::IBuffer> pNormalMatrixBuffer;
     Diligent::RefCntAutoPtr<Diligent::IBufferView> pObjectBufferViews[NumFrames];
     Diligent::RefCntAutoPtr<Diligent::IBuffer> pHierarchyBuffer;
     Diligent::RefCntAutoPtr<Diligent::IBufferView> pHierarchyBufferViews[NumFrames];
@@ -254,11 +599,11 @@ struct DiligentData {
     Diligent::RefCntAutoPtr<Diligent::IBuffer> pSortedHierarchyBuffer;
     Diligent::RefCntAutoPtr<Diligent::IBufferView> pSortedHierarchyBufferViews[NumFrames];
     Diligent::RefCntAutoPtr<Diligent::IBuffer> pVisibleObjectBuffer;
+    Diligent::RefCntAutoPtr<Diligent::IBuffer> pVisibilityBuffer;
+    Diligent::RefCntAutoPtr<Diligent::IBuffer> pLodStateBuffer;
     Diligent::RefCntAutoPtr<Diligent::IBuffer> pDrawCommandBuffer;
     Diligent::RefCntAutoPtr<Diligent::IBuffer> pVisibleTransparentObjectIdsBuffer;
     Diligent::RefCntAutoPtr<Diligent::IBuffer> pTransparentDrawCommandBuffer;
-    Diligent::RefCntAutoPtr<Diligent::IBuffer> pVisibleLargeObjectBuffer;
-    Diligent::RefCntAutoPtr<Diligent::IBuffer> pDepthPrepassDrawCommandBuffer;
     Diligent::RefCntAutoPtr<Diligent::IBuffer> pSceneUBO;
     Diligent::RefCntAutoPtr<Diligent::IBuffer> pMeshInfoBuffer;
     Diligent::RefCntAutoPtr<Diligent::IPipelineState> pTransformPSO;
@@ -266,13 +611,13 @@ struct DiligentData {
     Diligent::RefCntAutoPtr<Diligent::IBuffer> pTransformUniforms;
     Diligent::RefCntAutoPtr<Diligent::IBuffer> pVisibleObjectAtomicCounter;
     Diligent::RefCntAutoPtr<Diligent::IBuffer> pDrawAtomicCounterBuffer;
-    Diligent::RefCntAutoPtr<Diligent::IBuffer> pVisibleLargeObjectAtomicCounter;
     Diligent::RefCntAutoPtr<Diligent::IBuffer> pTransparentAtomicCounter;
-    Diligent::RefCntAutoPtr<Diligent::IBuffer> pDepthPrepassAtomicCounter;
     Diligent::RefCntAutoPtr<Diligent::IBuffer> pVBO;
     Diligent::RefCntAutoPtr<Diligent::IBuffer> pEBO;
+    Diligent::RefCntAutoPtr<Diligent::IBuffer> pShortEBO;
     Diligent::RefCntAutoPtr<Diligent::ITexture> pHiZTextures[NumFrames];
     Diligent::RefCntAutoPtr<Diligent::ITexture> pDepthRenderbuffers[NumFrames];
+    Diligent::RefCntAutoPtr<Diligent::ITexture> pSceneColorTexture;
     Diligent::RefCntAutoPtr<Diligent::ISampler> pHiZSampler;
     Diligent::RefCntAutoPtr<Diligent::IQuery> pTransformStartQuery[NumFrames];
     Diligent::RefCntAutoPtr<Diligent::IQuery> pTransformEndQuery[NumFrames];
@@ -285,12 +630,6 @@ struct DiligentData {
     Diligent::RefCntAutoPtr<Diligent::IQuery> pOpaqueSortEndQuery[NumFrames];
     Diligent::RefCntAutoPtr<Diligent::IQuery> pCommandGenStartQuery[NumFrames];
     Diligent::RefCntAutoPtr<Diligent::IQuery> pCommandGenEndQuery[NumFrames];
-    Diligent::RefCntAutoPtr<Diligent::IQuery> pLargeObjectSortStartQuery[NumFrames];
-    Diligent::RefCntAutoPtr<Diligent::IQuery> pLargeObjectSortEndQuery[NumFrames];
-    Diligent::RefCntAutoPtr<Diligent::IQuery> pLargeObjectCommandGenStartQuery[NumFrames];
-    Diligent::RefCntAutoPtr<Diligent::IQuery> pLargeObjectCommandGenEndQuery[NumFrames];
-    Diligent::RefCntAutoPtr<Diligent::IQuery> pDepthPrePassStartQuery[NumFrames];
-    Diligent::RefCntAutoPtr<Diligent::IQuery> pDepthPrePassEndQuery[NumFrames];
     Diligent::RefCntAutoPtr<Diligent::IQuery> pTransparentCullStartQuery[NumFrames];
     Diligent::RefCntAutoPtr<Diligent::IQuery> pTransparentCullEndQuery[NumFrames];
     Diligent::RefCntAutoPtr<Diligent::IQuery> pTransparentSortStartQuery[NumFrames];
@@ -305,63 +644,111 @@ struct DiligentData {
     Diligent::RefCntAutoPtr<Diligent::IQuery> pHizMipmapEndQuery[NumFrames];
     Diligent::RefCntAutoPtr<Diligent::IQuery> pUiStartQuery[NumFrames];
     Diligent::RefCntAutoPtr<Diligent::IQuery> pUiEndQuery[NumFrames];
-    Diligent::RefCntAutoPtr<Diligent::IQuery> pLargeObjectCullStartQuery[NumFrames];
-    Diligent::RefCntAutoPtr<Diligent::IQuery> pLargeObjectCullEndQuery[NumFrames];
+    Diligent::RefCntAutoPtr<Diligent::IQuery> pOcclusionCullStartQuery[NumFrames];
+    Diligent::RefCntAutoPtr<Diligent::IQuery> pOcclusionCullEndQuery[NumFrames];
+    Diligent::RefCntAutoPtr<Diligent::IQuery> pOcclusionSortStartQuery[NumFrames];
+    Diligent::RefCntAutoPtr<Diligent::IQuery> pOcclusionSortEndQuery[NumFrames];
+    Diligent::RefCntAutoPtr<Diligent::IQuery> pOcclusionCommandGenStartQuery[NumFrames];
+    Diligent::RefCntAutoPtr<Diligent::IQuery> pOcclusionCommandGenEndQuery[NumFrames];
+    Diligent::RefCntAutoPtr<Diligent::IQuery> pOcclusionDrawStartQuery[NumFrames];
+    Diligent::RefCntAutoPtr<Diligent::IQuery> pOcclusionDrawEndQuery[NumFrames];
 
     bool QueryReady[NumFrames] = {false};
-    bool OpaqueSortActive[NumFrames] = {false};
-    bool LargeObjectSortActive[NumFrames] = {false};
-    bool TransparentSortActive[NumFrames] = {false};
-    bool TransparentDrawActive[NumFrames] = {false};
 
-    Diligent::RefCntAutoPtr<Diligent::IShaderResourceBinding> pHiZMipmapSRB;
-    Diligent::RefCntAutoPtr<Diligent::IShaderResourceBinding> pCullingSRB;
-    Diligent::RefCntAutoPtr<Diligent::IShaderResourceBinding> pOpaqueSortSRB;
-    Diligent::RefCntAutoPtr<Diligent::IShaderResourceBinding> pCommandGenSRB;
-    Diligent::RefCntAutoPtr<Diligent::IShaderResourceBinding> pLargeObjectCullSRB;
-    Diligent::RefCntAutoPtr<Diligent::IShaderResourceBinding> pLargeObjectSortSRB;
-    Diligent::RefCntAutoPtr<Diligent::IShaderResourceBinding> pTransparentCullSRB;
+    FrameBindings frameBindings[NumFrames];
 
-    Diligent::RefCntAutoPtr<Diligent::IPipelineState> pHiZMipmapPSO;
     Diligent::RefCntAutoPtr<Diligent::IPipelineState> pCullingPSO;
     Diligent::RefCntAutoPtr<Diligent::IPipelineState> pOpaqueSortPSO;
     Diligent::RefCntAutoPtr<Diligent::IPipelineState> pCommandGenPSO;
-    Diligent::RefCntAutoPtr<Diligent::IPipelineState> pLargeObjectCullPSO;
-    Diligent::RefCntAutoPtr<Diligent::IPipelineState> pLargeObjectSortPSO;
     Diligent::RefCntAutoPtr<Diligent::IPipelineState> pTransparentCullPSO;
 
-    Diligent::RefCntAutoPtr<Diligent::IBuffer> pStagingBuffer;
     Diligent::RefCntAutoPtr<Diligent::IBuffer> pOpaqueSortConstants;
     Diligent::RefCntAutoPtr<Diligent::IBuffer> pCullingUniforms;
     Diligent::RefCntAutoPtr<Diligent::IBuffer> pCommandGenConstants;
-    Diligent::RefCntAutoPtr<Diligent::IShaderResourceBinding> pTransparentSortSRB;
     Diligent::RefCntAutoPtr<Diligent::IPipelineState> pTransparentSortPSO;
     Diligent::RefCntAutoPtr<Diligent::IBuffer> pTransparentSortConstants;
 
-    Diligent::RefCntAutoPtr<Diligent::IShaderResourceBinding> pTransparentCommandGenSRB;
     Diligent::RefCntAutoPtr<Diligent::IPipelineState> pTransparentCommandGenPSO;
-    Diligent::RefCntAutoPtr<Diligent::IBuffer> pTransparentCommandGenUniforms;
-
-    Diligent::RefCntAutoPtr<Diligent::IShaderResourceBinding> pLargeObjectCommandGenSRB;
-    Diligent::RefCntAutoPtr<Diligent::IPipelineState> pLargeObjectCommandGenPSO;
-    Diligent::RefCntAutoPtr<Diligent::IBuffer> pLargeObjectCommandGenUniforms;
-
-    Diligent::RefCntAutoPtr<Diligent::IShaderResourceBinding> pDepthPrepassSRB;
-    Diligent::RefCntAutoPtr<Diligent::IPipelineState> pDepthPrepassPSO;
 
-    std::vector<Diligent::RefCntAutoPtr<Diligent::IShaderResourceBinding>> pOpaqueSRBs;
+    Diligent::RefCntAutoPtr<Diligent::IShaderResourceBinding> pDispatchArgsSRB;
+    Diligent::RefCntAutoPtr<Diligent::IPipelineState> pDispatchArgsPSO;
+    Diligent::RefCntAutoPtr<Diligent::IBuffer> pDispatchArgsConstants;
+    Diligent::RefCntAutoPtr<Diligent::IBuffer> pDispatchArgsBuffer;
+    Diligent::IShaderResourceVariable* pDispatchArgsCountVar = nullptr;
+
+    Diligent::RefCntAutoPtr<Diligent::IShaderResourceBinding> pDrawRunScanSRB;
+    Diligent::RefCntAutoPtr<Diligent::IPipelineState> pDrawRunScanPSO;
+    Diligent::RefCntAutoPtr<Diligent::IShaderResourceBinding> pDrawRunGroupScanSRB;
+    Diligent::RefCntAutoPtr<Diligent::IPipelineState> pDrawRunGroupScanPSO;
+    Diligent::RefCntAutoPtr<Diligent::IShaderResourceBinding> pDrawRunCompactSRB;
+    Diligent::RefCntAutoPtr<Diligent::IPipelineState> pDrawRunCompactPSO;
+    Diligent::RefCntAutoPtr<Diligent::IBuffer> pDrawRunConstants;
+    Diligent::RefCntAutoPtr<Diligent::IBuffer> pRunScanBuffer;
+    Diligent::RefCntAutoPtr<Diligent::IBuffer> pRunGroupBuffer;
+    Diligent::RefCntAutoPtr<Diligent::IBuffer> pRunStartBuffer;
+    Diligent::RefCntAutoPtr<Diligent::IBuffer> pRunCountBuffer;
+    // The sorted key buffer depends on the radix pass count, so these variables are rebound each
+    // phase; they are looked up once when the SRBs are created.
+    Diligent::IShaderResourceVariable* pDrawRunCountVars[3] = {};
+    Diligent::IShaderResourceVariable* pDrawRunSortKeyVar = nullptr;
+
+    // Shared LSD radix sort. The cull passes write keys/values [0]; pass p reads [p % 2] and writes
+    // [(p + 1) % 2].
+    Diligent::RefCntAutoPtr<Diligent::IShaderResourceBinding> pRadixHistogramSRBs[2];
+    Diligent::RefCntAutoPtr<Diligent::IPipelineState> pRadixHistogramPSO;
+    Diligent::RefCntAutoPtr<Diligent::IShaderResourceBinding> pRadixScanSRB;
+    Diligent::RefCntAutoPtr<Diligent::IPipelineState> pRadixScanPSO;
+    Diligent::RefCntAutoPtr<Diligent::IShaderResourceBinding> pRadixScatterSRBs[2];
+    Diligent::RefCntAutoPtr<Diligent::IPipelineState> pRadixScatterPSO;
+    Diligent::RefCntAutoPtr<Diligent::IBuffer> pRadixSortConstants;
+    Diligent::RefCntAutoPtr<Diligent::IBuffer> pSortKeyConstants;
+    Diligent::RefCntAutoPtr<Diligent::IBuffer> pSortKeyBuffers[2];
+    Diligent::RefCntAutoPtr<Diligent::IBuffer> pSortValueBuffers[2];
+    Diligent::RefCntAutoPtr<Diligent::IBuffer> pSortHistogramBuffer;
+    Diligent::IShaderResourceVariable* pRadixCountVars[5] = {};
+
+    // One SRB per Hi-Z texture with its mip views bound once in init.
+    Diligent::RefCntAutoPtr<Diligent::IShaderResourceBinding> pHiZDownsampleSRBs[NumFrames];
+    Diligent::RefCntAutoPtr<Diligent::IPipelineState> pHiZDownsamplePSO;
+    Diligent::RefCntAutoPtr<Diligent::ITextureView> pHiZMipViews[NumFrames][HIZ_MAX_MIP_COUNT];
+    Diligent::RefCntAutoPtr<Diligent::IBuffer> pHiZDownsampleCounter;
+
+    Diligent::RefCntAutoPtr<Diligent::IShaderResourceBinding> pPresentSRB;
+    Diligent::RefCntAutoPtr<Diligent::IPipelineState> pPresentPSO;
 
     Diligent::RefCntAutoPtr<Diligent::IPipelineState> pTransparentPSO;
-    Diligent::RefCntAutoPtr<Diligent::IShaderResourceBinding> pTransparentSRB;
     std::vector<Diligent::RefCntAutoPtr<Diligent::IPipelineState>> pOpaquePSOs;
 
-    Diligent::RefCntAutoPtr<Diligent::IBuffer> pLargeObjectCullConstants;
-    Diligent::RefCntAutoPtr<Diligent::IBuffer> pLargeObjectSortConstants;
     Diligent::RefCntAutoPtr<Diligent::IBuffer> pTransparentCullUniforms;
+
+    // Cluster culling. Candidates and meshlet draws are produced and consumed within one opaque
+    // phase, so a single copy serves every frame in flight.
+    Diligent::RefCntAutoPtr<Diligent::IPipelineState> pClusterCullPSO;
+    Diligent::RefCntAutoPtr<Diligent::IBuffer> pMeshletBuffer;
+    Diligent::RefCntAutoPtr<Diligent::IBuffer> pClusterCandidateCounter;
+    Diligent::RefCntAutoPtr<Diligent::IBuffer> pClusterCandidateBuffer;
+    Diligent::RefCntAutoPtr<Diligent::IBuffer> pClusterDrawCounterBuffer;
+    Diligent::RefCntAutoPtr<Diligent::IBuffer> pClusterDrawCommandBuffer;
+    Diligent::RefCntAutoPtr<Diligent::IBuffer> pClusterInstanceBuffer;
+
+    // Instance records of the opaque and transparent draws. Each list's command gen overwrites it
+    // after the previous list's draws, which GL executes in order.
+    Diligent::RefCntAutoPtr<Diligent::IBuffer> pInstanceBuffer;
+
+    // Clustered point lights. The lights are uploaded and binned once per frame ahead of the
+    // draws that read them, and GL runs those in order, so one copy of each buffer is enough.
+    Diligent::RefCntAutoPtr<Diligent::IPipelineState> pLightBinPSO;
+    Diligent::RefCntAutoPtr<Diligent::IBuffer> pLightBuffer;
+    Diligent::RefCntAutoPtr<Diligent::IBuffer> pFroxelLightCountBuffer;
+    Diligent::RefCntAutoPtr<Diligent::IBuffer> pFroxelLightIndexBuffer;
+
+    // World transforms, normal matrices and bounds of one frame slot, back to back, for transform
+    // validation.
+    Diligent::RefCntAutoPtr<Diligent::IBuffer> pTransformReadbackBuffer;
 };
 
 Renderer::Renderer()
-    : m_initialized(false), m_vboSize(0), m_eboSize(0), m_numDrawingShaders(0),
+    : m_initialized(false), m_vboSize(0), m_eboSize(0), m_shortEboSize(0), m_numDrawingShaders(0), m_numDrawBins(0),
       fullProfiling(false) {}
 
 void Renderer::init(GLFWwindow* window, const int windowWidth, const int windowHeight) {
@@ -398,27 +785,16 @@ void Renderer::init(GLFWwindow* window, const int windowWidth, const int windowH
     m_uiManager = new UIManager();
     m_uiManager->init(m_diligent->pDevice, m_diligent->pImmediateContext, m_diligent->pSwapChain, windowWidth, windowHeight);
 
-    createDepthPrepassPSO();
     createOpaquePSOs();
     createTransparentPSO();
     createTransformPSO();
-    createHiZPSO();
+    createPresentPSO();
     createCullingPSO();
     createOpaqueSortPSO();
     createCommandGenPSO();
-    createLargeObjectCullPSO();
-    createLargeObjectSortPSO();
-
-    createLargeObjectCommandGenPSO();
-    if (m_diligent->pLargeObjectCommandGenUniforms == nullptr) {
-        Diligent::BufferDesc CBDesc;
-        CBDesc.Name = "Large Object Command Gen Uniforms";
-        CBDesc.Usage = Diligent::USAGE_DEFAULT;
-        CBDesc.BindFlags = Diligent::BIND_UNIFORM_BUFFER;
-        CBDesc.Size = sizeof(LargeObjectCommandGenUniforms);
-        m_diligent->pDevice->CreateBuffer(CBDesc, nullptr, &m_diligent->pLargeObjectCommandGenUniforms);
-    }
     createTransparentCullPSO();
+    createClusterCullPSO();
+    createLightBinPSO();
 
     if (m_diligent->pTransparentCullUniforms == nullptr) {
         Diligent::BufferDesc CBDesc;
@@ -435,35 +811,26 @@ void Renderer::init(GLFWwindow* window, const int windowWidth, const int windowH
         CBDesc.Name = "Transparent Sort Constants";
         CBDesc.Usage = Diligent::USAGE_DEFAULT;
         CBDesc.BindFlags = Diligent::BIND_UNIFORM_BUFFER;
+        CBDesc.CPUAccessFlags = Diligent::CPU_ACCESS_NONE;
         CBDesc.Size = sizeof(SortConstants);
         m_diligent->pDevice->CreateBuffer(CBDesc, nullptr, &m_diligent->pTransparentSortConstants);
     }
 
     createTransparentCommandGenPSO();
-    if (m_diligent->pTransparentCommandGenUniforms == nullptr) {
-        Diligent::BufferDesc CBDesc;
-        CBDesc.Name = "Transparent Command Gen Uniforms";
-        CBDesc.Usage = Diligent::USAGE_DEFAULT;
-        CBDesc.BindFlags = Diligent::BIND_UNIFORM_BUFFER;
-        CBDesc.Size = sizeof(TransparentCommandGenUniforms);
-        m_diligent->pDevice->CreateBuffer(CBDesc, nullptr, &m_diligent->pTransparentCommandGenUniforms);
-    }
+    createDispatchArgsPSO();
+    createDrawRunPSOs();
+    createRadixSortPSOs();
 
     const unsigned int zero = 0;
     m_diligent->pVisibleObjectAtomicCounter = CreateStructuredBuffer(m_diligent->pDevice, "Visible Object Atomic Counter", sizeof(unsigned int), 1, (void*)&zero);
     m_visibleObjectAtomicCounter = (GLuint)(size_t)m_diligent->pVisibleObjectAtomicCounter->GetNativeHandle();
 
     m_numDrawingShaders = 16;
-    std::vector<unsigned int> drawZeros(m_numDrawingShaders, 0);
-    m_diligent->pDrawAtomicCounterBuffer = CreateStructuredBuffer(m_diligent->pDevice, "Draw Atomic Counter Buffer", sizeof(unsigned int), m_numDrawingShaders, drawZeros.data(), Diligent::BIND_INDIRECT_DRAW_ARGS);
+    m_numDrawBins = m_numDrawingShaders * INDEX_TYPE_COUNT;
+    std::vector<unsigned int> drawZeros(m_numDrawBins, 0);
+    m_diligent->pDrawAtomicCounterBuffer = CreateStructuredBuffer(m_diligent->pDevice, "Draw Atomic Counter Buffer", sizeof(unsigned int), m_numDrawBins, drawZeros.data(), Diligent::BIND_INDIRECT_DRAW_ARGS);
     m_drawAtomicCounterBuffer = (GLuint)(size_t)m_diligent->pDrawAtomicCounterBuffer->GetNativeHandle();
 
-    m_diligent->pVisibleLargeObjectAtomicCounter = CreateStructuredBuffer(m_diligent->pDevice, "Visible Large Object Atomic Counter", sizeof(unsigned int), 1, (void*)&zero);
-    m_visibleLargeObjectAtomicCounter = (GLuint)(size_t)m_diligent->pVisibleLargeObjectAtomicCounter->GetNativeHandle();
-
-    m_maxObjects = 1000000;
-    reallocateBuffers(m_maxObjects);
-
     Diligent::QueryDesc queryDesc;
     queryDesc.Type = Diligent::QUERY_TYPE_TIMESTAMP;
 
@@ -480,9 +847,6 @@ void Renderer::init(GLFWwindow* window, const int windowWidth, const int windowH
     CREATE_QUERY_PAIR("Cull", pCullStartQuery, pCullEndQuery);
     CREATE_QUERY_PAIR("Opaque Sort", pOpaqueSortStartQuery, pOpaqueSortEndQuery);
     CREATE_QUERY_PAIR("Command Gen", pCommandGenStartQuery, pCommandGenEndQuery);
-    CREATE_QUERY_PAIR("Large Object Sort", pLargeObjectSortStartQuery, pLargeObjectSortEndQuery);
-    CREATE_QUERY_PAIR("Large Object Command Gen", pLargeObjectCommandGenStartQuery, pLargeObjectCommandGenEndQuery);
-    CREATE_QUERY_PAIR("Depth Pre-Pass", pDepthPrePassStartQuery, pDepthPrePassEndQuery);
     CREATE_QUERY_PAIR("Transparent Cull", pTransparentCullStartQuery, pTransparentCullEndQuery);
     CREATE_QUERY_PAIR("Transparent Sort", pTransparentSortStartQuery, pTransparentSortEndQuery);
     CREATE_QUERY_PAIR("Transparent Command Gen", pTransparentCommandGenStartQuery, pTransparentCommandGenEndQuery);
@@ -490,7 +854,10 @@ void Renderer::init(GLFWwindow* window, const int windowWidth, const int windowH
     CREATE_QUERY_PAIR("Transparent Draw", pTransparentDrawStartQuery, pTransparentDrawEndQuery);
     CREATE_QUERY_PAIR("Hi-Z Mipmap", pHizMipmapStartQuery, pHizMipmapEndQuery);
     CREATE_QUERY_PAIR("UI", pUiStartQuery, pUiEndQuery);
-    CREATE_QUERY_PAIR("Large Object Cull", pLargeObjectCullStartQuery, pLargeObjectCullEndQuery);
+    CREATE_QUERY_PAIR("Occlusion Cull", pOcclusionCullStartQuery, pOcclusionCullEndQuery);
+    CREATE_QUERY_PAIR("Occlusion Sort", pOcclusionSortStartQuery, pOcclusionSortEndQuery);
+    CREATE_QUERY_PAIR("Occlusion Command Gen", pOcclusionCommandGenStartQuery, pOcclusionCommandGenEndQuery);
+    CREATE_QUERY_PAIR("Occlusion Draw", pOcclusionDrawStartQuery, pOcclusionDrawEndQuery);
 
 #undef CREATE_QUERY_PAIR
 
@@ -518,10 +885,14 @@ void Renderer::init(GLFWwindow* window, const int windowWidth, const int windowH
     m_diligent->pDevice->CreateBuffer(EBODesc, nullptr, &m_diligent->pEBO);
     m_ebo = (GLuint)(size_t)m_diligent->pEBO->GetNativeHandle();
 
-    m_diligent->pTransparentAtomicCounter = CreateStructuredBuffer(m_diligent->pDevice, "Transparent Atomic Counter", sizeof(unsigned int), 1, (void*)&zero);
+    m_shortEboSize = 1024 * 1024 * 2;
+    m_diligent->pShortEBO = CreateIndexBuffer(m_diligent->pDevice, m_shortEboSize);
+
+    m_diligent->pTransparentAtomicCounter = CreateStructuredBuffer(m_diligent->pDevice, "Transparent Atomic Counter", sizeof(unsigned int), 1, (void*)&zero, Diligent::BIND_INDIRECT_DRAW_ARGS);
     m_transparentAtomicCounter = (GLuint)(size_t)m_diligent->pTransparentAtomicCounter->GetNativeHandle();
 
     m_maxMipLevel = static_cast<int>(std::floor(std::log2(std::max(windowWidth, windowHeight))));
+    m_hizMipCount = std::min(m_maxMipLevel, HIZ_MAX_MIP_COUNT);
 
     for (int i = 0; i < NUM_FRAMES_IN_FLIGHT; ++i) {
         Diligent::TextureDesc HiZDesc;
@@ -531,22 +902,32 @@ void Renderer::init(GLFWwindow* window, const int windowWidth, const int windowH
         HiZDesc.Height = windowHeight;
         HiZDesc.Format = Diligent::TEX_FORMAT_R32_FLOAT;
         HiZDesc.Usage = Diligent::USAGE_DEFAULT;
-        HiZDesc.BindFlags = Diligent::BIND_SHADER_RESOURCE | Diligent::BIND_UNORDERED_ACCESS | Diligent::BIND_RENDER_TARGET;
-        HiZDesc.MipLevels = m_maxMipLevel;
+        HiZDesc.BindFlags = Diligent::BIND_SHADER_RESOURCE | Diligent::BIND_UNORDERED_ACCESS;
+        HiZDesc.MipLevels = m_hizMipCount;
 
         m_diligent->pHiZTextures[i].Release();
         m_diligent->pDevice->CreateTexture(HiZDesc, nullptr, &m_diligent->pHiZTextures[i]);
         m_hizTexture[i] = (GLuint)(size_t)m_diligent->pHiZTextures[i]->GetNativeHandle();
         Lit::Log::Info("Hi-Z Texture {}: native handle {}", i, m_hizTexture[i]);
 
+        for (int mip = 0; mip < m_hizMipCount; ++mip) {
+            Diligent::TextureViewDesc MipViewDesc;
+            MipViewDesc.ViewType = Diligent::TEXTURE_VIEW_UNORDERED_ACCESS;
+            MipViewDesc.AccessFlags = Diligent::UAV_ACCESS_FLAG_READ_WRITE;
+            MipViewDesc.MostDetailedMip = mip;
+            MipViewDesc.NumMipLevels = 1;
+            m_diligent->pHiZMipViews[i][mip].Release();
+            m_diligent->pHiZTextures[i]->CreateView(MipViewDesc, &m_diligent->pHiZMipViews[i][mip]);
+        }
+
         Diligent::TextureDesc DepthDesc;
-        DepthDesc.Name = "Depth Pre-pass Renderbuffer";
+        DepthDesc.Name = "Scene Depth Buffer";
         DepthDesc.Type = Diligent::RESOURCE_DIM_TEX_2D;
         DepthDesc.Width = windowWidth;
         DepthDesc.Height = windowHeight;
         DepthDesc.Format = Diligent::TEX_FORMAT_D32_FLOAT;
         DepthDesc.Usage = Diligent::USAGE_DEFAULT;
-        DepthDesc.BindFlags = Diligent::BIND_DEPTH_STENCIL;
+        DepthDesc.BindFlags = Diligent::BIND_DEPTH_STENCIL | Diligent::BIND_SHADER_RESOURCE;
 
         m_diligent->pDepthRenderbuffers[i].Release();
         m_diligent->pDevice->CreateTexture(DepthDesc, nullptr, &m_diligent->pDepthRenderbuffers[i]);
@@ -554,6 +935,16 @@ void Renderer::init(GLFWwindow* window, const int windowWidth, const int windowH
         Lit::Log::Info("Depth Renderbuffer {}: native handle {}", i, m_depthRenderbuffer[i]);
     }
 
+    Diligent::TextureDesc SceneColorDesc;
+    SceneColorDesc.Name = "Scene Color Texture";
+    SceneColorDesc.Type = Diligent::RESOURCE_DIM_TEX_2D;
+    SceneColorDesc.Width = windowWidth;
+    SceneColorDesc.Height = windowHeight;
+    SceneColorDesc.Format = Diligent::TEX_FORMAT_RGBA8_UNORM;
+    SceneColorDesc.Usage = Diligent::USAGE_DEFAULT;
+    SceneColorDesc.BindFlags = Diligent::BIND_RENDER_TARGET | Diligent::BIND_SHADER_RESOURCE;
+    m_diligent->pDevice->CreateTexture(SceneColorDesc, nullptr, &m_diligent->pSceneColorTexture);
+
     Diligent::SamplerDesc SamplerCI;
     SamplerCI.Name = "Hi-Z Sampler";
     SamplerCI.MinFilter = Diligent::FILTER_TYPE_POINT;
@@ -563,17 +954,36 @@ void Renderer::init(GLFWwindow* window, const int windowWidth, const int windowH
     SamplerCI.AddressV = Diligent::TEXTURE_ADDRESS_CLAMP;
     m_diligent->pDevice->CreateSampler(SamplerCI, &m_diligent->pHiZSampler);
 
-    m_diligent->pDepthPrepassAtomicCounter = CreateStructuredBuffer(m_diligent->pDevice, "Depth Prepass Atomic Counter", sizeof(unsigned int), 1, (void*)&zero);
-    m_depthPrepassAtomicCounter = (GLuint)(size_t)m_diligent->pDepthPrepassAtomicCounter->GetNativeHandle();
+    m_diligent->pHiZDownsampleCounter = CreateStructuredBuffer(m_diligent->pDevice, "Hi-Z Downsample Counter", sizeof(unsigned int), 1, (void*)&zero);
+    createHiZDownsamplePSO();
+
+    m_diligent->pDispatchArgsBuffer = CreateStructuredBuffer(m_diligent->pDevice, "Dispatch Args Buffer", sizeof(DispatchIndirectCommand), DISPATCH_ARGS_SLOT_COUNT, nullptr, Diligent::BIND_INDIRECT_DRAW_ARGS);
+    if (m_diligent->pDispatchArgsSRB) {
+        if (auto* var = m_diligent->pDispatchArgsSRB->GetVariableByName(Diligent::SHADER_TYPE_COMPUTE, "DispatchArgsBuffer"))
+            var->Set(m_diligent->pDispatchArgsBuffer->GetDefaultView(Diligent::BUFFER_VIEW_UNORDERED_ACCESS));
+    }
+
+    if (m_diligent->pPresentSRB) {
+        if (auto* var = m_diligent->pPresentSRB->GetVariableByName(Diligent::SHADER_TYPE_PIXEL, "u_sceneColor"))
+            var->Set(m_diligent->pSceneColorTexture->GetDefaultView(Diligent::TEXTURE_VIEW_SHADER_RESOURCE));
+    }
+
+    m_meshletCapacity = 1024;
+    m_diligent->pMeshletBuffer = CreateStructuredBuffer(m_diligent->pDevice, "Meshlet Buffer", sizeof(Meshlet), m_meshletCapacity);
+    m_diligent->pClusterCandidateCounter = CreateStructuredBuffer(m_diligent->pDevice, "Cluster Candidate Counter", sizeof(unsigned int), 1, (void*)&zero);
+    m_diligent->pClusterCandidateBuffer = CreateStructuredBuffer(m_diligent->pDevice, "Cluster Candidate Buffer", sizeof(unsigned int), MAX_CLUSTER_CANDIDATES);
+    m_diligent->pClusterDrawCounterBuffer = CreateStructuredBuffer(m_diligent->pDevice, "Cluster Draw Counter Buffer", sizeof(unsigned int), m_numDrawBins, drawZeros.data(), Diligent::BIND_INDIRECT_DRAW_ARGS);
+    m_diligent->pClusterDrawCommandBuffer = CreateIndirectBuffer(m_diligent->pDevice, "Cluster Draw Command Buffer", m_numDrawBins * MAX_CLUSTER_DRAWS * sizeof(DrawElementsIndirectCommand));
+    m_diligent->pClusterInstanceBuffer = CreateStructuredBuffer(m_diligent->pDevice, "Cluster Instance Buffer", sizeof(InstanceData), m_numDrawBins * MAX_CLUSTER_DRAWS);
+
+    m_lightCapacity = 1024;
+    m_diligent->pLightBuffer = CreateStructuredBuffer(m_diligent->pDevice, "Light Buffer", sizeof(PointLight), m_lightCapacity);
+    m_diligent->pFroxelLightCountBuffer = CreateStructuredBuffer(m_diligent->pDevice, "Froxel Light Count Buffer", sizeof(unsigned int), LIGHT_GRID_FROXEL_COUNT);
+    m_diligent->pFroxelLightIndexBuffer = CreateStructuredBuffer(m_diligent->pDevice, "Froxel Light Index Buffer", sizeof(unsigned int), LIGHT_GRID_FROXEL_COUNT * MAX_LIGHTS_PER_FROXEL);
 
-    Diligent::BufferDesc StagingDesc;
-    StagingDesc.Name = "Staging Buffer";
-    StagingDesc.Usage = Diligent::USAGE_STAGING;
-    StagingDesc.BindFlags = Diligent::BIND_NONE;
-    StagingDesc.CPUAccessFlags = Diligent::CPU_ACCESS_READ;
-    StagingDesc.Size = sizeof(unsigned int);
-    m_diligent->pStagingBuffer.Release();
-    m_diligent->pDevice->CreateBuffer(StagingDesc, nullptr, &m_diligent->pStagingBuffer);
+    // Allocated last: the per-frame bindings reference the counters and Hi-Z textures above.
+    m_maxObjects = 1000000;
+    reallocateBuffers(m_maxObjects);
 
     Diligent::FenceDesc FenceCI;
     FenceCI.Type = Diligent::FENCE_TYPE_CPU_WAIT_ONLY;
@@ -590,8 +1000,17 @@ void Renderer::reallocateBuffers(size_t numObjects) {
     m_maxObjects = numObjects;
     Lit::Log::Info("Reallocating renderer buffers for {} objects.", m_maxObjects);
 
-    m_objectBufferSize = m_maxObjects * sizeof(TransformComponent) * NUM_FRAMES_IN_FLIGHT;
-    m_diligent->pObjectBuffer = CreateStructuredBuffer(m_diligent->pDevice, "Object Buffer", sizeof(TransformComponent), m_maxObjects * NUM_FRAMES_IN_FLIGHT);
+    m_objectBufferSize = m_maxObjects * sizeof(WorldTransform) * NUM_FRAMES_IN_FLIGHT;
+    m_diligent->pObjectBuffer = CreateStructuredBuffer(m_diligent->pDevice, "Object Buffer", sizeof(WorldTransform), m_maxObjects * NUM_FRAMES_IN_FLIGHT);
+
+    m_localTransformBufferSize = m_maxObjects * sizeof(TransformComponent) * NUM_FRAMES_IN_FLIGHT;
+    m_diligent->pLocalTransformBuffer = CreateStructuredBuffer(m_diligent->pDevice, "Local Transform Buffer", sizeof(TransformComponent), m_maxObjects * NUM_FRAMES_IN_FLIGHT);
+
+    m_boundsBufferSize = m_maxObjects * sizeof(glm::vec4) * NUM_FRAMES_IN_FLIGHT;
+    m_diligent->pBoundsBuffer = CreateStructuredBuffer(m_diligent->pDevice, "Bounds Buffer", sizeof(glm::vec4), m_maxObjects * NUM_FRAMES_IN_FLIGHT);
+
+    m_normalMatrixBufferSize = m_maxObjects * sizeof(WorldTransform) * NUM_FRAMES_IN_FLIGHT;
+    m_diligent->pNormalMatrixBuffer = CreateStructuredBuffer(m_diligent->pDevice, "Normal Matrix Buffer", sizeof(WorldTransform), m_maxObjects * NUM_FRAMES_IN_FLIGHT);
 
     m_hierarchyBufferSize = m_maxObjects * sizeof(HierarchyComponent) * NUM_FRAMES_IN_FLIGHT;
     m_diligent->pHierarchyBuffer = CreateStructuredBuffer(m_diligent->pDevice, "Hierarchy Buffer", sizeof(HierarchyComponent), m_maxObjects * NUM_FRAMES_IN_FLIGHT);
@@ -605,8 +1024,8 @@ void Renderer::reallocateBuffers(size_t numObjects) {
     for (int i = 0; i < NUM_FRAMES_IN_FLIGHT; ++i) {
         Diligent::BufferViewDesc ViewDesc;
         ViewDesc.ViewType = Diligent::BUFFER_VIEW_UNORDERED_ACCESS;
-        ViewDesc.ByteOffset = i * m_maxObjects * sizeof(TransformComponent);
-        ViewDesc.ByteWidth = m_maxObjects * sizeof(TransformComponent);
+        ViewDesc.ByteOffset = i * m_maxObjects * sizeof(WorldTransform);
+        ViewDesc.ByteWidth = m_maxObjects * sizeof(WorldTransform);
         m_diligent->pObjectBuffer->CreateView(ViewDesc, &m_diligent->pObjectBufferViews[i]);
 
         ViewDesc.ViewType = Diligent::BUFFER_VIEW_SHADER_RESOURCE;
@@ -624,25 +1043,26 @@ void Renderer::reallocateBuffers(size_t numObjects) {
     m_diligent->pVisibleObjectBuffer = CreateStructuredBuffer(m_diligent->pDevice, "Visible Objects Buffer", sizeof(unsigned int), m_maxObjects * NUM_FRAMES_IN_FLIGHT);
     m_visibleObjectBuffer = (GLuint)(size_t)m_diligent->pVisibleObjectBuffer->GetNativeHandle();
 
-    m_drawCommandBufferSize = m_maxObjects * m_numDrawingShaders * sizeof(DrawElementsIndirectCommand) * NUM_FRAMES_IN_FLIGHT;
+    m_drawCommandBufferSize = m_maxObjects * m_numDrawBins * sizeof(DrawElementsIndirectCommand) * NUM_FRAMES_IN_FLIGHT;
     m_diligent->pDrawCommandBuffer = CreateIndirectBuffer(m_diligent->pDevice, "Draw Command Buffer", m_drawCommandBufferSize);
     m_drawCommandBuffer = (GLuint)(size_t)m_diligent->pDrawCommandBuffer->GetNativeHandle();
 
-    m_visibleTransparentObjectIdsBufferSize = m_maxObjects * sizeof(VisibleTransparentObject) * NUM_FRAMES_IN_FLIGHT;
-    m_diligent->pVisibleTransparentObjectIdsBuffer = CreateStructuredBuffer(m_diligent->pDevice, "Visible Transparent Object IDs Buffer", sizeof(VisibleTransparentObject), m_maxObjects * NUM_FRAMES_IN_FLIGHT);
+    m_visibleTransparentObjectIdsBufferSize = m_maxObjects * sizeof(unsigned int) * NUM_FRAMES_IN_FLIGHT;
+    m_diligent->pVisibleTransparentObjectIdsBuffer = CreateStructuredBuffer(m_diligent->pDevice, "Visible Transparent Object IDs Buffer", sizeof(unsigned int), m_maxObjects * NUM_FRAMES_IN_FLIGHT);
     m_visibleTransparentObjectIdsBuffer = (GLuint)(size_t)m_diligent->pVisibleTransparentObjectIdsBuffer->GetNativeHandle();
 
     m_transparentDrawCommandBufferSize = m_maxObjects * m_numDrawingShaders * sizeof(DrawElementsIndirectCommand) * NUM_FRAMES_IN_FLIGHT;
     m_diligent->pTransparentDrawCommandBuffer = CreateIndirectBuffer(m_diligent->pDevice, "Transparent Draw Command Buffer", m_transparentDrawCommandBufferSize);
     m_transparentDrawCommandBuffer = (GLuint)(size_t)m_diligent->pTransparentDrawCommandBuffer->GetNativeHandle();
 
-    m_depthPrepassDrawCommandBufferSize = m_maxObjects * sizeof(DrawElementsIndirectCommand) * NUM_FRAMES_IN_FLIGHT;
-    m_diligent->pDepthPrepassDrawCommandBuffer = CreateIndirectBuffer(m_diligent->pDevice, "Depth Pre-pass Draw Command Buffer", m_depthPrepassDrawCommandBufferSize);
-    m_depthPrepassDrawCommandBuffer = (GLuint)(size_t)m_diligent->pDepthPrepassDrawCommandBuffer->GetNativeHandle();
+    m_diligent->pInstanceBuffer = CreateStructuredBuffer(m_diligent->pDevice, "Instance Buffer", sizeof(InstanceData), m_maxObjects);
 
-    m_visibleLargeObjectBufferSize = m_maxObjects * sizeof(unsigned int) * NUM_FRAMES_IN_FLIGHT;
-    m_diligent->pVisibleLargeObjectBuffer = CreateStructuredBuffer(m_diligent->pDevice, "Visible Large Objects Buffer", sizeof(unsigned int), m_maxObjects * NUM_FRAMES_IN_FLIGHT);
-    m_visibleLargeObjectBuffer = (GLuint)(size_t)m_diligent->pVisibleLargeObjectBuffer->GetNativeHandle();
+    // Visibility is carried from one frame to the next in GPU order, so a single copy serves every
+    // frame in flight. Starting from zero makes the first frame occlusion-test everything.
+    std::vector<uint32_t> visibilityZeros((m_maxObjects + 31) / 32, 0);
+    m_diligent->pVisibilityBuffer = CreateStructuredBuffer(m_diligent->pDevice, "Visibility Buffer", sizeof(uint32_t), visibilityZeros.size(), visibilityZeros.data());
+    std::vector<uint32_t> lodZeros(m_maxObjects, 0);
+    m_diligent->pLodStateBuffer = CreateStructuredBuffer(m_diligent->pDevice, "LOD State Buffer", sizeof(uint32_t), lodZeros.size(), lodZeros.data());
 
     const size_t alignedSceneUniformsSize = (sizeof(SceneUniforms) + 255) & ~255;
     m_sceneUBOSize = alignedSceneUniformsSize * NUM_FRAMES_IN_FLIGHT;
@@ -655,6 +1075,74 @@ void Renderer::reallocateBuffers(size_t numObjects) {
     m_diligent->pDevice->CreateBuffer(SceneUBODesc, nullptr, &m_diligent->pSceneUBO);
 
     m_diligent->pMeshInfoBuffer = CreateStructuredBuffer(m_diligent->pDevice, "Mesh Info Buffer", sizeof(MeshInfo), m_maxObjects);
+    m_meshInfoDirty = true;
+
+    // Scratch for the draw run passes; one frame's lists are processed at a time, so a single copy
+    // is shared by both opaque phases. Run starts hold one end sentinel.
+    const size_t maxRunGroups = (m_maxObjects + COMMAND_GEN_WORKGROUP_SIZE - 1) / COMMAND_GEN_WORKGROUP_SIZE;
+    m_diligent->pRunScanBuffer = CreateStructuredBuffer(m_diligent->pDevice, "Run Scan Buffer", sizeof(unsigned int), m_maxObjects);
+    m_diligent->pRunGroupBuffer = CreateStructuredBuffer(m_diligent->pDevice, "Run Group Buffer", sizeof(unsigned int), std::max<size_t>(maxRunGroups, 1));
+    m_diligent->pRunStartBuffer = CreateStructuredBuffer(m_diligent->pDevice, "Run Start Buffer", sizeof(unsigned int), m_maxObjects + 1);
+    m_diligent->pRunCountBuffer = CreateStructuredBuffer(m_diligent->pDevice, "Run Count Buffer", sizeof(unsigned int), 1);
+
+    if (m_diligent->pDrawRunScanSRB) {
+        if (auto* var = m_diligent->pDrawRunScanSRB->GetVariableByName(Diligent::SHADER_TYPE_COMPUTE, "RunScanBuffer"))
+            var->Set(m_diligent->pRunScanBuffer->GetDefaultView(Diligent::BUFFER_VIEW_UNORDERED_ACCESS), Diligent::SET_SHADER_RESOURCE_FLAG_ALLOW_OVERWRITE);
+        if (auto* var = m_diligent->pDrawRunScanSRB->GetVariableByName(Diligent::SHADER_TYPE_COMPUTE, "RunGroupBuffer"))
+            var->Set(m_diligent->pRunGroupBuffer->GetDefaultView(Diligent::BUFFER_VIEW_UNORDERED_ACCESS), Diligent::SET_SHADER_RESOURCE_FLAG_ALLOW_OVERWRITE);
+    }
+
+    if (m_diligent->pDrawRunGroupScanSRB) {
+        if (auto* var = m_diligent->pDrawRunGroupScanSRB->GetVariableByName(Diligent::SHADER_TYPE_COMPUTE, "RunGroupBuffer"))
+            var->Set(m_diligent->pRunGroupBuffer->GetDefaultView(Diligent::BUFFER_VIEW_UNORDERED_ACCESS), Diligent::SET_SHADER_RESOURCE_FLAG_ALLOW_OVERWRITE);
+        if (auto* var = m_diligent->pDrawRunGroupScanSRB->GetVariableByName(Diligent::SHADER_TYPE_COMPUTE, "RunCountBuffer"))
+            var->Set(m_diligent->pRunCountBuffer->GetDefaultView(Diligent::BUFFER_VIEW_UNORDERED_ACCESS), Diligent::SET_SHADER_RESOURCE_FLAG_ALLOW_OVERWRITE);
+    }
+
+    if (m_diligent->pDrawRunCompactSRB) {
+        if (auto* var = m_diligent->pDrawRunCompactSRB->GetVariableByName(Diligent::SHADER_TYPE_COMPUTE, "RunScanBuffer"))
+            var->Set(m_diligent->pRunScanBuffer->GetDefaultView(Diligent::BUFFER_VIEW_SHADER_RESOURCE), Diligent::SET_SHADER_RESOURCE_FLAG_ALLOW_OVERWRITE);
+        if (auto* var = m_diligent->pDrawRunCompactSRB->GetVariableByName(Diligent::SHADER_TYPE_COMPUTE, "RunGroupBuffer"))
+            var->Set(m_diligent->pRunGroupBuffer->GetDefaultView(Diligent::BUFFER_VIEW_SHADER_RESOURCE), Diligent::SET_SHADER_RESOURCE_FLAG_ALLOW_OVERWRITE);
+        if (auto* var = m_diligent->pDrawRunCompactSRB->GetVariableByName(Diligent::SHADER_TYPE_COMPUTE, "RunStartBuffer"))
+            var->Set(m_diligent->pRunStartBuffer->GetDefaultView(Diligent::BUFFER_VIEW_UNORDERED_ACCESS), Diligent::SET_SHADER_RESOURCE_FLAG_ALLOW_OVERWRITE);
+    }
+
+    // Radix sort scratch, shared by the list sorts like the draw run scratch. The histogram
+    // holds one count per digit and tile, digit-major.
+    const size_t maxSortTiles = (m_maxObjects + RADIX_SORT_TILE_SIZE - 1) / RADIX_SORT_TILE_SIZE;
+    for (int p = 0; p < 2; ++p) {
+        m_diligent->pSortKeyBuffers[p] = CreateStructuredBuffer(m_diligent->pDevice, "Sort Key Buffer", sizeof(uint64_t), m_maxObjects);
+        m_diligent->pSortValueBuffers[p] = CreateStructuredBuffer(m_diligent->pDevice, "Sort Value Buffer", sizeof(unsigned int), m_maxObjects);
+    }
+    m_diligent->pSortHistogramBuffer = CreateStructuredBuffer(m_diligent->pDevice, "Sort Histogram Buffer", sizeof(unsigned int), RADIX_SORT_BUCKETS * std::max<size_t>(maxSortTiles, 1));
+
+    for (int p = 0; p < 2; ++p) {
+        if (auto* pSRB = m_diligent->pRadixHistogramSRBs[p].RawPtr()) {
+            if (auto* var = pSRB->GetVariableByName(Diligent::SHADER_TYPE_COMPUTE, "SortKeyBuffer"))
+                var->Set(m_diligent->pSortKeyBuffers[p]->GetDefaultView(Diligent::BUFFER_VIEW_SHADER_RESOURCE), Diligent::SET_SHADER_RESOURCE_FLAG_ALLOW_OVERWRITE);
+            if (auto* var = pSRB->GetVariableByName(Diligent::SHADER_TYPE_COMPUTE, "SortHistogramBuffer"))
+                var->Set(m_diligent->pSortHistogramBuffer->GetDefaultView(Diligent::BUFFER_VIEW_UNORDERED_ACCESS), Diligent::SET_SHADER_RESOURCE_FLAG_ALLOW_OVERWRITE);
+        }
+
+        if (auto* pSRB = m_diligent->pRadixScatterSRBs[p].RawPtr()) {
+            if (auto* var = pSRB->GetVariableByName(Diligent::SHADER_TYPE_COMPUTE, "SortKeyBuffer"))
+                var->Set(m_diligent->pSortKeyBuffers[p]->GetDefaultView(Diligent::BUFFER_VIEW_SHADER_RESOURCE), Diligent::SET_SHADER_RESOURCE_FLAG_ALLOW_OVERWRITE);
+            if (auto* var = pSRB->GetVariableByName(Diligent::SHADER_TYPE_COMPUTE, "SortValueBuffer"))
+                var->Set(m_diligent->pSortValueBuffers[p]->GetDefaultView(Diligent::BUFFER_VIEW_SHADER_RESOURCE), Diligent::SET_SHADER_RESOURCE_FLAG_ALLOW_OVERWRITE);
+            if (auto* var = pSRB->GetVariableByName(Diligent::SHADER_TYPE_COMPUTE, "SortHistogramBuffer"))
+                var->Set(m_diligent->pSortHistogramBuffer->GetDefaultView(Diligent::BUFFER_VIEW_SHADER_RESOURCE), Diligent::SET_SHADER_RESOURCE_FLAG_ALLOW_OVERWRITE);
+            if (auto* var = pSRB->GetVariableByName(Diligent::SHADER_TYPE_COMPUTE, "SortedKeyBuffer"))
+                var->Set(m_diligent->pSortKeyBuffers[1 - p]->GetDefaultView(Diligent::BUFFER_VIEW_UNORDERED_ACCESS), Diligent::SET_SHADER_RESOURCE_FLAG_ALLOW_OVERWRITE);
+            if (auto* var = pSRB->GetVariableByName(Diligent::SHADER_TYPE_COMPUTE, "SortedValueBuffer"))
+                var->Set(m_diligent->pSortValueBuffers[1 - p]->GetDefaultView(Diligent::BUFFER_VIEW_UNORDERED_ACCESS), Diligent::SET_SHADER_RESOURCE_FLAG_ALLOW_OVERWRITE);
+        }
+    }
+
+    if (m_diligent->pRadixScanSRB) {
+        if (auto* var = m_diligent->pRadixScanSRB->GetVariableByName(Diligent::SHADER_TYPE_COMPUTE, "SortHistogramBuffer"))
+            var->Set(m_diligent->pSortHistogramBuffer->GetDefaultView(Diligent::BUFFER_VIEW_UNORDERED_ACCESS), Diligent::SET_SHADER_RESOURCE_FLAG_ALLOW_OVERWRITE);
+    }
 
     if (m_diligent->pTransformPSO) {
         m_diligent->pTransformSRB.Release();
@@ -664,102 +1152,215 @@ void Renderer::reallocateBuffers(size_t numObjects) {
             return;
         }
         auto* transformBuf = m_diligent->pTransformSRB->GetVariableByName(Diligent::SHADER_TYPE_COMPUTE, "TransformBuffer");
+        auto* localTransformBuf = m_diligent->pTransformSRB->GetVariableByName(Diligent::SHADER_TYPE_COMPUTE, "LocalTransformBuffer");
         auto* hierarchyBuf = m_diligent->pTransformSRB->GetVariableByName(Diligent::SHADER_TYPE_COMPUTE, "HierarchyBuffer");
         auto* sortedBuf = m_diligent->pTransformSRB->GetVariableByName(Diligent::SHADER_TYPE_COMPUTE, "SortedHierarchyBuffer");
+        auto* boundsBuf = m_diligent->pTransformSRB->GetVariableByName(Diligent::SHADER_TYPE_COMPUTE, "BoundsBuffer");
+        auto* normalMatrixBuf = m_diligent->pTransformSRB->GetVariableByName(Diligent::SHADER_TYPE_COMPUTE, "NormalMatrixBuffer");
+        auto* renderableBuf = m_diligent->pTransformSRB->GetVariableByName(Diligent::SHADER_TYPE_COMPUTE, "RenderableBuffer");
+        auto* meshInfoBuf = m_diligent->pTransformSRB->GetVariableByName(Diligent::SHADER_TYPE_COMPUTE, "MeshInfoBuffer");
         auto* uniformsVar = m_diligent->pTransformSRB->GetVariableByName(Diligent::SHADER_TYPE_COMPUTE, "TransformUniforms");
 
-        if (!transformBuf || !hierarchyBuf || !sortedBuf || !uniformsVar) {
+        if (!transformBuf || !localTransformBuf || !hierarchyBuf || !sortedBuf || !boundsBuf || !normalMatrixBuf || !renderableBuf || !meshInfoBuf || !uniformsVar) {
             Lit::Log::Error("Failed to get transform shader variables");
             return;
         }
 
         transformBuf->Set(m_diligent->pObjectBuffer->GetDefaultView(Diligent::BUFFER_VIEW_UNORDERED_ACCESS));
+        localTransformBuf->Set(m_diligent->pLocalTransformBuffer->GetDefaultView(Diligent::BUFFER_VIEW_SHADER_RESOURCE));
         hierarchyBuf->Set(m_diligent->pHierarchyBuffer->GetDefaultView(Diligent::BUFFER_VIEW_SHADER_RESOURCE));
         sortedBuf->Set(m_diligent->pSortedHierarchyBuffer->GetDefaultView(Diligent::BUFFER_VIEW_SHADER_RESOURCE));
+        boundsBuf->Set(m_diligent->pBoundsBuffer->GetDefaultView(Diligent::BUFFER_VIEW_UNORDERED_ACCESS));
+        normalMatrixBuf->Set(m_diligent->pNormalMatrixBuffer->GetDefaultView(Diligent::BUFFER_VIEW_UNORDERED_ACCESS));
+        renderableBuf->Set(m_diligent->pRenderableBuffer->GetDefaultView(Diligent::BUFFER_VIEW_SHADER_RESOURCE));
+        meshInfoBuf->Set(m_diligent->pMeshInfoBuffer->GetDefaultView(Diligent::BUFFER_VIEW_SHADER_RESOURCE));
         uniformsVar->Set(m_diligent->pTransformUniforms);
     }
 
-    if (m_diligent->pCullingPSO) {
-        m_diligent->pCullingSRB.Release();
-        m_diligent->pCullingPSO->CreateShaderResourceBinding(&m_diligent->pCullingSRB, true);
-        if (!m_diligent->pCullingSRB) {
+    createFrameBindings();
+
+    for (int i = 0; i < NUM_FRAMES_IN_FLIGHT; ++i) {
+        m_pendingTransformRanges[i].assign(1, DirtyRange{0, INVALID_ENTITY});
+        m_pendingRenderableRanges[i].assign(1, DirtyRange{0, INVALID_ENTITY});
+        m_pendingHierarchyRanges[i].assign(1, DirtyRange{0, INVALID_ENTITY});
+    }
+    m_fullTransformUpdateCounter = NUM_FRAMES_IN_FLIGHT;
+}
+
+void Renderer::createFrameBindings() {
+    auto Bind = [](Diligent::IShaderResourceBinding* pSRB, Diligent::SHADER_TYPE shaderType, const char* name, Diligent::IDeviceObject* pObject) {
+        if (auto* var = pSRB->GetVariableByName(shaderType, name))
+            var->Set(pObject);
+    };
+
+    auto CreateSRB = [](Diligent::IPipelineState* pPSO, Diligent::RefCntAutoPtr<Diligent::IShaderResourceBinding>& pSRB) {
+        pSRB.Release();
+        if (pPSO)
+            pPSO->CreateShaderResourceBinding(&pSRB, true);
+        return pSRB.RawPtr();
+    };
+
+    const size_t alignedSceneUniformsSize = (sizeof(SceneUniforms) + 255) & ~255;
+
+    for (int i = 0; i < NUM_FRAMES_IN_FLIGHT; ++i) {
+        FrameBindings& frame = m_diligent->frameBindings[i];
+
+        // Views of frame i's slice of a buffer holding NUM_FRAMES_IN_FLIGHT consecutive slices of
+        // m_maxObjects * elementsPerObject elements.
+        auto CreateFrameView = [&](Diligent::IBuffer* pBuffer, Diligent::BUFFER_VIEW_TYPE viewType, size_t elementSize, size_t elementsPerObject = 1) {
+            Diligent::BufferViewDesc ViewDesc;
+            ViewDesc.ViewType = viewType;
+            ViewDesc.ByteOffset = i * m_maxObjects * elementsPerObject * elementSize;
+            ViewDesc.ByteWidth = m_maxObjects * elementsPerObject * elementSize;
+            Diligent::RefCntAutoPtr<Diligent::IBufferView> pView;
+            pBuffer->CreateView(ViewDesc, &pView);
+            return pView;
+        };
+
+        // Every pass reading the scene uniforms sees this frame's slot of the scene UBO.
+        auto BindSceneData = [&](Diligent::IShaderResourceBinding* pSRB, Diligent::SHADER_TYPE shaderType) {
+            if (auto* var = pSRB->GetVariableByName(shaderType, "SceneData"))
+                var->SetBufferRange(m_diligent->pSceneUBO, i * alignedSceneUniformsSize, sizeof(SceneUniforms));
+        };
+
+        auto pObjectView = CreateFrameView(m_diligent->pObjectBuffer, Diligent::BUFFER_VIEW_SHADER_RESOURCE, sizeof(WorldTransform));
+        auto pBoundsView = CreateFrameView(m_diligent->pBoundsBuffer, Diligent::BUFFER_VIEW_SHADER_RESOURCE, sizeof(glm::vec4));
+        auto pNormalMatrixView = CreateFrameView(m_diligent->pNormalMatrixBuffer, Diligent::BUFFER_VIEW_SHADER_RESOURCE, sizeof(WorldTransform));
+        auto pRenderableView = CreateFrameView(m_diligent->pRenderableBuffer, Diligent::BUFFER_VIEW_SHADER_RESOURCE, sizeof(RenderableComponent));
+        auto pVisibleObjectUAV = CreateFrameView(m_diligent->pVisibleObjectBuffer, Diligent::BUFFER_VIEW_UNORDERED_ACCESS, sizeof(unsigned int));
+        auto pVisibleObjectSRV = CreateFrameView(m_diligent->pVisibleObjectBuffer, Diligent::BUFFER_VIEW_SHADER_RESOURCE, sizeof(unsigned int));
+        auto pVisibleTransparentUAV = CreateFrameView(m_diligent->pVisibleTransparentObjectIdsBuffer, Diligent::BUFFER_VIEW_UNORDERED_ACCESS, sizeof(unsigned int));
+        auto pVisibleTransparentSRV = CreateFrameView(m_diligent->pVisibleTransparentObjectIdsBuffer, Diligent::BUFFER_VIEW_SHADER_RESOURCE, sizeof(unsigned int));
+        auto pDrawCommandView = CreateFrameView(m_diligent->pDrawCommandBuffer, Diligent::BUFFER_VIEW_UNORDERED_ACCESS, sizeof(DrawElementsIndirectCommand), m_numDrawBins);
+        auto pTransparentDrawCommandView = CreateFrameView(m_diligent->pTransparentDrawCommandBuffer, Diligent::BUFFER_VIEW_UNORDERED_ACCESS, sizeof(DrawElementsIndirectCommand));
+
+        // The cull pass indexes the whole bounds and renderable buffers through u_baseIndex.
+        if (auto* pSRB = CreateSRB(m_diligent->pCullingPSO, frame.pCullingSRB)) {
+            BindSceneData(pSRB, Diligent::SHADER_TYPE_COMPUTE);
+            Bind(pSRB, Diligent::SHADER_TYPE_COMPUTE, "CullingUniforms", m_diligent->pCullingUniforms);
+            Bind(pSRB, Diligent::SHADER_TYPE_COMPUTE, "AtomicCounterBuffer", m_diligent->pVisibleObjectAtomicCounter->GetDefaultView(Diligent::BUFFER_VIEW_UNORDERED_ACCESS));
+            Bind(pSRB, Diligent::SHADER_TYPE_COMPUTE, "SortKeyBuffer", m_diligent->pSortKeyBuffers[0]->GetDefaultView(Diligent::BUFFER_VIEW_UNORDERED_ACCESS));
+            Bind(pSRB, Diligent::SHADER_TYPE_COMPUTE, "SortValueBuffer", m_diligent->pSortValueBuffers[0]->GetDefaultView(Diligent::BUFFER_VIEW_UNORDERED_ACCESS));
+            Bind(pSRB, Diligent::SHADER_TYPE_COMPUTE, "SortKeyConstants", m_diligent->pSortKeyConstants);
+            Bind(pSRB, Diligent::SHADER_TYPE_COMPUTE, "BoundsBuffer", m_diligent->pBoundsBuffer->GetDefaultView(Diligent::BUFFER_VIEW_SHADER_RESOURCE));
+            Bind(pSRB, Diligent::SHADER_TYPE_COMPUTE, "RenderableBuffer", m_diligent->pRenderableBuffer->GetDefaultView(Diligent::BUFFER_VIEW_SHADER_RESOURCE));
+            Bind(pSRB, Diligent::SHADER_TYPE_COMPUTE, "VisibilityBuffer", m_diligent->pVisibilityBuffer->GetDefaultView(Diligent::BUFFER_VIEW_UNORDERED_ACCESS));
+            Bind(pSRB, Diligent::SHADER_TYPE_COMPUTE, "u_hizTexture", m_diligent->pHiZTextures[i]->GetDefaultView(Diligent::TEXTURE_VIEW_SHADER_RESOURCE));
+            Bind(pSRB, Diligent::SHADER_TYPE_COMPUTE, "MeshInfoBuffer", m_diligent->pMeshInfoBuffer->GetDefaultView(Diligent::BUFFER_VIEW_SHADER_RESOURCE));
+            Bind(pSRB, Diligent::SHADER_TYPE_COMPUTE, "ClusterCandidateCountBuffer", m_diligent->pClusterCandidateCounter->GetDefaultView(Diligent::BUFFER_VIEW_UNORDERED_ACCESS));
+            Bind(pSRB, Diligent::SHADER_TYPE_COMPUTE, "ClusterCandidateBuffer", m_diligent->pClusterCandidateBuffer->GetDefaultView(Diligent::BUFFER_VIEW_UNORDERED_ACCESS));
+            Bind(pSRB, Diligent::SHADER_TYPE_COMPUTE, "LodStateBuffer", m_diligent->pLodStateBuffer->GetDefaultView(Diligent::BUFFER_VIEW_UNORDERED_ACCESS));
+        } else {
             Lit::Log::Error("Failed to create Culling SRB");
-            return;
         }
 
-        auto* sceneDataVar = m_diligent->pCullingSRB->GetVariableByName(Diligent::SHADER_TYPE_COMPUTE, "SceneData");
-        auto* cullingUniformsVar = m_diligent->pCullingSRB->GetVariableByName(Diligent::SHADER_TYPE_COMPUTE, "CullingUniforms");
-        auto* atomicCounterVar = m_diligent->pCullingSRB->GetVariableByName(Diligent::SHADER_TYPE_COMPUTE, "AtomicCounterBuffer");
-        auto* visibleObjectVar = m_diligent->pCullingSRB->GetVariableByName(Diligent::SHADER_TYPE_COMPUTE, "VisibleObjectBuffer");
-        auto* objectVar = m_diligent->pCullingSRB->GetVariableByName(Diligent::SHADER_TYPE_COMPUTE, "ObjectBuffer");
-        auto* meshInfoVar = m_diligent->pCullingSRB->GetVariableByName(Diligent::SHADER_TYPE_COMPUTE, "MeshInfoBuffer");
-        auto* renderableVar = m_diligent->pCullingSRB->GetVariableByName(Diligent::SHADER_TYPE_COMPUTE, "RenderableBuffer");
-
-        if (sceneDataVar && m_diligent->pSceneUBO)
-            sceneDataVar->Set(m_diligent->pSceneUBO);
-        if (cullingUniformsVar && m_diligent->pCullingUniforms)
-            cullingUniformsVar->Set(m_diligent->pCullingUniforms);
-        if (atomicCounterVar && m_diligent->pVisibleObjectAtomicCounter)
-            atomicCounterVar->Set(m_diligent->pVisibleObjectAtomicCounter->GetDefaultView(Diligent::BUFFER_VIEW_UNORDERED_ACCESS));
-        if (visibleObjectVar && m_diligent->pVisibleObjectBuffer)
-            visibleObjectVar->Set(m_diligent->pVisibleObjectBuffer->GetDefaultView(Diligent::BUFFER_VIEW_UNORDERED_ACCESS));
-        if (objectVar && m_diligent->pObjectBuffer)
-            objectVar->Set(m_diligent->pObjectBuffer->GetDefaultView(Diligent::BUFFER_VIEW_SHADER_RESOURCE));
-        if (meshInfoVar && m_diligent->pMeshInfoBuffer)
-            meshInfoVar->Set(m_diligent->pMeshInfoBuffer->GetDefaultView(Diligent::BUFFER_VIEW_SHADER_RESOURCE));
-        if (renderableVar && m_diligent->pRenderableBuffer)
-            renderableVar->Set(m_diligent->pRenderableBuffer->GetDefaultView(Diligent::BUFFER_VIEW_SHADER_RESOURCE));
-    }
-
-    if (m_diligent->pCommandGenPSO) {
-        m_diligent->pCommandGenSRB.Release();
-        m_diligent->pCommandGenPSO->CreateShaderResourceBinding(&m_diligent->pCommandGenSRB, true);
-
-        if (!m_diligent->pCommandGenSRB) {
-            Lit::Log::Error("Failed to create CommandGen SRB");
+        // Like the cull pass, cluster culling reads the object and renderable buffers through
+        // u_baseIndex.
+        if (auto* pSRB = CreateSRB(m_diligent->pClusterCullPSO, frame.pClusterCullSRB)) {
+            BindSceneData(pSRB, Diligent::SHADER_TYPE_COMPUTE);
+            Bind(pSRB, Diligent::SHADER_TYPE_COMPUTE, "CullingUniforms", m_diligent->pCullingUniforms);
+            Bind(pSRB, Diligent::SHADER_TYPE_COMPUTE, "ClusterCandidateBuffer", m_diligent->pClusterCandidateBuffer->GetDefaultView(Diligent::BUFFER_VIEW_SHADER_RESOURCE));
+            Bind(pSRB, Diligent::SHADER_TYPE_COMPUTE, "MeshInfoBuffer", m_diligent->pMeshInfoBuffer->GetDefaultView(Diligent::BUFFER_VIEW_SHADER_RESOURCE));
+            Bind(pSRB, Diligent::SHADER_TYPE_COMPUTE, "MeshletBuffer", m_diligent->pMeshletBuffer->GetDefaultView(Diligent::BUFFER_VIEW_SHADER_RESOURCE));
+            Bind(pSRB, Diligent::SHADER_TYPE_COMPUTE, "ObjectBuffer", m_diligent->pObjectBuffer->GetDefaultView(Diligent::BUFFER_VIEW_SHADER_RESOURCE));
+            Bind(pSRB, Diligent::SHADER_TYPE_COMPUTE, "RenderableBuffer", m_diligent->pRenderableBuffer->GetDefaultView(Diligent::BUFFER_VIEW_SHADER_RESOURCE));
+            Bind(pSRB, Diligent::SHADER_TYPE_COMPUTE, "ClusterDrawCountBuffer", m_diligent->pClusterDrawCounterBuffer->GetDefaultView(Diligent::BUFFER_VIEW_UNORDERED_ACCESS));
+            Bind(pSRB, Diligent::SHADER_TYPE_COMPUTE, "ClusterDrawCommandBuffer", m_diligent->pClusterDrawCommandBuffer->GetDefaultView(Diligent::BUFFER_VIEW_UNORDERED_ACCESS));
+            Bind(pSRB, Diligent::SHADER_TYPE_COMPUTE, "NormalMatrixBuffer", m_diligent->pNormalMatrixBuffer->GetDefaultView(Diligent::BUFFER_VIEW_SHADER_RESOURCE));
+            Bind(pSRB, Diligent::SHADER_TYPE_COMPUTE, "ClusterInstanceBuffer", m_diligent->pClusterInstanceBuffer->GetDefaultView(Diligent::BUFFER_VIEW_UNORDERED_ACCESS));
+            Bind(pSRB, Diligent::SHADER_TYPE_COMPUTE, "u_hizTexture", m_diligent->pHiZTextures[i]->GetDefaultView(Diligent::TEXTURE_VIEW_SHADER_RESOURCE));
         } else {
-            if (auto* var = m_diligent->pCommandGenSRB->GetVariableByName(Diligent::SHADER_TYPE_COMPUTE, "MeshInfoBuffer"))
-                var->Set(m_diligent->pMeshInfoBuffer->GetDefaultView(Diligent::BUFFER_VIEW_SHADER_RESOURCE));
-
-            if (auto* var = m_diligent->pCommandGenSRB->GetVariableByName(Diligent::SHADER_TYPE_COMPUTE, "DrawCommandBuffer"))
-                var->Set(m_diligent->pDrawCommandBuffer->GetDefaultView(Diligent::BUFFER_VIEW_UNORDERED_ACCESS));
+            Lit::Log::Error("Failed to create Cluster Cull SRB");
+        }
 
-            if (auto* var = m_diligent->pCommandGenSRB->GetVariableByName(Diligent::SHADER_TYPE_COMPUTE, "RenderableBuffer"))
-                var->Set(m_diligent->pRenderableBuffer->GetDefaultView(Diligent::BUFFER_VIEW_SHADER_RESOURCE));
+        if (auto* pSRB = CreateSRB(m_diligent->pOpaqueSortPSO, frame.pOpaqueSortSRB)) {
+            Bind(pSRB, Diligent::SHADER_TYPE_COMPUTE, "SortConstants", m_diligent->pOpaqueSortConstants);
+            Bind(pSRB, Diligent::SHADER_TYPE_COMPUTE, "VisibleObjectBuffer", pVisibleObjectUAV);
+            Bind(pSRB, Diligent::SHADER_TYPE_COMPUTE, "VisibleObjectCountBuffer", m_diligent->pVisibleObjectAtomicCounter->GetDefaultView(Diligent::BUFFER_VIEW_SHADER_RESOURCE));
+            frame.pOpaqueSortValueVar = pSRB->GetVariableByName(Diligent::SHADER_TYPE_COMPUTE, "SortValueBuffer");
+        }
 
-            if (auto* var = m_diligent->pCommandGenSRB->GetVariableByName(Diligent::SHADER_TYPE_COMPUTE, "VisibleObjectBuffer"))
-                var->Set(m_diligent->pVisibleObjectBuffer->GetDefaultView(Diligent::BUFFER_VIEW_SHADER_RESOURCE));
+        if (auto* pSRB = CreateSRB(m_diligent->pCommandGenPSO, frame.pCommandGenSRB)) {
+            Bind(pSRB, Diligent::SHADER_TYPE_COMPUTE, "MeshInfoBuffer", m_diligent->pMeshInfoBuffer->GetDefaultView(Diligent::BUFFER_VIEW_SHADER_RESOURCE));
+            Bind(pSRB, Diligent::SHADER_TYPE_COMPUTE, "DrawCommandBuffer", pDrawCommandView);
+            Bind(pSRB, Diligent::SHADER_TYPE_COMPUTE, "RenderableBuffer", pRenderableView);
+            Bind(pSRB, Diligent::SHADER_TYPE_COMPUTE, "VisibleObjectBuffer", pVisibleObjectSRV);
+            Bind(pSRB, Diligent::SHADER_TYPE_COMPUTE, "DrawAtomicCounterBuffer", m_diligent->pDrawAtomicCounterBuffer->GetDefaultView(Diligent::BUFFER_VIEW_UNORDERED_ACCESS));
+            Bind(pSRB, Diligent::SHADER_TYPE_COMPUTE, "RunStartBuffer", m_diligent->pRunStartBuffer->GetDefaultView(Diligent::BUFFER_VIEW_SHADER_RESOURCE));
+            Bind(pSRB, Diligent::SHADER_TYPE_COMPUTE, "RunCountBuffer", m_diligent->pRunCountBuffer->GetDefaultView(Diligent::BUFFER_VIEW_SHADER_RESOURCE));
+            Bind(pSRB, Diligent::SHADER_TYPE_COMPUTE, "LodStateBuffer", m_diligent->pLodStateBuffer->GetDefaultView(Diligent::BUFFER_VIEW_SHADER_RESOURCE));
+            Bind(pSRB, Diligent::SHADER_TYPE_COMPUTE, "CommandGenConstants", m_diligent->pCommandGenConstants);
+            Bind(pSRB, Diligent::SHADER_TYPE_COMPUTE, "VisibleObjectCountBuffer", m_diligent->pVisibleObjectAtomicCounter->GetDefaultView(Diligent::BUFFER_VIEW_SHADER_RESOURCE));
+            Bind(pSRB, Diligent::SHADER_TYPE_COMPUTE, "ObjectBuffer", pObjectView);
+            Bind(pSRB, Diligent::SHADER_TYPE_COMPUTE, "NormalMatrixBuffer", pNormalMatrixView);
+            Bind(pSRB, Diligent::SHADER_TYPE_COMPUTE, "InstanceBuffer", m_diligent->pInstanceBuffer->GetDefaultView(Diligent::BUFFER_VIEW_UNORDERED_ACCESS));
+        } else {
+            Lit::Log::Error("Failed to create CommandGen SRB");
+        }
 
-            if (auto* var = m_diligent->pCommandGenSRB->GetVariableByName(Diligent::SHADER_TYPE_COMPUTE, "DrawAtomicCounterBuffer"))
-                var->Set(m_diligent->pDrawAtomicCounterBuffer->GetDefaultView(Diligent::BUFFER_VIEW_UNORDERED_ACCESS));
+        auto BindDrawResources = [&](Diligent::IShaderResourceBinding* pSRB, Diligent::IBuffer* pInstanceBuffer) {
+            BindSceneData(pSRB, Diligent::SHADER_TYPE_VERTEX);
+            Bind(pSRB, Diligent::SHADER_TYPE_VERTEX, "InstanceBuffer", pInstanceBuffer->GetDefaultView(Diligent::BUFFER_VIEW_SHADER_RESOURCE));
+            Bind(pSRB, Diligent::SHADER_TYPE_PIXEL, "LightBuffer", m_diligent->pLightBuffer->GetDefaultView(Diligent::BUFFER_VIEW_SHADER_RESOURCE));
+            Bind(pSRB, Diligent::SHADER_TYPE_PIXEL, "FroxelLightCountBuffer", m_diligent->pFroxelLightCountBuffer->GetDefaultView(Diligent::BUFFER_VIEW_SHADER_RESOURCE));
+            Bind(pSRB, Diligent::SHADER_TYPE_PIXEL, "FroxelLightIndexBuffer", m_diligent->pFroxelLightIndexBuffer->GetDefaultView(Diligent::BUFFER_VIEW_SHADER_RESOURCE));
+        };
 
-            if (auto* var = m_diligent->pCommandGenSRB->GetVariableByName(Diligent::SHADER_TYPE_COMPUTE, "CommandGenConstants"))
-                var->Set(m_diligent->pCommandGenConstants);
+        frame.pOpaqueSRBs.clear();
+        frame.pOpaqueSRBs.resize(m_diligent->pOpaquePSOs.size());
+        for (size_t shaderId = 0; shaderId < m_diligent->pOpaquePSOs.size(); ++shaderId) {
+            if (auto* pSRB = CreateSRB(m_diligent->pOpaquePSOs[shaderId], frame.pOpaqueSRBs[shaderId]))
+                BindDrawResources(pSRB, m_diligent->pInstanceBuffer);
         }
-    }
 
-    if (m_diligent->pLargeObjectCullPSO) {
-        m_diligent->pLargeObjectCullSRB.Release();
-        m_diligent->pLargeObjectCullPSO->CreateShaderResourceBinding(&m_diligent->pLargeObjectCullSRB, true);
+        frame.pClusterSRBs.clear();
+        frame.pClusterSRBs.resize(m_diligent->pOpaquePSOs.size());
+        for (size_t shaderId = 0; shaderId < m_diligent->pOpaquePSOs.size(); ++shaderId) {
+            if (auto* pSRB = CreateSRB(m_diligent->pOpaquePSOs[shaderId], frame.pClusterSRBs[shaderId]))
+                BindDrawResources(pSRB, m_diligent->pClusterInstanceBuffer);
+        }
 
-        if (m_diligent->pLargeObjectCullSRB) {
+        if (auto* pSRB = CreateSRB(m_diligent->pTransparentCullPSO, frame.pTransparentCullSRB)) {
+            BindSceneData(pSRB, Diligent::SHADER_TYPE_COMPUTE);
+            Bind(pSRB, Diligent::SHADER_TYPE_COMPUTE, "TransparentCullUniforms", m_diligent->pTransparentCullUniforms);
+            Bind(pSRB, Diligent::SHADER_TYPE_COMPUTE, "SortKeyConstants", m_diligent->pSortKeyConstants);
+            Bind(pSRB, Diligent::SHADER_TYPE_COMPUTE, "AtomicCounterBuffer", m_diligent->pTransparentAtomicCounter->GetDefaultView(Diligent::BUFFER_VIEW_UNORDERED_ACCESS));
+            Bind(pSRB, Diligent::SHADER_TYPE_COMPUTE, "SortKeyBuffer", m_diligent->pSortKeyBuffers[0]->GetDefaultView(Diligent::BUFFER_VIEW_UNORDERED_ACCESS));
+            Bind(pSRB, Diligent::SHADER_TYPE_COMPUTE, "SortValueBuffer", m_diligent->pSortValueBuffers[0]->GetDefaultView(Diligent::BUFFER_VIEW_UNORDERED_ACCESS));
+            Bind(pSRB, Diligent::SHADER_TYPE_COMPUTE, "BoundsBuffer", pBoundsView);
+            Bind(pSRB, Diligent::SHADER_TYPE_COMPUTE, "RenderableBuffer", pRenderableView);
+        }
 
-            if (auto* var = m_diligent->pLargeObjectCullSRB->GetVariableByName(Diligent::SHADER_TYPE_COMPUTE, "SceneUniforms"))
-                var->Set(m_diligent->pSceneUBO);
+        if (auto* pSRB = CreateSRB(m_diligent->pTransparentSortPSO, frame.pTransparentSortSRB)) {
+            Bind(pSRB, Diligent::SHADER_TYPE_COMPUTE, "SortConstants", m_diligent->pTransparentSortConstants);
+            Bind(pSRB, Diligent::SHADER_TYPE_COMPUTE, "TransparentCountBuffer", m_diligent->pTransparentAtomicCounter->GetDefaultView(Diligent::BUFFER_VIEW_SHADER_RESOURCE));
+            Bind(pSRB, Diligent::SHADER_TYPE_COMPUTE, "VisibleTransparentObjectBuffer", pVisibleTransparentUAV);
+            frame.pTransparentSortValueVar = pSRB->GetVariableByName(Diligent::SHADER_TYPE_COMPUTE, "SortValueBuffer");
+        }
 
-            if (auto* var = m_diligent->pLargeObjectCullSRB->GetVariableByName(Diligent::SHADER_TYPE_COMPUTE, "MeshInfoBuffer"))
-                var->Set(m_diligent->pMeshInfoBuffer->GetDefaultView(Diligent::BUFFER_VIEW_SHADER_RESOURCE));
+        if (auto* pSRB = CreateSRB(m_diligent->pTransparentCommandGenPSO, frame.pTransparentCommandGenSRB)) {
+            Bind(pSRB, Diligent::SHADER_TYPE_COMPUTE, "TransparentCountBuffer", m_diligent->pTransparentAtomicCounter->GetDefaultView(Diligent::BUFFER_VIEW_SHADER_RESOURCE));
+            Bind(pSRB, Diligent::SHADER_TYPE_COMPUTE, "VisibleTransparentObjectBuffer", pVisibleTransparentSRV);
+            Bind(pSRB, Diligent::SHADER_TYPE_COMPUTE, "MeshInfoBuffer", m_diligent->pMeshInfoBuffer->GetDefaultView(Diligent::BUFFER_VIEW_SHADER_RESOURCE));
+            Bind(pSRB, Diligent::SHADER_TYPE_COMPUTE, "RenderableBuffer", pRenderableView);
+            Bind(pSRB, Diligent::SHADER_TYPE_COMPUTE, "TransparentDrawCommandBuffer", pTransparentDrawCommandView);
+            Bind(pSRB, Diligent::SHADER_TYPE_COMPUTE, "ObjectBuffer", pObjectView);
+            Bind(pSRB, Diligent::SHADER_TYPE_COMPUTE, "NormalMatrixBuffer", pNormalMatrixView);
+            Bind(pSRB, Diligent::SHADER_TYPE_COMPUTE, "InstanceBuffer", m_diligent->pInstanceBuffer->GetDefaultView(Diligent::BUFFER_VIEW_UNORDERED_ACCESS));
+        }
 
-            if (auto* var = m_diligent->pLargeObjectCullSRB->GetVariableByName(Diligent::SHADER_TYPE_COMPUTE, "VisibleLargeObjectAtomicCounter"))
-                var->Set(m_diligent->pVisibleLargeObjectAtomicCounter->GetDefaultView(Diligent::BUFFER_VIEW_UNORDERED_ACCESS));
+        if (auto* pSRB = CreateSRB(m_diligent->pTransparentPSO, frame.pTransparentSRB))
+            BindDrawResources(pSRB, m_diligent->pInstanceBuffer);
 
-            if (auto* var = m_diligent->pLargeObjectCullSRB->GetVariableByName(Diligent::SHADER_TYPE_COMPUTE, "LargeObjectCullConstants"))
-                var->Set(m_diligent->pLargeObjectCullConstants);
+        if (auto* pSRB = CreateSRB(m_diligent->pLightBinPSO, frame.pLightBinSRB)) {
+            BindSceneData(pSRB, Diligent::SHADER_TYPE_COMPUTE);
+            Bind(pSRB, Diligent::SHADER_TYPE_COMPUTE, "LightBuffer", m_diligent->pLightBuffer->GetDefaultView(Diligent::BUFFER_VIEW_SHADER_RESOURCE));
+            Bind(pSRB, Diligent::SHADER_TYPE_COMPUTE, "FroxelLightCountBuffer", m_diligent->pFroxelLightCountBuffer->GetDefaultView(Diligent::BUFFER_VIEW_UNORDERED_ACCESS));
+            Bind(pSRB, Diligent::SHADER_TYPE_COMPUTE, "FroxelLightIndexBuffer", m_diligent->pFroxelLightIndexBuffer->GetDefaultView(Diligent::BUFFER_VIEW_UNORDERED_ACCESS));
+        } else {
+            Lit::Log::Error("Failed to create Light Bin SRB");
         }
     }
-
-    m_dataUpdateCounter = NUM_FRAMES_IN_FLIGHT;
-    m_hierarchyUpdateCounter = NUM_FRAMES_IN_FLIGHT;
 }
 
 void Renderer::cleanup() {
@@ -784,15 +1385,22 @@ void Renderer::cleanup() {
 Renderer::~Renderer() { cleanup(); }
 
 void Renderer::uploadMesh(const Mesh& mesh) {
-    if (mesh.vertices.empty() || mesh.indices.empty()) {
+    if (mesh.vertices.empty() || mesh.indexCount() == 0) {
         return;
     }
 
-    const size_t vertexDataSize = mesh.vertices.size() * sizeof(float);
-    const size_t indexDataSize = mesh.indices.size() * sizeof(unsigned int);
+    // 16-bit meshes are drawn from the 16-bit buffer but also get a widened copy in the 32-bit one;
+    // see MeshInfo::wideFirstIndex.
+    const bool shortIndices = !mesh.shortIndices.empty();
+    const std::vector<unsigned int> widenedIndices = shortIndices ? std::vector<unsigned int>(mesh.shortIndices.begin(), mesh.shortIndices.end()) : std::vector<unsigned int>{};
+    const std::vector<unsigned int>& indices = shortIndices ? widenedIndices : mesh.indices;
 
-    Lit::Log::Info("Uploading mesh: {} vertices ({} bytes), {} indices ({} bytes)", mesh.vertices.size() / 6,
-                   vertexDataSize, mesh.indices.size(), indexDataSize);
+    const size_t vertexDataSize = mesh.vertices.size() * sizeof(PackedVertex);
+    const size_t indexDataSize = indices.size() * sizeof(unsigned int);
+    const size_t shortIndexDataSize = mesh.shortIndices.size() * sizeof(uint16_t);
+
+    Lit::Log::Info("Uploading mesh: {} vertices ({} bytes), {} indices ({} bytes, {}-bit)", mesh.vertices.size(),
+                   vertexDataSize, indices.size(), shortIndices ? shortIndexDataSize : indexDataSize, shortIndices ? 16 : 32);
 
     auto resizeBuffer = [&](Diligent::RefCntAutoPtr<Diligent::IBuffer>& pBuffer, size_t currentSize, size_t newSize,
                             bool isIndexBuffer) {
@@ -818,6 +1426,10 @@ void Renderer::uploadMesh(const Mesh& mesh) {
         resizeBuffer(m_diligent->pVBO, s_totalVertexSize, m_vboSize, false);
         resizeBuffer(m_diligent->pEBO, s_totalIndexSize, m_eboSize, true);
     }
+    if (s_totalShortIndexSize + shortIndexDataSize > m_shortEboSize) {
+        m_shortEboSize = std::max(m_shortEboSize * 2, s_totalShortIndexSize + shortIndexDataSize);
+        resizeBuffer(m_diligent->pShortEBO, s_totalShortIndexSize, m_shortEboSize, true);
+    }
 
     if (vertexDataSize > 0) {
         m_diligent->pImmediateContext->UpdateBuffer(m_diligent->pVBO, s_totalVertexSize, vertexDataSize,
@@ -825,24 +1437,26 @@ void Renderer::uploadMesh(const Mesh& mesh) {
     }
     if (indexDataSize > 0) {
         m_diligent->pImmediateContext->UpdateBuffer(m_diligent->pEBO, s_totalIndexSize, indexDataSize,
-                                                    mesh.indices.data(), Diligent::RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+                                                    indices.data(), Diligent::RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+    }
+    if (shortIndexDataSize > 0) {
+        m_diligent->pImmediateContext->UpdateBuffer(m_diligent->pShortEBO, s_totalShortIndexSize, shortIndexDataSize,
+                                                    mesh.shortIndices.data(), Diligent::RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
     }
 
     glm::vec3 center(0.0f);
-    const size_t numVertices = mesh.vertices.size() / 6;
+    const size_t numVertices = mesh.vertices.size();
     if (numVertices > 0) {
-        for (size_t i = 0; i < mesh.vertices.size(); i += 6) {
-            center.x += mesh.vertices[i];
-            center.y += mesh.vertices[i + 1];
-            center.z += mesh.vertices[i + 2];
+        for (size_t i = 0; i < numVertices; ++i) {
+            center += mesh.position(i);
         }
 
         center /= static_cast<float>(numVertices);
     }
 
     float maxRadiusSq = 0.0f;
-    for (size_t i = 0; i < mesh.vertices.size(); i += 6) {
-        const glm::vec3 vertex(mesh.vertices[i], mesh.vertices[i + 1], mesh.vertices[i + 2]);
+    for (size_t i = 0; i < numVertices; ++i) {
+        const glm::vec3 vertex = mesh.position(i);
         const float distSq = glm::distance2(center, vertex);
         if (distSq > maxRadiusSq) {
             maxRadiusSq = distSq;
@@ -850,27 +1464,62 @@ void Renderer::uploadMesh(const Mesh& mesh) {
     }
     const float radius = glm::sqrt(maxRadiusSq);
 
-    s_meshInfos.push_back({.indexCount = static_cast<unsigned int>(mesh.indices.size()),
-                           .firstIndex = static_cast<unsigned int>(s_totalIndexSize / sizeof(unsigned int)),
-                           .baseVertex = static_cast<unsigned int>(s_totalVertexSize / (6 * sizeof(float))),
+    // A mesh without a LOD chain is a single level over all of its indices.
+    const std::vector<MeshLod> lods = mesh.lods.empty() ? std::vector<MeshLod>{{0, static_cast<uint32_t>(indices.size())}} : mesh.lods;
+    const size_t lodCount = std::min<size_t>(lods.size(), MAX_MESH_LODS);
+
+    const unsigned int wideFirstIndex = static_cast<unsigned int>(s_totalIndexSize / sizeof(unsigned int));
+    s_meshInfos.push_back({.indexCount = lods[0].indexCount,
+                           .firstIndex = shortIndices ? static_cast<unsigned int>(s_totalShortIndexSize / sizeof(uint16_t)) : wideFirstIndex,
+                           .baseVertex = static_cast<unsigned int>(s_totalVertexSize / sizeof(PackedVertex)),
                            .boundingRadius = radius,
-                           .boundingCenter = glm::vec4(center, 1.0f)});
+                           .boundingCenter = glm::vec4(center, 1.0f),
+                           .firstMeshlet = static_cast<uint32_t>(s_meshlets.size()),
+                           .meshletCount = static_cast<uint32_t>(mesh.meshlets.size()),
+                           .lodCount = static_cast<uint32_t>(lodCount),
+                           .indexType = shortIndices ? INDEX_TYPE_UINT16 : INDEX_TYPE_UINT32,
+                           .positionOffset = glm::vec4(mesh.positionOffset, 0.0f),
+                           .positionScale = glm::vec4(mesh.positionScale, 0.0f),
+                           .wideFirstIndex = wideFirstIndex});
+    for (size_t lod = 0; lod < lodCount; ++lod) {
+        s_meshInfos.back().lodFirstIndex[lod] = lods[lod].firstIndex;
+        s_meshInfos.back().lodIndexCount[lod] = lods[lod].indexCount;
+    }
+    m_maxLodCount = std::max(m_maxLodCount, lodCount);
+    s_meshlets.insert(s_meshlets.end(), mesh.meshlets.begin(), mesh.meshlets.end());
+
+    if (s_meshlets.size() > m_meshletCapacity) {
+        m_diligent->pImmediateContext->WaitForIdle();
+        m_meshletCapacity = std::max(m_meshletCapacity * 2, s_meshlets.size());
+        m_diligent->pMeshletBuffer = CreateStructuredBuffer(m_diligent->pDevice, "Meshlet Buffer", sizeof(Meshlet), m_meshletCapacity);
+        createFrameBindings();
+    }
 
     s_totalVertexSize += vertexDataSize;
     s_totalIndexSize += indexDataSize;
+    s_totalShortIndexSize += shortIndexDataSize;
 
     m_meshInfoDirty = true;
 }
 
 void Renderer::setSmallObjectThreshold(float threshold) { m_smallObjectThreshold = threshold; }
-void Renderer::setLargeObjectThreshold(float threshold) { m_largeObjectThreshold = threshold; }
+void Renderer::setClusterCullThreshold(float threshold) { m_clusterCullThreshold = threshold; }
+void Renderer::setLodSelection(const LodSelection& selection) { m_lodSelection = selection; }
+void Renderer::setSortKeyBudget(const SortKeyBudget& budget) { m_sortKeyBudget = budget; }
+void Renderer::setTransformBackend(TransformBackend backend) {
+    if (backend != m_transformBackend) {
+        m_transformBackend = backend;
+        m_fullTransformUpdateCounter = NUM_FRAMES_IN_FLIGHT;
+    }
+}
+
+void Renderer::setTransformValidation(bool enabled) { m_transformValidation = enabled; }
 
 void Renderer::drawScene(SceneDatabase& sceneDatabase, const Camera& camera) {
     double transformTime = 0, opaqueCullTime = 0, opaqueSortTime = 0, opaqueCommandGenTime = 0;
-    double largeObjectCullTime = 0, largeObjectCommandGenTime = 0, depthPrePassTime = 0;
+    double occlusionCullTime = 0, occlusionSortTime = 0, occlusionCommandGenTime = 0, occlusionDrawTime = 0;
     double opaqueDrawTime = 0, transparentCullTime = 0, transparentSortTime = 0;
     double transparentCommandGenTime = 0, transparentDrawTime = 0, hizMipmapTime = 0, uiTime = 0;
-    double largeObjectSortTime = 0;
     std::chrono::high_resolution_clock::time_point start, end;
 
     float currentFrameTime = glfwGetTime();
@@ -884,17 +1533,27 @@ void Renderer::drawScene(SceneDatabase& sceneDatabase, const Camera& camera) {
         reallocateBuffers(numObjects * 1.5);
     }
 
+    const size_t numLights = sceneDatabase.lights.size();
+    if (numLights > m_lightCapacity) {
+        m_diligent->pImmediateContext->WaitForIdle();
+        m_lightCapacity = std::max(m_lightCapacity * 2, numLights);
+        m_diligent->pLightBuffer = CreateStructuredBuffer(m_diligent->pDevice, "Light Buffer", sizeof(PointLight), m_lightCapacity);
+        createFrameBindings();
+    }
+
     m_currentFrame = (m_currentFrame + 1) % NUM_FRAMES_IN_FLIGHT;
-    const int previousFrame = (m_currentFrame + NUM_FRAMES_IN_FLIGHT - 1) % NUM_FRAMES_IN_FLIGHT;
 
     {
         Diligent::Uint64 FenceValue = m_diligent->FenceValues[m_currentFrame];
         m_diligent->pFences[m_currentFrame]->Wait(FenceValue);
     }
 
+    if (m_transformReadbackFrame == static_cast<int>(m_currentFrame)) {
+        checkTransformReadback();
+    }
+
     if (m_processedHierarchyVersion < sceneDatabase.m_hierarchyVersion) {
         sceneDatabase.updateHierarchy();
-        m_hierarchyUpdateCounter = NUM_FRAMES_IN_FLIGHT;
         m_processedHierarchyVersion = sceneDatabase.m_hierarchyVersion;
     }
 
@@ -914,145 +1573,291 @@ void Renderer::drawScene(SceneDatabase& sceneDatabase, const Camera& camera) {
 
     m_diligent->pImmediateContext->EndQuery(m_diligent->pTransformStartQuery[m_currentFrame]);
 
-    auto ReadAtomicCounter = [&](Diligent::IBuffer* pAtomicBuffer) -> unsigned int {
-        m_diligent->pImmediateContext->CopyBuffer(pAtomicBuffer, 0, Diligent::RESOURCE_STATE_TRANSITION_MODE_TRANSITION, m_diligent->pStagingBuffer, 0, sizeof(unsigned int), Diligent::RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
-        m_diligent->pImmediateContext->WaitForIdle();
-        void* pData = nullptr;
-        m_diligent->pImmediateContext->MapBuffer(m_diligent->pStagingBuffer, Diligent::MAP_READ, Diligent::MAP_FLAG_NONE, pData);
-        unsigned int count = 0;
-        if (pData) {
-            count = *reinterpret_cast<unsigned int*>(pData);
-        }
-        m_diligent->pImmediateContext->UnmapBuffer(m_diligent->pStagingBuffer, Diligent::MAP_READ);
-        return count;
+    // Everything the CPU uploads this frame is written into the frame's region of the upload ring
+    // up to uploads.end(); the fence wait above guarantees the GPU is done with that region.
+    UploadRing& uploads = m_diligent->uploadRing;
+    uploads.begin(m_diligent->pDevice, m_diligent->pImmediateContext, m_currentFrame, NUM_FRAMES_IN_FLIGHT);
+
+    // Counters are reset by copying from a block of zeros that also covers the per-shader draw
+    // counters.
+    const Diligent::Uint64 counterZerosOffset = uploads.write(nullptr, sizeof(unsigned int) * m_numDrawBins);
+    auto ResetAtomicCounter = [&](Diligent::IBuffer* pBuffer) { uploads.copy(counterZerosOffset, pBuffer, 0, sizeof(unsigned int)); };
+
+    // The sort and command gen constants only depend on the list capacity. Every radix pass gets its
+    // own slot, and each is copied into the shared constant buffer in front of its dispatch.
+    RadixSortConstants radixSortConstants[RADIX_SORT_MAX_PASSES] = {};
+    for (uint32_t pass = 0; pass < RADIX_SORT_MAX_PASSES; ++pass) {
+        radixSortConstants[pass].shift = pass * 8;
+        radixSortConstants[pass].maxCount = static_cast<uint32_t>(m_maxObjects);
+    }
+    const Diligent::Uint64 radixSortConstantsOffset = uploads.write(radixSortConstants, sizeof(radixSortConstants));
+
+    SortConstants sortConstants = {};
+    sortConstants.maxCount = static_cast<uint32_t>(m_maxObjects);
+    const Diligent::Uint64 sortConstantsOffset = uploads.write(&sortConstants, sizeof(sortConstants));
+
+    CommandGenUniforms commandGenUniforms = {};
+    commandGenUniforms.maxDraws = static_cast<uint32_t>(m_maxObjects);
+    const Diligent::Uint64 commandGenUniformsOffset = uploads.write(&commandGenUniforms, sizeof(commandGenUniforms));
+
+    auto StageDispatchArgs = [&](DispatchArgsSlot firstSlot, std::initializer_list<uint32_t> groupSizes, size_t maxCount = SIZE_MAX) {
+        DispatchArgsConstants constants = {};
+        constants.maxCount = static_cast<uint32_t>(std::min(maxCount, m_maxObjects));
+        constants.firstSlot = firstSlot;
+        constants.slotCount = static_cast<uint32_t>(groupSizes.size());
+        std::copy(groupSizes.begin(), groupSizes.end(), constants.groupSizes);
+        return uploads.write(&constants, sizeof(constants));
     };
 
-    auto ResetAtomicCounter = [&](Diligent::IBuffer* pBuffer) {
-        unsigned int zero = 0;
-        m_diligent->pImmediateContext->UpdateBuffer(pBuffer, 0, sizeof(unsigned int), &zero, Diligent::RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
-    };
+    // Visible counts never leave the GPU: each counter is turned into indirect dispatch arguments
+    // for the passes that consume its list, as described by constants staged with
+    // StageDispatchArgs().
+    auto WriteDispatchArgs = [&](Diligent::IBuffer* pCounter, Diligent::Uint64 constantsOffset) {
+        uploads.copy(constantsOffset, m_diligent->pDispatchArgsConstants, 0, sizeof(DispatchArgsConstants));
 
-    if (m_processedDataVersion < sceneDatabase.m_dataVersion) {
-        m_dataUpdateCounter = NUM_FRAMES_IN_FLIGHT;
-        m_processedDataVersion = sceneDatabase.m_dataVersion;
-    }
+        if (auto* var = m_diligent->pDispatchArgsCountVar)
+            var->Set(pCounter->GetDefaultView(Diligent::BUFFER_VIEW_SHADER_RESOURCE), Diligent::SET_SHADER_RESOURCE_FLAG_ALLOW_OVERWRITE);
 
-    if (m_hierarchyUpdateCounter > 0) {
-        const size_t dataSize = sceneDatabase.hierarchies.size() * sizeof(HierarchyComponent);
-        const size_t frameOffsetBytes = m_currentFrame * m_maxObjects * sizeof(HierarchyComponent);
-        m_diligent->pImmediateContext->UpdateBuffer(m_diligent->pHierarchyBuffer, frameOffsetBytes, dataSize, sceneDatabase.hierarchies.data(), Diligent::RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+        m_diligent->pImmediateContext->SetPipelineState(m_diligent->pDispatchArgsPSO);
+        m_diligent->pImmediateContext->CommitShaderResources(m_diligent->pDispatchArgsSRB, Diligent::RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+        m_diligent->pImmediateContext->DispatchCompute(Diligent::DispatchComputeAttribs(1, 1, 1));
+    };
 
-        const size_t sortedHierarchyDataSize = sceneDatabase.sortedHierarchyList.size() * sizeof(unsigned int);
-        const size_t sortedHierarchyFrameOffsetBytes = m_currentFrame * m_maxObjects * sizeof(unsigned int);
-        m_diligent->pImmediateContext->UpdateBuffer(m_diligent->pSortedHierarchyBuffer, sortedHierarchyFrameOffsetBytes, sortedHierarchyDataSize, sceneDatabase.sortedHierarchyList.data(), Diligent::RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+    auto DispatchIndirect = [&](DispatchArgsSlot slot) {
+        Diligent::DispatchComputeIndirectAttribs Attribs;
+        Attribs.pAttribsBuffer = m_diligent->pDispatchArgsBuffer;
+        Attribs.AttribsBufferStateTransitionMode = Diligent::RESOURCE_STATE_TRANSITION_MODE_TRANSITION;
+        Attribs.DispatchArgsByteOffset = slot * sizeof(DispatchIndirectCommand);
+        m_diligent->pImmediateContext->DispatchComputeIndirect(Attribs);
+    };
 
-        m_hierarchyUpdateCounter--;
-    }
+    // Records an LSD radix sort of the (key, object id) pairs a cull pass emitted into keys/values
+    // [0], one 8-bit histogram/scan/scatter pass per key byte, then runs the list's sort pipeline
+    // to write the sorted ids back through pSortValueVar, pSRB's SortValueBuffer variable. Returns
+    // the index of the key buffer that holds the sorted keys.
+    auto RecordRadixSort = [&](Diligent::IPipelineState* pPSO, Diligent::IShaderResourceBinding* pSRB, Diligent::IShaderResourceVariable* pSortValueVar, Diligent::IBuffer* pConstants,
+                               Diligent::IBuffer* pCounter, DispatchArgsSlot tileSlot, DispatchArgsSlot elementSlot, uint32_t keyBits) {
+        const uint32_t passCount = std::clamp((keyBits + 7) / 8, 1u, RADIX_SORT_MAX_PASSES);
+
+        Diligent::IBufferView* pCountView = pCounter->GetDefaultView(Diligent::BUFFER_VIEW_SHADER_RESOURCE);
+        for (auto* var : m_diligent->pRadixCountVars) {
+            if (var)
+                var->Set(pCountView, Diligent::SET_SHADER_RESOURCE_FLAG_ALLOW_OVERWRITE);
+        }
 
-    if (m_dataUpdateCounter > 0) {
-        const size_t dataSize = sceneDatabase.transforms.size() * sizeof(TransformComponent);
-        const size_t frameOffsetBytes = m_currentFrame * m_maxObjects * sizeof(TransformComponent);
-        m_diligent->pImmediateContext->UpdateBuffer(m_diligent->pObjectBuffer, frameOffsetBytes, dataSize, sceneDatabase.transforms.data(), Diligent::RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+        for (uint32_t pass = 0; pass < passCount; ++pass) {
+            const int source = pass % 2;
+            uploads.copy(radixSortConstantsOffset + pass * sizeof(RadixSortConstants), m_diligent->pRadixSortConstants, 0, sizeof(RadixSortConstants));
 
-        const size_t renderableDataSize = sceneDatabase.renderables.size() * sizeof(RenderableComponent);
-        const size_t renderablesFrameOffsetBytes = m_currentFrame * m_maxObjects * sizeof(RenderableComponent);
-        m_diligent->pImmediateContext->UpdateBuffer(m_diligent->pRenderableBuffer, renderablesFrameOffsetBytes, renderableDataSize, sceneDatabase.renderables.data(), Diligent::RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+            m_diligent->pImmediateContext->SetPipelineState(m_diligent->pRadixHistogramPSO);
+            m_diligent->pImmediateContext->CommitShaderResources(m_diligent->pRadixHistogramSRBs[source], Diligent::RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+            DispatchIndirect(tileSlot);
 
-        m_dataUpdateCounter--;
-    }
+            Diligent::StateTransitionDesc Barrier;
+            Barrier.pResource = m_diligent->pSortHistogramBuffer;
+            Barrier.OldState = Diligent::RESOURCE_STATE_UNORDERED_ACCESS;
+            Barrier.NewState = Diligent::RESOURCE_STATE_UNORDERED_ACCESS;
+            Barrier.TransitionType = Diligent::STATE_TRANSITION_TYPE_IMMEDIATE;
+            Barrier.Flags = Diligent::STATE_TRANSITION_FLAG_UPDATE_STATE;
+            m_diligent->pImmediateContext->TransitionResourceStates(1, &Barrier);
 
-    const unsigned int transformWorkgroupSize = 256;
-    const unsigned int transformNumWorkgroups = (sceneDatabase.sortedHierarchyList.size() + transformWorkgroupSize - 1) / transformWorkgroupSize;
+            m_diligent->pImmediateContext->SetPipelineState(m_diligent->pRadixScanPSO);
+            m_diligent->pImmediateContext->CommitShaderResources(m_diligent->pRadixScanSRB, Diligent::RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+            m_diligent->pImmediateContext->DispatchCompute(Diligent::DispatchComputeAttribs(1, 1, 1));
 
-    struct TransformUniforms {
-        unsigned int objectCount;
-        unsigned int currentHierarchyLevel;
-        unsigned int baseIndex;
-        unsigned int padding;
-    } transformUniforms;
-    transformUniforms.objectCount = (unsigned int)sceneDatabase.sortedHierarchyList.size();
+            m_diligent->pImmediateContext->SetPipelineState(m_diligent->pRadixScatterPSO);
+            m_diligent->pImmediateContext->CommitShaderResources(m_diligent->pRadixScatterSRBs[source], Diligent::RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+            DispatchIndirect(tileSlot);
+        }
 
-    m_diligent->pImmediateContext->InvalidateState();
+        const int sorted = passCount % 2;
+        uploads.copy(sortConstantsOffset, pConstants, 0, sizeof(SortConstants));
+        if (pSortValueVar)
+            pSortValueVar->Set(m_diligent->pSortValueBuffers[sorted]->GetDefaultView(Diligent::BUFFER_VIEW_SHADER_RESOURCE), Diligent::SET_SHADER_RESOURCE_FLAG_ALLOW_OVERWRITE);
 
-    {
-        auto* pTransformVar = m_diligent->pTransformSRB->GetVariableByName(Diligent::SHADER_TYPE_COMPUTE, "TransformBuffer");
-        if (pTransformVar)
-            pTransformVar->Set(m_diligent->pObjectBuffer->GetDefaultView(Diligent::BUFFER_VIEW_UNORDERED_ACCESS), Diligent::SET_SHADER_RESOURCE_FLAG_ALLOW_OVERWRITE);
+        m_diligent->pImmediateContext->SetPipelineState(pPSO);
+        m_diligent->pImmediateContext->CommitShaderResources(pSRB, Diligent::RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+        DispatchIndirect(elementSlot);
+        return sorted;
+    };
 
-        auto* pHierarchyVar = m_diligent->pTransformSRB->GetVariableByName(Diligent::SHADER_TYPE_COMPUTE, "HierarchyBuffer");
-        if (pHierarchyVar)
-            pHierarchyVar->Set(m_diligent->pHierarchyBuffer->GetDefaultView(Diligent::BUFFER_VIEW_SHADER_RESOURCE), Diligent::SET_SHADER_RESOURCE_FLAG_ALLOW_OVERWRITE);
+    // Finds the draw runs of a sorted visible list with a flag/scan/compact over its sorted keys:
+    // entries whose keys only differ below runKeyShift (the depth field) share a run. Leaves the
+    // run starts and run count for command gen, which is dispatched from the same slot; there are
+    // never more runs than entries. constantsOffset is the staged DrawRunConstants carrying the shift.
+    auto RecordDrawRuns = [&](Diligent::IBuffer* pSortedKeys, Diligent::IBuffer* pCounter, DispatchArgsSlot slot, Diligent::Uint64 constantsOffset) {
+        uploads.copy(constantsOffset, m_diligent->pDrawRunConstants, 0, sizeof(DrawRunConstants));
+
+        Diligent::IBufferView* pCountView = pCounter->GetDefaultView(Diligent::BUFFER_VIEW_SHADER_RESOURCE);
+        for (auto* var : m_diligent->pDrawRunCountVars) {
+            if (var)
+                var->Set(pCountView, Diligent::SET_SHADER_RESOURCE_FLAG_ALLOW_OVERWRITE);
+        }
+        if (auto* var = m_diligent->pDrawRunSortKeyVar)
+            var->Set(pSortedKeys->GetDefaultView(Diligent::BUFFER_VIEW_SHADER_RESOURCE), Diligent::SET_SHADER_RESOURCE_FLAG_ALLOW_OVERWRITE);
 
-        auto* pSortedVar = m_diligent->pTransformSRB->GetVariableByName(Diligent::SHADER_TYPE_COMPUTE, "SortedHierarchyBuffer");
-        if (pSortedVar)
-            pSortedVar->Set(m_diligent->pSortedHierarchyBuffer->GetDefaultView(Diligent::BUFFER_VIEW_SHADER_RESOURCE), Diligent::SET_SHADER_RESOURCE_FLAG_ALLOW_OVERWRITE);
+        m_diligent->pImmediateContext->SetPipelineState(m_diligent->pDrawRunScanPSO);
+        m_diligent->pImmediateContext->CommitShaderResources(m_diligent->pDrawRunScanSRB, Diligent::RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+        DispatchIndirect(slot);
 
-        for (uint32_t level = 0; level <= sceneDatabase.m_maxHierarchyDepth; ++level) {
-            transformUniforms.currentHierarchyLevel = level;
-            transformUniforms.baseIndex = m_currentFrame * m_maxObjects;
-            m_diligent->pImmediateContext->UpdateBuffer(m_diligent->pTransformUniforms, 0, sizeof(transformUniforms), &transformUniforms, Diligent::RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+        Diligent::StateTransitionDesc Barrier;
+        Barrier.pResource = m_diligent->pRunGroupBuffer;
+        Barrier.OldState = Diligent::RESOURCE_STATE_UNORDERED_ACCESS;
+        Barrier.NewState = Diligent::RESOURCE_STATE_UNORDERED_ACCESS;
+        Barrier.TransitionType = Diligent::STATE_TRANSITION_TYPE_IMMEDIATE;
+        Barrier.Flags = Diligent::STATE_TRANSITION_FLAG_UPDATE_STATE;
+        m_diligent->pImmediateContext->TransitionResourceStates(1, &Barrier);
 
-            m_diligent->pImmediateContext->SetPipelineState(m_diligent->pTransformPSO);
-            m_diligent->pImmediateContext->CommitShaderResources(m_diligent->pTransformSRB, Diligent::RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+        m_diligent->pImmediateContext->SetPipelineState(m_diligent->pDrawRunGroupScanPSO);
+        m_diligent->pImmediateContext->CommitShaderResources(m_diligent->pDrawRunGroupScanSRB, Diligent::RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+        m_diligent->pImmediateContext->DispatchCompute(Diligent::DispatchComputeAttribs(1, 1, 1));
 
-            Diligent::DispatchComputeAttribs DispatchAttrs;
-            DispatchAttrs.ThreadGroupCountX = transformNumWorkgroups;
-            DispatchAttrs.ThreadGroupCountY = 1;
-            DispatchAttrs.ThreadGroupCountZ = 1;
-            m_diligent->pImmediateContext->DispatchCompute(DispatchAttrs);
+        m_diligent->pImmediateContext->SetPipelineState(m_diligent->pDrawRunCompactPSO);
+        m_diligent->pImmediateContext->CommitShaderResources(m_diligent->pDrawRunCompactSRB, Diligent::RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+        DispatchIndirect(slot);
+    };
+
+    auto UploadDirtyRanges = [&]<typename T>(std::vector<DirtyRange>& ranges, Diligent::IBuffer* pBuffer, std::span<const T> column) {
+        const size_t frameOffsetBytes = m_currentFrame * m_maxObjects * sizeof(T);
+        for (const auto& range : ranges) {
+            const size_t rangeEnd = std::min<size_t>(range.end, column.size());
+            if (range.begin >= rangeEnd) {
+                continue;
+            }
+            uploads.write(column.data() + range.begin, (rangeEnd - range.begin) * sizeof(T), pBuffer, frameOffsetBytes + range.begin * sizeof(T));
         }
+        ranges.clear();
+    };
 
-        m_diligent->pImmediateContext->WaitForIdle();
+    if (m_processedDataVersion < sceneDatabase.m_dataVersion || sceneDatabase.hasDynamicEntities()) {
+        sceneDatabase.consumeDirtyRanges(m_dirtyTransformRanges, m_dirtyRenderableRanges, m_dirtyHierarchyRanges);
+        for (int i = 0; i < NUM_FRAMES_IN_FLIGHT; ++i) {
+            m_pendingTransformRanges[i].insert(m_pendingTransformRanges[i].end(), m_dirtyTransformRanges.begin(), m_dirtyTransformRanges.end());
+            coalesceDirtyRanges(m_pendingTransformRanges[i], MAX_DIRTY_UPLOAD_RANGES);
+            m_pendingRenderableRanges[i].insert(m_pendingRenderableRanges[i].end(), m_dirtyRenderableRanges.begin(), m_dirtyRenderableRanges.end());
+            coalesceDirtyRanges(m_pendingRenderableRanges[i], MAX_DIRTY_UPLOAD_RANGES);
+            m_pendingHierarchyRanges[i].insert(m_pendingHierarchyRanges[i].end(), m_dirtyHierarchyRanges.begin(), m_dirtyHierarchyRanges.end());
+            coalesceDirtyRanges(m_pendingHierarchyRanges[i], MAX_DIRTY_UPLOAD_RANGES);
+        }
+        m_processedDataVersion = sceneDatabase.m_dataVersion;
     }
 
-    m_diligent->pImmediateContext->EndQuery(m_diligent->pTransformEndQuery[m_currentFrame]);
-
     if (m_meshInfoDirty) {
         const size_t dataSize = s_meshInfos.size() * sizeof(MeshInfo);
-        m_diligent->pImmediateContext->UpdateBuffer(m_diligent->pMeshInfoBuffer, 0, dataSize, s_meshInfos.data(), Diligent::RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+        uploads.write(s_meshInfos.data(), dataSize, m_diligent->pMeshInfoBuffer);
+        if (!s_meshlets.empty())
+            uploads.write(s_meshlets.data(), s_meshlets.size() * sizeof(Meshlet), m_diligent->pMeshletBuffer);
         m_meshInfoDirty = false;
+        // Cached bounds were computed from the previous mesh infos.
+        m_fullTransformUpdateCounter = NUM_FRAMES_IN_FLIGHT;
     }
 
-    SceneUniforms sceneUniforms;
-    sceneUniforms.projection = camera.getProjectionMatrix();
-    sceneUniforms.view = camera.getViewMatrix();
-    sceneUniforms.lightPos = glm::vec3(0.0f, 10.0f, 0.0f);
-    sceneUniforms.viewPos = camera.getPosition();
-    sceneUniforms.lightColor = glm::vec3(1.0f, 1.0f, 1.0f);
-    extractFrustumPlanes(sceneUniforms.projection * sceneUniforms.view, sceneUniforms.frustumPlanes);
-
-    m_diligent->pImmediateContext->UpdateBuffer(m_diligent->pSceneUBO, uboFrameOffset, sizeof(SceneUniforms), &sceneUniforms, Diligent::RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
-
-    const unsigned int workgroupSize = 256;
-    const unsigned int numWorkgroups = (numObjects + workgroupSize - 1) / workgroupSize;
+    // Static entities keep the world matrices and bounds already in this frame's slot; only the
+    // subtrees under entities changed since the slot was last written are recomputed.
+    bool fullTransformUpdate = m_fullTransformUpdateCounter > 0;
+    if (fullTransformUpdate) {
+        m_fullTransformUpdateCounter--;
+    } else {
+        m_transformUpdateRanges.assign(m_pendingTransformRanges[m_currentFrame].begin(), m_pendingTransformRanges[m_currentFrame].end());
+        m_transformUpdateRanges.insert(m_transformUpdateRanges.end(), m_pendingRenderableRanges[m_currentFrame].begin(), m_pendingRenderableRanges[m_currentFrame].end());
+        fullTransformUpdate = !sceneDatabase.collectTransformUpdates(m_transformUpdateRanges, m_transformUpdateList, m_transformUpdateLevelOffsets);
+    }
+    const auto& transformUpdateList = fullTransformUpdate ? sceneDatabase.sortedHierarchyList : m_transformUpdateList;
+    const auto& transformLevelOffsets = fullTransformUpdate ? sceneDatabase.hierarchyLevelOffsets : m_transformUpdateLevelOffsets;
 
-    m_diligent->pImmediateContext->EndQuery(m_diligent->pCullStartQuery[m_currentFrame]);
+    if (m_transformBackend == TransformBackend::Gpu && !transformUpdateList.empty()) {
+        const size_t frameOffsetBytes = m_currentFrame * m_maxObjects * sizeof(Entity);
+        uploads.write(transformUpdateList.data(), transformUpdateList.size() * sizeof(Entity), m_diligent->pSortedHierarchyBuffer, frameOffsetBytes);
+    }
 
-    ResetAtomicCounter(m_diligent->pVisibleObjectAtomicCounter);
+    const auto& components = std::as_const(sceneDatabase.components);
+    UploadDirtyRanges(m_pendingTransformRanges[m_currentFrame], m_diligent->pLocalTransformBuffer, components.view<TransformComponent>());
+    UploadDirtyRanges(m_pendingRenderableRanges[m_currentFrame], m_diligent->pRenderableBuffer, components.view<RenderableComponent>());
+    UploadDirtyRanges(m_pendingHierarchyRanges[m_currentFrame], m_diligent->pHierarchyBuffer, components.view<HierarchyComponent>());
 
-    m_diligent->pImmediateContext->WaitForIdle();
+    const unsigned int transformWorkgroupSize = 256;
 
-    m_objectBuffer = (unsigned int)(size_t)m_diligent->pObjectBuffer->GetNativeHandle();
-    m_renderableBuffer = (unsigned int)(size_t)m_diligent->pRenderableBuffer->GetNativeHandle();
-    m_visibleObjectBuffer = (unsigned int)(size_t)m_diligent->pVisibleObjectBuffer->GetNativeHandle();
-    m_visibleObjectAtomicCounter = (unsigned int)(size_t)m_diligent->pVisibleObjectAtomicCounter->GetNativeHandle();
-    m_hierarchyBuffer = (unsigned int)(size_t)m_diligent->pHierarchyBuffer->GetNativeHandle();
-    m_sortedHierarchyBuffer = (unsigned int)(size_t)m_diligent->pSortedHierarchyBuffer->GetNativeHandle();
-    m_visibleTransparentObjectIdsBuffer = (unsigned int)(size_t)m_diligent->pVisibleTransparentObjectIdsBuffer->GetNativeHandle();
-    m_transparentAtomicCounter = (unsigned int)(size_t)m_diligent->pTransparentAtomicCounter->GetNativeHandle();
-    m_drawAtomicCounterBuffer = (unsigned int)(size_t)m_diligent->pDrawAtomicCounterBuffer->GetNativeHandle();
-    m_drawCommandBuffer = (unsigned int)(size_t)m_diligent->pDrawCommandBuffer->GetNativeHandle();
-    m_transparentDrawCommandBuffer = (unsigned int)(size_t)m_diligent->pTransparentDrawCommandBuffer->GetNativeHandle();
-    m_depthPrepassDrawCommandBuffer = (unsigned int)(size_t)m_diligent->pDepthPrepassDrawCommandBuffer->GetNativeHandle();
-    m_visibleLargeObjectBuffer = (unsigned int)(size_t)m_diligent->pVisibleLargeObjectBuffer->GetNativeHandle();
-    m_visibleLargeObjectAtomicCounter = (unsigned int)(size_t)m_diligent->pVisibleLargeObjectAtomicCounter->GetNativeHandle();
-    m_depthPrepassAtomicCounter = (unsigned int)(size_t)m_diligent->pDepthPrepassAtomicCounter->GetNativeHandle();
+    struct TransformUniforms {
+        unsigned int objectCount;
+        unsigned int levelOffset;
+        unsigned int baseIndex;
+        unsigned int padding;
+    };
+    static_assert(sizeof(TransformUniforms) % UploadRing::ALIGNMENT == 0, "per-level transform uniforms are staged back to back");
+
+    // The CPU backend walks the same update list as the transform pass. The m_cpu* arrays persist
+    // across frames, so only the listed entities are recomputed and only their ranges are copied
+    // into this frame's slot.
+    if (m_transformBackend == TransformBackend::Cpu && !transformUpdateList.empty()) {
+        if (!m_transformPropagator) {
+            m_transformPropagator = std::make_unique<TransformPropagator>();
+        }
+        start = std::chrono::high_resolution_clock::now();
+        m_transformPropagator->propagate(sceneDatabase, transformUpdateList, transformLevelOffsets, m_cpuWorldTransforms);
+        end = std::chrono::high_resolution_clock::now();
+        m_propagateTime = std::chrono::duration<double, std::milli>(end - start).count();
+
+        m_cpuWorldBounds.resize(m_cpuWorldTransforms.size());
+        m_cpuNormalMatrices.resize(m_cpuWorldTransforms.size());
+        m_cpuUploadRanges.clear();
+        for (const Entity entity : transformUpdateList) {
+            const unsigned int meshId = sceneDatabase.renderables[entity].mesh_uuid;
+            m_cpuWorldBounds[entity] = meshId < s_meshInfos.size() ? computeWorldBounds(m_cpuWorldTransforms[entity], s_meshInfos[meshId]) : glm::vec4(0.0f, 0.0f, 0.0f, -1.0f);
+            m_cpuNormalMatrices[entity] = computeNormalMatrix(m_cpuWorldTransforms[entity]);
+            if (!fullTransformUpdate) {
+                m_cpuUploadRanges.push_back(DirtyRange{entity, entity + 1});
+            }
+        }
+        if (fullTransformUpdate) {
+            m_cpuUploadRanges.push_back(DirtyRange{0, static_cast<Entity>(m_cpuWorldTransforms.size())});
+        } else {
+            coalesceDirtyRanges(m_cpuUploadRanges, MAX_DIRTY_UPLOAD_RANGES);
+        }
 
-    for (int i = 0; i < NUM_FRAMES_IN_FLIGHT; ++i) {
-        m_hizTexture[i] = (unsigned int)(size_t)m_diligent->pHiZTextures[i]->GetNativeHandle();
+        const size_t frameOffsetBytes = m_currentFrame * m_maxObjects * sizeof(WorldTransform);
+        const size_t boundsFrameOffsetBytes = m_currentFrame * m_maxObjects * sizeof(glm::vec4);
+        for (const DirtyRange& range : m_cpuUploadRanges) {
+            const size_t count = range.end - range.begin;
+            uploads.write(m_cpuWorldTransforms.data() + range.begin, count * sizeof(WorldTransform), m_diligent->pObjectBuffer, frameOffsetBytes + range.begin * sizeof(WorldTransform));
+            uploads.write(m_cpuNormalMatrices.data() + range.begin, count * sizeof(WorldTransform), m_diligent->pNormalMatrixBuffer, frameOffsetBytes + range.begin * sizeof(WorldTransform));
+            uploads.write(m_cpuWorldBounds.data() + range.begin, count * sizeof(glm::vec4), m_diligent->pBoundsBuffer, boundsFrameOffsetBytes + range.begin * sizeof(glm::vec4));
+        }
     }
 
-    m_diligent->pImmediateContext->InvalidateState();
+    // The transform pass is dispatched once per hierarchy level; the uniforms of every level are
+    // staged up front and copied into the uniform buffer in front of each dispatch.
+    Diligent::Uint64 transformUniformsOffset = 0;
+    if (m_transformBackend == TransformBackend::Gpu) {
+        for (size_t level = 0; level + 1 < transformLevelOffsets.size(); ++level) {
+            TransformUniforms transformUniforms;
+            transformUniforms.objectCount = transformLevelOffsets[level + 1] - transformLevelOffsets[level];
+            transformUniforms.levelOffset = transformLevelOffsets[level];
+            transformUniforms.baseIndex = m_currentFrame * m_maxObjects;
+            transformUniforms.padding = 0;
+            const Diligent::Uint64 offset = uploads.write(&transformUniforms, sizeof(transformUniforms));
+            if (level == 0) {
+                transformUniformsOffset = offset;
+            }
+        }
+    }
+
+    SceneUniforms sceneUniforms;
+    sceneUniforms.projection = camera.getProjectionMatrix();
+    sceneUniforms.view = camera.getViewMatrix();
+    sceneUniforms.lightPos = glm::vec3(0.0f, 10.0f, 0.0f);
+    sceneUniforms.viewPos = camera.getPosition();
+    sceneUniforms.lightColor = glm::vec3(1.0f, 1.0f, 1.0f);
+    extractFrustumPlanes(sceneUniforms.projection * sceneUniforms.view, sceneUniforms.frustumPlanes);
+    sceneUniforms.lightGridParams = glm::vec4(camera.getNearPlane(), std::log2(camera.getFarPlane() / camera.getNearPlane()), static_cast<float>(m_windowWidth),
+                                              static_cast<float>(m_windowHeight));
+    sceneUniforms.lightGridSize[0] = LIGHT_GRID_SIZE_X;
+    sceneUniforms.lightGridSize[1] = LIGHT_GRID_SIZE_Y;
+    sceneUniforms.lightGridSize[2] = LIGHT_GRID_SIZE_Z;
+    sceneUniforms.lightGridSize[3] = MAX_LIGHTS_PER_FROXEL;
+    sceneUniforms.lightCount = static_cast<uint32_t>(numLights);
+
+    uploads.write(&sceneUniforms, sizeof(SceneUniforms), m_diligent->pSceneUBO, uboFrameOffset);
+    uploads.write(sceneDatabase.lights.data(), numLights * sizeof(PointLight), m_diligent->pLightBuffer);
 
     CullingUniforms cullingUniforms;
 
@@ -1060,492 +1865,333 @@ void Renderer::drawScene(SceneDatabase& sceneDatabase, const Camera& camera) {
     cullingUniforms.maxDraws = static_cast<uint32_t>(m_maxObjects);
     cullingUniforms.baseIndex = m_currentFrame * m_maxObjects;
     cullingUniforms.smallObjectThreshold = m_smallObjectThreshold;
-    cullingUniforms.hizMaxMipLevel = static_cast<float>(m_maxMipLevel - 1);
+    cullingUniforms.hizMaxMipLevel = static_cast<float>(m_hizMipCount - 1);
     cullingUniforms.hizTextureSizeX = static_cast<float>(m_windowWidth);
     cullingUniforms.hizTextureSizeY = static_cast<float>(m_windowHeight);
-    cullingUniforms.padding = 0;
-
-    m_diligent->pImmediateContext->UpdateBuffer(m_diligent->pCullingUniforms, 0, sizeof(cullingUniforms), &cullingUniforms, Diligent::RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
-
-    auto* pHiZVar = m_diligent->pCullingSRB->GetVariableByName(Diligent::SHADER_TYPE_COMPUTE, "u_hizTexture");
-    if (pHiZVar) {
-        pHiZVar->Set(m_diligent->pHiZTextures[previousFrame]->GetDefaultView(Diligent::TEXTURE_VIEW_SHADER_RESOURCE));
-    }
-
-    m_diligent->pImmediateContext->SetPipelineState(m_diligent->pCullingPSO);
-    m_diligent->pImmediateContext->CommitShaderResources(m_diligent->pCullingSRB, Diligent::RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+    cullingUniforms.clusterCullThreshold = m_clusterCullThreshold;
+    cullingUniforms.maxClusterCandidates = MAX_CLUSTER_CANDIDATES;
+    cullingUniforms.maxClusterDraws = MAX_CLUSTER_DRAWS;
+    cullingUniforms.lodThresholds = glm::vec4(m_lodSelection.thresholds[0], m_lodSelection.thresholds[1], m_lodSelection.thresholds[2], 0.0f);
+    cullingUniforms.lodHysteresis = m_lodSelection.hysteresis;
+
+    // The two opaque phases differ only in the phase field; both versions are staged and copied in
+    // before the matching cull.
+    Diligent::Uint64 cullingUniformsOffsets[2];
+    for (uint32_t phase = 0; phase < 2; ++phase) {
+        cullingUniforms.phase = phase;
+        cullingUniformsOffsets[phase] = uploads.write(&cullingUniforms, sizeof(cullingUniforms));
+    }
+
+    // Shader and mesh ids get exactly the bits the current counts need, so narrow scenes keep short
+    // keys and few radix passes.
+    const uint32_t meshKeyBits = static_cast<uint32_t>(std::bit_width(std::max<size_t>(s_meshInfos.size(), 1) - 1));
+    const uint32_t shaderKeyBits = static_cast<uint32_t>(std::bit_width(std::max<size_t>(m_numDrawBins, 1) - 1));
+    const uint32_t lodKeyBits = static_cast<uint32_t>(std::bit_width(std::max<size_t>(m_maxLodCount, 1) - 1));
+    const SortKeyConstants opaqueKeyLayout = makeSortKeyConstants(shaderKeyBits, m_sortKeyBudget.materialBits, meshKeyBits, lodKeyBits, m_sortKeyBudget.depthBits, camera.getFarPlane());
+    const SortKeyConstants transparentKeyLayout = makeSortKeyConstants(0, 0, 0, 0, m_sortKeyBudget.transparentDepthBits, camera.getFarPlane());
+
+    // The layouts share one constant buffer and are copied in before each cull.
+    const Diligent::Uint64 opaqueKeyLayoutOffset = uploads.write(&opaqueKeyLayout, sizeof(opaqueKeyLayout));
+    const Diligent::Uint64 transparentKeyLayoutOffset = uploads.write(&transparentKeyLayout, sizeof(transparentKeyLayout));
+
+    DrawRunConstants opaqueDrawRunConstants = {};
+    opaqueDrawRunConstants.maxCount = static_cast<uint32_t>(m_maxObjects);
+    opaqueDrawRunConstants.runKeyShift = opaqueKeyLayout.depthBits;
+    const Diligent::Uint64 opaqueDrawRunConstantsOffset = uploads.write(&opaqueDrawRunConstants, sizeof(opaqueDrawRunConstants));
+
+    TransparentCullUniforms transparentCullUniforms = {};
+    transparentCullUniforms.objectCount = numObjects;
+    transparentCullUniforms.cameraPos = camera.getPosition();
+    uploads.write(&transparentCullUniforms, sizeof(transparentCullUniforms), m_diligent->pTransparentCullUniforms);
+
+    const Diligent::Uint64 opaqueDispatchArgsOffset = StageDispatchArgs(OPAQUE_SORT_ARGS, {RADIX_SORT_TILE_SIZE, COMMAND_GEN_WORKGROUP_SIZE});
+    const Diligent::Uint64 transparentDispatchArgsOffset = StageDispatchArgs(TRANSPARENT_SORT_ARGS, {RADIX_SORT_TILE_SIZE, TRANSPARENT_COMMAND_GEN_WORKGROUP_SIZE});
+    // One cluster_cull.comp workgroup per candidate.
+    const Diligent::Uint64 clusterDispatchArgsOffset = StageDispatchArgs(CLUSTER_CULL_ARGS, {1}, MAX_CLUSTER_CANDIDATES);
+
+    uploads.end();
 
-    Diligent::DispatchComputeAttribs CullDispatchAttrs;
-    CullDispatchAttrs.ThreadGroupCountX = numWorkgroups;
-    CullDispatchAttrs.ThreadGroupCountY = 1;
-    CullDispatchAttrs.ThreadGroupCountZ = 1;
-    m_diligent->pImmediateContext->DispatchCompute(CullDispatchAttrs);
-
-    m_diligent->pImmediateContext->WaitForIdle();
-
-    unsigned int visibleObjectCount = ReadAtomicCounter(m_diligent->pVisibleObjectAtomicCounter);
+    m_diligent->pImmediateContext->InvalidateState();
 
-    m_diligent->pImmediateContext->EndQuery(m_diligent->pCullEndQuery[m_currentFrame]);
+    if (m_transformBackend == TransformBackend::Gpu) {
+        for (size_t level = 0; level + 1 < transformLevelOffsets.size(); ++level) {
+            const unsigned int levelCount = transformLevelOffsets[level + 1] - transformLevelOffsets[level];
+            if (levelCount == 0) {
+                continue;
+            }
 
-    if (visibleObjectCount > 1) {
-        if (false)
-            ;
-        m_diligent->pImmediateContext->EndQuery(m_diligent->pOpaqueSortStartQuery[m_currentFrame]);
+            uploads.copy(transformUniformsOffset + level * sizeof(TransformUniforms), m_diligent->pTransformUniforms, 0, sizeof(TransformUniforms));
 
-        {
-            auto* pVisibleBufVar = m_diligent->pOpaqueSortSRB->GetVariableByName(Diligent::SHADER_TYPE_COMPUTE, "VisibleObjectBuffer");
-            if (pVisibleBufVar)
-                pVisibleBufVar->Set(m_diligent->pVisibleObjectBuffer->GetDefaultView(Diligent::BUFFER_VIEW_UNORDERED_ACCESS));
+            m_diligent->pImmediateContext->SetPipelineState(m_diligent->pTransformPSO);
+            m_diligent->pImmediateContext->CommitShaderResources(m_diligent->pTransformSRB, Diligent::RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
 
-            auto* pRenderableBufVar = m_diligent->pOpaqueSortSRB->GetVariableByName(Diligent::SHADER_TYPE_COMPUTE, "RenderableBuffer");
-            if (pRenderableBufVar)
-                pRenderableBufVar->Set(m_diligent->pRenderableBuffer->GetDefaultView(Diligent::BUFFER_VIEW_SHADER_RESOURCE));
+            Diligent::DispatchComputeAttribs DispatchAttrs;
+            DispatchAttrs.ThreadGroupCountX = (levelCount + transformWorkgroupSize - 1) / transformWorkgroupSize;
+            DispatchAttrs.ThreadGroupCountY = 1;
+            DispatchAttrs.ThreadGroupCountZ = 1;
+            m_diligent->pImmediateContext->DispatchCompute(DispatchAttrs);
         }
+    }
 
-        m_diligent->pImmediateContext->SetPipelineState(m_diligent->pOpaqueSortPSO);
-
-        const unsigned int numElements = nextPowerOfTwo(visibleObjectCount);
-
-        for (unsigned int k = 2; k <= numElements; k <<= 1) {
-            for (unsigned int j = k >> 1; j > 0; j >>= 1) {
-
-                {
-                    Diligent::MapHelper<SortConstants> Constants(m_diligent->pImmediateContext, m_diligent->pOpaqueSortConstants, Diligent::MAP_WRITE, Diligent::MAP_FLAG_DISCARD);
-                    Constants->k = k;
-                    Constants->j = j;
-                }
+    m_diligent->pImmediateContext->EndQuery(m_diligent->pTransformEndQuery[m_currentFrame]);
 
-                m_diligent->pImmediateContext->CommitShaderResources(m_diligent->pOpaqueSortSRB, Diligent::RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+    // Validation copies this slot's GPU results out and computes the CPU reference for the same
+    // scene state now; the comparison waits until the slot's fence comes around again.
+    if (m_transformValidation && m_transformBackend == TransformBackend::Gpu && m_transformReadbackFrame < 0) {
+        const size_t count = numObjects;
+        const size_t matricesSize = count * sizeof(WorldTransform);
+        const size_t requiredSize = 2 * matricesSize + count * sizeof(glm::vec4);
+        if (!m_diligent->pTransformReadbackBuffer || m_diligent->pTransformReadbackBuffer->GetDesc().Size < requiredSize) {
+            m_diligent->pTransformReadbackBuffer.Release();
+            Diligent::BufferDesc Desc;
+            Desc.Name = "Transform Readback Buffer";
+            Desc.Usage = Diligent::USAGE_STAGING;
+            Desc.CPUAccessFlags = Diligent::CPU_ACCESS_READ;
+            Desc.Size = requiredSize;
+            m_diligent->pDevice->CreateBuffer(Desc, nullptr, &m_diligent->pTransformReadbackBuffer);
+        }
 
-                const unsigned int numSortWorkgroups = (numElements + 1023) / 1024;
-                Diligent::DispatchComputeAttribs SortDispatchAttrs;
-                SortDispatchAttrs.ThreadGroupCountX = numSortWorkgroups;
-                m_diligent->pImmediateContext->DispatchCompute(SortDispatchAttrs);
+        if (m_diligent->pTransformReadbackBuffer) {
+            m_diligent->pImmediateContext->CopyBuffer(m_diligent->pObjectBuffer, frameOffset * sizeof(WorldTransform), Diligent::RESOURCE_STATE_TRANSITION_MODE_TRANSITION, m_diligent->pTransformReadbackBuffer, 0,
+                                                      matricesSize, Diligent::RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+            m_diligent->pImmediateContext->CopyBuffer(m_diligent->pNormalMatrixBuffer, frameOffset * sizeof(WorldTransform), Diligent::RESOURCE_STATE_TRANSITION_MODE_TRANSITION, m_diligent->pTransformReadbackBuffer,
+                                                      matricesSize, matricesSize, Diligent::RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+            m_diligent->pImmediateContext->CopyBuffer(m_diligent->pBoundsBuffer, frameOffset * sizeof(glm::vec4), Diligent::RESOURCE_STATE_TRANSITION_MODE_TRANSITION, m_diligent->pTransformReadbackBuffer,
+                                                      2 * matricesSize, count * sizeof(glm::vec4), Diligent::RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
 
-                Diligent::StateTransitionDesc Barrier;
-                Barrier.pResource = m_diligent->pVisibleObjectBuffer;
-                Barrier.OldState = Diligent::RESOURCE_STATE_UNORDERED_ACCESS;
-                Barrier.NewState = Diligent::RESOURCE_STATE_UNORDERED_ACCESS;
-                Barrier.TransitionType = Diligent::STATE_TRANSITION_TYPE_IMMEDIATE;
-                Barrier.Flags = Diligent::STATE_TRANSITION_FLAG_UPDATE_STATE;
-                m_diligent->pImmediateContext->TransitionResourceStates(1, &Barrier);
+            if (!m_transformPropagator) {
+                m_transformPropagator = std::make_unique<TransformPropagator>();
+            }
+            start = std::chrono::high_resolution_clock::now();
+            m_transformPropagator->propagate(sceneDatabase, m_validationWorldTransforms);
+            end = std::chrono::high_resolution_clock::now();
+            m_propagateTime = std::chrono::duration<double, std::milli>(end - start).count();
+
+            m_validationEntities.assign(sceneDatabase.sortedHierarchyList.begin(), sceneDatabase.sortedHierarchyList.end());
+            m_validationNormalMatrices.resize(count);
+            m_validationWorldBounds.resize(count);
+            for (const Entity entity : m_validationEntities) {
+                const unsigned int meshId = sceneDatabase.renderables[entity].mesh_uuid;
+                m_validationWorldBounds[entity] = meshId < s_meshInfos.size() ? computeWorldBounds(m_validationWorldTransforms[entity], s_meshInfos[meshId]) : glm::vec4(0.0f, 0.0f, 0.0f, -1.0f);
+                m_validationNormalMatrices[entity] = computeNormalMatrix(m_validationWorldTransforms[entity]);
             }
+            m_transformReadbackCount = count;
+            m_transformReadbackFrame = static_cast<int>(m_currentFrame);
         }
-
-        if (false)
-            ;
-        m_diligent->pImmediateContext->EndQuery(m_diligent->pOpaqueSortEndQuery[m_currentFrame]);
-        m_diligent->OpaqueSortActive[m_currentFrame] = true;
-    } else {
-        m_diligent->OpaqueSortActive[m_currentFrame] = false;
     }
 
-    m_diligent->pImmediateContext->EndQuery(m_diligent->pCommandGenStartQuery[m_currentFrame]);
-
-    std::vector<unsigned int> drawZeros(m_numDrawingShaders, 0);
-    m_diligent->pImmediateContext->UpdateBuffer(m_diligent->pDrawAtomicCounterBuffer, 0, sizeof(unsigned int) * m_numDrawingShaders, drawZeros.data(), Diligent::RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+    FrameBindings& frame = m_diligent->frameBindings[m_currentFrame];
 
-    if (visibleObjectCount > 0) {
-        m_diligent->pImmediateContext->SetPipelineState(m_diligent->pCommandGenPSO);
+    // The light grid depends only on the camera and the light list, so it is built once per frame
+    // ahead of the opaque phases and shared by every draw.
+    if (m_diligent->pLightBinPSO && frame.pLightBinSRB) {
+        m_diligent->pImmediateContext->SetPipelineState(m_diligent->pLightBinPSO);
+        m_diligent->pImmediateContext->CommitShaderResources(frame.pLightBinSRB, Diligent::RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
 
-        {
-            Diligent::MapHelper<CommandGenUniforms> ConstData(m_diligent->pImmediateContext, m_diligent->pCommandGenConstants, Diligent::MAP_WRITE, Diligent::MAP_FLAG_DISCARD);
-            ConstData->visibleObjectCount = visibleObjectCount;
-            ConstData->maxDraws = (uint32_t)m_maxObjects;
-        }
-
-        Diligent::BufferViewDesc DrawCmdViewDesc;
-        DrawCmdViewDesc.ViewType = Diligent::BUFFER_VIEW_UNORDERED_ACCESS;
-        DrawCmdViewDesc.ByteOffset = frameOffset * sizeof(DrawElementsIndirectCommand) * m_numDrawingShaders;
-        DrawCmdViewDesc.ByteWidth = m_maxObjects * sizeof(DrawElementsIndirectCommand) * m_numDrawingShaders;
-        Diligent::RefCntAutoPtr<Diligent::IBufferView> pDrawCmdView;
-        m_diligent->pDrawCommandBuffer->CreateView(DrawCmdViewDesc, &pDrawCmdView);
-
-        if (auto* var = m_diligent->pCommandGenSRB->GetVariableByName(Diligent::SHADER_TYPE_COMPUTE, "DrawCommandBuffer"))
-            var->Set(pDrawCmdView, Diligent::SET_SHADER_RESOURCE_FLAG_ALLOW_OVERWRITE);
-
-        Diligent::BufferViewDesc VisibleObjViewDesc;
-        VisibleObjViewDesc.ViewType = Diligent::BUFFER_VIEW_SHADER_RESOURCE;
-        VisibleObjViewDesc.ByteOffset = frameOffset * sizeof(unsigned int);
-        VisibleObjViewDesc.ByteWidth = m_maxObjects * sizeof(unsigned int);
-        Diligent::RefCntAutoPtr<Diligent::IBufferView> pVisibleObjView;
-        m_diligent->pVisibleObjectBuffer->CreateView(VisibleObjViewDesc, &pVisibleObjView);
-
-        if (auto* var = m_diligent->pCommandGenSRB->GetVariableByName(Diligent::SHADER_TYPE_COMPUTE, "VisibleObjectBuffer"))
-            var->Set(pVisibleObjView, Diligent::SET_SHADER_RESOURCE_FLAG_ALLOW_OVERWRITE);
-
-        Diligent::BufferViewDesc RenderableViewDesc;
-        RenderableViewDesc.ViewType = Diligent::BUFFER_VIEW_SHADER_RESOURCE;
-        RenderableViewDesc.ByteOffset = frameOffset * sizeof(RenderableComponent);
-        RenderableViewDesc.ByteWidth = m_maxObjects * sizeof(RenderableComponent);
-        Diligent::RefCntAutoPtr<Diligent::IBufferView> pRenderableView;
-        m_diligent->pRenderableBuffer->CreateView(RenderableViewDesc, &pRenderableView);
-
-        if (auto* var = m_diligent->pCommandGenSRB->GetVariableByName(Diligent::SHADER_TYPE_COMPUTE, "RenderableBuffer"))
-            var->Set(pRenderableView, Diligent::SET_SHADER_RESOURCE_FLAG_ALLOW_OVERWRITE);
-
-        m_diligent->pImmediateContext->CommitShaderResources(m_diligent->pCommandGenSRB, Diligent::RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
-
-        m_diligent->pImmediateContext->DispatchCompute(Diligent::DispatchComputeAttribs(1, 1, 1));
-
-        Diligent::StateTransitionDesc Barrier;
-        Barrier.pResource = m_diligent->pDrawCommandBuffer;
-        Barrier.OldState = Diligent::RESOURCE_STATE_UNORDERED_ACCESS;
-        Barrier.NewState = Diligent::RESOURCE_STATE_INDIRECT_ARGUMENT;
-        Barrier.TransitionType = Diligent::STATE_TRANSITION_TYPE_IMMEDIATE;
-        Barrier.Flags = Diligent::STATE_TRANSITION_FLAG_UPDATE_STATE;
-        m_diligent->pImmediateContext->TransitionResourceStates(1, &Barrier);
+        Diligent::DispatchComputeAttribs DispatchAttrs;
+        DispatchAttrs.ThreadGroupCountX = (LIGHT_GRID_FROXEL_COUNT + LIGHT_BIN_WORKGROUP_SIZE - 1) / LIGHT_BIN_WORKGROUP_SIZE;
+        DispatchAttrs.ThreadGroupCountY = 1;
+        DispatchAttrs.ThreadGroupCountZ = 1;
+        m_diligent->pImmediateContext->DispatchCompute(DispatchAttrs);
     }
 
-    m_diligent->pImmediateContext->EndQuery(m_diligent->pCommandGenEndQuery[m_currentFrame]);
-
-    m_diligent->pImmediateContext->EndQuery(m_diligent->pLargeObjectCullStartQuery[m_currentFrame]);
-
-    ResetAtomicCounter(m_diligent->pVisibleLargeObjectAtomicCounter);
-
-    m_diligent->pImmediateContext->SetPipelineState(m_diligent->pLargeObjectCullPSO);
+    const unsigned int workgroupSize = 256;
+    const unsigned int numWorkgroups = (numObjects + workgroupSize - 1) / workgroupSize;
 
-    {
-        Diligent::MapHelper<LargeObjectCullUniforms> Constants(m_diligent->pImmediateContext, m_diligent->pLargeObjectCullConstants, Diligent::MAP_WRITE, Diligent::MAP_FLAG_DISCARD);
-        Constants->objectCount = numObjects;
-        Constants->maxDraws = (uint32_t)m_maxObjects;
-        Constants->largeObjectThreshold = m_largeObjectThreshold;
-    }
-
-    Diligent::BufferViewDesc ObjViewDesc;
-    ObjViewDesc.ViewType = Diligent::BUFFER_VIEW_SHADER_RESOURCE;
-    ObjViewDesc.ByteOffset = frameOffset * sizeof(TransformComponent);
-    ObjViewDesc.ByteWidth = m_maxObjects * sizeof(TransformComponent);
-    Diligent::RefCntAutoPtr<Diligent::IBufferView> pObjView;
-    m_diligent->pObjectBuffer->CreateView(ObjViewDesc, &pObjView);
-    if (auto* var = m_diligent->pLargeObjectCullSRB->GetVariableByName(Diligent::SHADER_TYPE_COMPUTE, "ObjectBuffer"))
-        var->Set(pObjView, Diligent::SET_SHADER_RESOURCE_FLAG_ALLOW_OVERWRITE);
-
-    Diligent::BufferViewDesc RenderableViewDesc;
-    RenderableViewDesc.ViewType = Diligent::BUFFER_VIEW_SHADER_RESOURCE;
-    RenderableViewDesc.ByteOffset = frameOffset * sizeof(RenderableComponent);
-    RenderableViewDesc.ByteWidth = m_maxObjects * sizeof(RenderableComponent);
-    Diligent::RefCntAutoPtr<Diligent::IBufferView> pRenderableView;
-    m_diligent->pRenderableBuffer->CreateView(RenderableViewDesc, &pRenderableView);
-    if (auto* var = m_diligent->pLargeObjectCullSRB->GetVariableByName(Diligent::SHADER_TYPE_COMPUTE, "RenderableBuffer"))
-        var->Set(pRenderableView, Diligent::SET_SHADER_RESOURCE_FLAG_ALLOW_OVERWRITE);
-
-    Diligent::BufferViewDesc VisLargeObjViewDesc;
-    VisLargeObjViewDesc.ViewType = Diligent::BUFFER_VIEW_UNORDERED_ACCESS;
-    VisLargeObjViewDesc.ByteOffset = frameOffset * sizeof(unsigned int);
-    VisLargeObjViewDesc.ByteWidth = m_maxObjects * sizeof(unsigned int);
-    Diligent::RefCntAutoPtr<Diligent::IBufferView> pVisLargeObjView;
-    m_diligent->pVisibleLargeObjectBuffer->CreateView(VisLargeObjViewDesc, &pVisLargeObjView);
-    if (auto* var = m_diligent->pLargeObjectCullSRB->GetVariableByName(Diligent::SHADER_TYPE_COMPUTE, "VisibleLargeObjectBuffer"))
-        var->Set(pVisLargeObjView, Diligent::SET_SHADER_RESOURCE_FLAG_ALLOW_OVERWRITE);
-
-    m_diligent->pImmediateContext->CommitShaderResources(m_diligent->pLargeObjectCullSRB, Diligent::RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
-    m_diligent->pImmediateContext->DispatchCompute(Diligent::DispatchComputeAttribs(numWorkgroups, 1, 1));
+    m_objectBuffer = (unsigned int)(size_t)m_diligent->pObjectBuffer->GetNativeHandle();
+    m_renderableBuffer = (unsigned int)(size_t)m_diligent->pRenderableBuffer->GetNativeHandle();
+    m_visibleObjectBuffer = (unsigned int)(size_t)m_diligent->pVisibleObjectBuffer->GetNativeHandle();
+    m_visibleObjectAtomicCounter = (unsigned int)(size_t)m_diligent->pVisibleObjectAtomicCounter->GetNativeHandle();
+    m_hierarchyBuffer = (unsigned int)(size_t)m_diligent->pHierarchyBuffer->GetNativeHandle();
+    m_sortedHierarchyBuffer = (unsigned int)(size_t)m_diligent->pSortedHierarchyBuffer->GetNativeHandle();
+    m_visibleTransparentObjectIdsBuffer = (unsigned int)(size_t)m_diligent->pVisibleTransparentObjectIdsBuffer->GetNativeHandle();
+    m_transparentAtomicCounter = (unsigned int)(size_t)m_diligent->pTransparentAtomicCounter->GetNativeHandle();
+    m_drawAtomicCounterBuffer = (unsigned int)(size_t)m_diligent->pDrawAtomicCounterBuffer->GetNativeHandle();
+    m_drawCommandBuffer = (unsigned int)(size_t)m_diligent->pDrawCommandBuffer->GetNativeHandle();
+    m_transparentDrawCommandBuffer = (unsigned int)(size_t)m_diligent->pTransparentDrawCommandBuffer->GetNativeHandle();
 
-    Diligent::StateTransitionDesc Barrier;
-    Barrier.pResource = m_diligent->pVisibleLargeObjectAtomicCounter;
-    Barrier.OldState = Diligent::RESOURCE_STATE_UNORDERED_ACCESS;
-    Barrier.NewState = Diligent::RESOURCE_STATE_COPY_SOURCE;
-    Barrier.TransitionType = Diligent::STATE_TRANSITION_TYPE_IMMEDIATE;
-    Barrier.Flags = Diligent::STATE_TRANSITION_FLAG_UPDATE_STATE;
-    m_diligent->pImmediateContext->TransitionResourceStates(1, &Barrier);
+    for (int i = 0; i < NUM_FRAMES_IN_FLIGHT; ++i) {
+        m_hizTexture[i] = (unsigned int)(size_t)m_diligent->pHiZTextures[i]->GetNativeHandle();
+    }
 
-    unsigned int visibleLargeObjectCount = ReadAtomicCounter(m_diligent->pVisibleLargeObjectAtomicCounter);
+    m_diligent->pImmediateContext->InvalidateState();
 
-    m_diligent->pImmediateContext->EndQuery(m_diligent->pLargeObjectCullEndQuery[m_currentFrame]);
+    Diligent::Viewport VP;
+    VP.Width = (float)m_windowWidth;
+    VP.Height = (float)m_windowHeight;
+    VP.MinDepth = 0.0f;
+    VP.MaxDepth = 1.0f;
+    VP.TopLeftX = 0;
+    VP.TopLeftY = 0;
+    m_diligent->pImmediateContext->SetViewports(1, &VP, m_windowWidth, m_windowHeight);
 
-    if (visibleLargeObjectCount > 1) {
-        if (false)
-            ;
-        m_diligent->pImmediateContext->EndQuery(m_diligent->pLargeObjectSortStartQuery[m_currentFrame]);
+    // Opaque and transparent geometry is drawn into the scene color and this frame's depth buffer,
+    // which feeds the Hi-Z between the opaque phases; the result is copied to the back buffer.
+    Diligent::ITextureView* pSceneRTV = m_diligent->pSceneColorTexture->GetDefaultView(Diligent::TEXTURE_VIEW_RENDER_TARGET);
+    Diligent::ITextureView* pSceneDSV = m_diligent->pDepthRenderbuffers[m_currentFrame]->GetDefaultView(Diligent::TEXTURE_VIEW_DEPTH_STENCIL);
+
+    struct OpaquePhaseQueries {
+        Diligent::IQuery* pCullStart;
+        Diligent::IQuery* pCullEnd;
+        Diligent::IQuery* pSortStart;
+        Diligent::IQuery* pSortEnd;
+        Diligent::IQuery* pCommandGenStart;
+        Diligent::IQuery* pCommandGenEnd;
+        Diligent::IQuery* pDrawStart;
+        Diligent::IQuery* pDrawEnd;
+    };
 
-        m_diligent->pImmediateContext->SetPipelineState(m_diligent->pLargeObjectSortPSO);
+    // Both opaque phases run the same cull, sort, command gen and draw over the opaque buffers;
+    // cull.comp decides from the phase which objects it emits.
+    auto RecordOpaquePhase = [&](uint32_t phase, const OpaquePhaseQueries& queries) {
+        m_diligent->pImmediateContext->EndQuery(queries.pCullStart);
 
-        Diligent::BufferViewDesc VisObjViewDesc;
-        VisObjViewDesc.ViewType = Diligent::BUFFER_VIEW_UNORDERED_ACCESS;
-        VisObjViewDesc.ByteOffset = frameOffset * sizeof(unsigned int);
-        VisObjViewDesc.ByteWidth = m_maxObjects * sizeof(unsigned int);
-        Diligent::RefCntAutoPtr<Diligent::IBufferView> pVisObjView;
-        m_diligent->pVisibleLargeObjectBuffer->CreateView(VisObjViewDesc, &pVisObjView);
+        ResetAtomicCounter(m_diligent->pVisibleObjectAtomicCounter);
+        ResetAtomicCounter(m_diligent->pClusterCandidateCounter);
+        uploads.copy(opaqueKeyLayoutOffset, m_diligent->pSortKeyConstants, 0, sizeof(SortKeyConstants));
+        uploads.copy(cullingUniformsOffsets[phase], m_diligent->pCullingUniforms, 0, sizeof(CullingUniforms));
 
-        if (auto* var = m_diligent->pLargeObjectSortSRB->GetVariableByName(Diligent::SHADER_TYPE_COMPUTE, "VisibleLargeObjectBuffer"))
-            var->Set(pVisObjView, Diligent::SET_SHADER_RESOURCE_FLAG_ALLOW_OVERWRITE);
+        m_diligent->pImmediateContext->SetPipelineState(m_diligent->pCullingPSO);
+        m_diligent->pImmediateContext->CommitShaderResources(frame.pCullingSRB, Diligent::RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
 
-        Diligent::BufferViewDesc RenderableViewDesc;
-        RenderableViewDesc.ViewType = Diligent::BUFFER_VIEW_SHADER_RESOURCE;
-        RenderableViewDesc.ByteOffset = frameOffset * sizeof(RenderableComponent);
-        RenderableViewDesc.ByteWidth = m_maxObjects * sizeof(RenderableComponent);
-        Diligent::RefCntAutoPtr<Diligent::IBufferView> pRenderableView;
-        m_diligent->pRenderableBuffer->CreateView(RenderableViewDesc, &pRenderableView);
+        Diligent::DispatchComputeAttribs CullDispatchAttrs;
+        CullDispatchAttrs.ThreadGroupCountX = numWorkgroups;
+        CullDispatchAttrs.ThreadGroupCountY = 1;
+        CullDispatchAttrs.ThreadGroupCountZ = 1;
+        m_diligent->pImmediateContext->DispatchCompute(CullDispatchAttrs);
 
-        if (auto* var = m_diligent->pLargeObjectSortSRB->GetVariableByName(Diligent::SHADER_TYPE_COMPUTE, "RenderableBuffer"))
-            var->Set(pRenderableView, Diligent::SET_SHADER_RESOURCE_FLAG_ALLOW_OVERWRITE);
+        WriteDispatchArgs(m_diligent->pVisibleObjectAtomicCounter, opaqueDispatchArgsOffset);
+        WriteDispatchArgs(m_diligent->pClusterCandidateCounter, clusterDispatchArgsOffset);
 
-        const unsigned int numElements = nextPowerOfTwo(visibleLargeObjectCount);
+        m_diligent->pImmediateContext->EndQuery(queries.pCullEnd);
 
-        for (unsigned int k = 2; k <= numElements; k <<= 1) {
-            for (unsigned int j = k >> 1; j > 0; j >>= 1) {
+        m_diligent->pImmediateContext->EndQuery(queries.pSortStart);
+        const int opaqueSortedKeys = RecordRadixSort(m_diligent->pOpaqueSortPSO, frame.pOpaqueSortSRB, frame.pOpaqueSortValueVar, m_diligent->pOpaqueSortConstants,
+                                                     m_diligent->pVisibleObjectAtomicCounter, OPAQUE_SORT_ARGS, OPAQUE_COMMAND_GEN_ARGS, sortKeyBits(opaqueKeyLayout));
+        m_diligent->pImmediateContext->EndQuery(queries.pSortEnd);
 
-                {
-                    Diligent::MapHelper<SortConstants> Constants(m_diligent->pImmediateContext, m_diligent->pLargeObjectSortConstants, Diligent::MAP_WRITE, Diligent::MAP_FLAG_DISCARD);
-                    Constants->k = k;
-                    Constants->j = j;
-                }
+        m_diligent->pImmediateContext->EndQuery(queries.pCommandGenStart);
 
-                m_diligent->pImmediateContext->CommitShaderResources(m_diligent->pLargeObjectSortSRB, Diligent::RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+        uploads.copy(counterZerosOffset, m_diligent->pDrawAtomicCounterBuffer, 0, sizeof(unsigned int) * m_numDrawBins);
 
-                const unsigned int numSortWorkgroups = (numElements + 1023) / 1024;
-                m_diligent->pImmediateContext->DispatchCompute(Diligent::DispatchComputeAttribs(numSortWorkgroups, 1, 1));
+        {
+            RecordDrawRuns(m_diligent->pSortKeyBuffers[opaqueSortedKeys], m_diligent->pVisibleObjectAtomicCounter, OPAQUE_COMMAND_GEN_ARGS, opaqueDrawRunConstantsOffset);
+            uploads.copy(commandGenUniformsOffset, m_diligent->pCommandGenConstants, 0, sizeof(CommandGenUniforms));
+
+            m_diligent->pImmediateContext->SetPipelineState(m_diligent->pCommandGenPSO);
+            m_diligent->pImmediateContext->CommitShaderResources(frame.pCommandGenSRB, Diligent::RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+            DispatchIndirect(OPAQUE_COMMAND_GEN_ARGS);
+
+            // The candidates' meshlets are culled into the per-shader meshlet draw bins.
+            uploads.copy(counterZerosOffset, m_diligent->pClusterDrawCounterBuffer, 0, sizeof(unsigned int) * m_numDrawBins);
+            if (m_diligent->pClusterCullPSO) {
+                m_diligent->pImmediateContext->SetPipelineState(m_diligent->pClusterCullPSO);
+                m_diligent->pImmediateContext->CommitShaderResources(frame.pClusterCullSRB, Diligent::RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+                DispatchIndirect(CLUSTER_CULL_ARGS);
+            }
 
-                Diligent::StateTransitionDesc Barrier;
-                Barrier.pResource = m_diligent->pVisibleLargeObjectBuffer;
+            Diligent::StateTransitionDesc Barriers[2];
+            Barriers[0].pResource = m_diligent->pDrawCommandBuffer;
+            Barriers[1].pResource = m_diligent->pClusterDrawCommandBuffer;
+            for (auto& Barrier : Barriers) {
                 Barrier.OldState = Diligent::RESOURCE_STATE_UNORDERED_ACCESS;
-                Barrier.NewState = Diligent::RESOURCE_STATE_UNORDERED_ACCESS;
+                Barrier.NewState = Diligent::RESOURCE_STATE_INDIRECT_ARGUMENT;
                 Barrier.TransitionType = Diligent::STATE_TRANSITION_TYPE_IMMEDIATE;
                 Barrier.Flags = Diligent::STATE_TRANSITION_FLAG_UPDATE_STATE;
-                m_diligent->pImmediateContext->TransitionResourceStates(1, &Barrier);
             }
+            m_diligent->pImmediateContext->TransitionResourceStates(2, Barriers);
         }
 
-        if (false)
-            ;
-        m_diligent->pImmediateContext->EndQuery(m_diligent->pLargeObjectSortEndQuery[m_currentFrame]);
-        m_diligent->LargeObjectSortActive[m_currentFrame] = true;
-    } else {
-        m_diligent->LargeObjectSortActive[m_currentFrame] = false;
-    }
-
-    m_diligent->pImmediateContext->EndQuery(m_diligent->pLargeObjectCommandGenStartQuery[m_currentFrame]);
-    ResetAtomicCounter(m_diligent->pDepthPrepassAtomicCounter);
-
-    m_diligent->pImmediateContext->SetPipelineState(m_diligent->pLargeObjectCommandGenPSO);
-
-    {
-        LargeObjectCommandGenUniforms uniforms;
-        uniforms.visibleLargeObjectCount = visibleLargeObjectCount;
-        uniforms.maxDraws = (unsigned int)m_maxObjects;
-        m_diligent->pImmediateContext->UpdateBuffer(m_diligent->pLargeObjectCommandGenUniforms, 0, sizeof(LargeObjectCommandGenUniforms), &uniforms, Diligent::RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
-    }
-
-    if (auto* var = m_diligent->pLargeObjectCommandGenSRB->GetVariableByName(Diligent::SHADER_TYPE_COMPUTE, "LargeObjectCommandGenUniforms"))
-        var->Set(m_diligent->pLargeObjectCommandGenUniforms, Diligent::SET_SHADER_RESOURCE_FLAG_ALLOW_OVERWRITE);
-
-    if (auto* var = m_diligent->pLargeObjectCommandGenSRB->GetVariableByName(Diligent::SHADER_TYPE_COMPUTE, "AtomicCounterBuffer"))
-        var->Set(m_diligent->pDepthPrepassAtomicCounter->GetDefaultView(Diligent::BUFFER_VIEW_UNORDERED_ACCESS), Diligent::SET_SHADER_RESOURCE_FLAG_ALLOW_OVERWRITE);
-
-    Diligent::BufferViewDesc DrawCmdViewDesc;
-    DrawCmdViewDesc.ViewType = Diligent::BUFFER_VIEW_UNORDERED_ACCESS;
-    DrawCmdViewDesc.ByteOffset = frameOffset * sizeof(DrawElementsIndirectCommand);
-    DrawCmdViewDesc.ByteWidth = m_maxObjects * sizeof(DrawElementsIndirectCommand);
-    Diligent::RefCntAutoPtr<Diligent::IBufferView> pDrawCmdView;
-    m_diligent->pDepthPrepassDrawCommandBuffer->CreateView(DrawCmdViewDesc, &pDrawCmdView);
-    if (auto* var = m_diligent->pLargeObjectCommandGenSRB->GetVariableByName(Diligent::SHADER_TYPE_COMPUTE, "DrawCommandBuffer"))
-        var->Set(pDrawCmdView, Diligent::SET_SHADER_RESOURCE_FLAG_ALLOW_OVERWRITE);
-
-    if (auto* var = m_diligent->pLargeObjectCommandGenSRB->GetVariableByName(Diligent::SHADER_TYPE_COMPUTE, "MeshInfoBuffer"))
-        var->Set(m_diligent->pMeshInfoBuffer->GetDefaultView(Diligent::BUFFER_VIEW_SHADER_RESOURCE), Diligent::SET_SHADER_RESOURCE_FLAG_ALLOW_OVERWRITE);
-
-    RenderableViewDesc.ViewType = Diligent::BUFFER_VIEW_SHADER_RESOURCE;
-    RenderableViewDesc.ByteOffset = frameOffset * sizeof(RenderableComponent);
-    RenderableViewDesc.ByteWidth = m_maxObjects * sizeof(RenderableComponent);
-    pRenderableView.Release();
-    m_diligent->pRenderableBuffer->CreateView(RenderableViewDesc, &pRenderableView);
-    if (auto* var = m_diligent->pLargeObjectCommandGenSRB->GetVariableByName(Diligent::SHADER_TYPE_COMPUTE, "RenderableBuffer"))
-        var->Set(pRenderableView, Diligent::SET_SHADER_RESOURCE_FLAG_ALLOW_OVERWRITE);
-
-    VisLargeObjViewDesc.ViewType = Diligent::BUFFER_VIEW_SHADER_RESOURCE;
-    VisLargeObjViewDesc.ByteOffset = frameOffset * sizeof(unsigned int);
-    VisLargeObjViewDesc.ByteWidth = m_maxObjects * sizeof(unsigned int);
-    pVisLargeObjView.Release();
-    m_diligent->pVisibleLargeObjectBuffer->CreateView(VisLargeObjViewDesc, &pVisLargeObjView);
-    if (auto* var = m_diligent->pLargeObjectCommandGenSRB->GetVariableByName(Diligent::SHADER_TYPE_COMPUTE, "VisibleLargeObjectBuffer"))
-        var->Set(pVisLargeObjView, Diligent::SET_SHADER_RESOURCE_FLAG_ALLOW_OVERWRITE);
-
-    m_diligent->pImmediateContext->CommitShaderResources(m_diligent->pLargeObjectCommandGenSRB, Diligent::RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
-
-    if (visibleLargeObjectCount > 0) {
-        m_diligent->pImmediateContext->DispatchCompute(Diligent::DispatchComputeAttribs(1, 1, 1));
-    }
-
-    Barrier.pResource = m_diligent->pDepthPrepassDrawCommandBuffer;
-    Barrier.OldState = Diligent::RESOURCE_STATE_UNORDERED_ACCESS;
-    Barrier.NewState = Diligent::RESOURCE_STATE_INDIRECT_ARGUMENT;
-    Barrier.TransitionType = Diligent::STATE_TRANSITION_TYPE_IMMEDIATE;
-    Barrier.Flags = Diligent::STATE_TRANSITION_FLAG_UPDATE_STATE;
-    m_diligent->pImmediateContext->TransitionResourceStates(1, &Barrier);
-
-    Barrier.pResource = m_diligent->pDepthPrepassAtomicCounter;
-    Barrier.OldState = Diligent::RESOURCE_STATE_UNORDERED_ACCESS;
-    Barrier.NewState = Diligent::RESOURCE_STATE_INDIRECT_ARGUMENT;
-    Barrier.TransitionType = Diligent::STATE_TRANSITION_TYPE_IMMEDIATE;
-    Barrier.Flags = Diligent::STATE_TRANSITION_FLAG_UPDATE_STATE;
-    m_diligent->pImmediateContext->TransitionResourceStates(1, &Barrier);
+        m_diligent->pImmediateContext->EndQuery(queries.pCommandGenEnd);
 
-    m_diligent->pImmediateContext->EndQuery(m_diligent->pLargeObjectCommandGenEndQuery[m_currentFrame]);
+        m_diligent->pImmediateContext->EndQuery(queries.pDrawStart);
 
-    m_diligent->pImmediateContext->EndQuery(m_diligent->pDepthPrePassStartQuery[m_currentFrame]);
-    Diligent::ITextureView* pRTVs[] = {m_diligent->pHiZTextures[m_currentFrame]->GetDefaultView(Diligent::TEXTURE_VIEW_RENDER_TARGET)};
-    m_diligent->pImmediateContext->SetRenderTargets(1, pRTVs, m_diligent->pDepthRenderbuffers[m_currentFrame]->GetDefaultView(Diligent::TEXTURE_VIEW_DEPTH_STENCIL), Diligent::RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
-    m_diligent->pImmediateContext->ClearRenderTarget(pRTVs[0], glm::value_ptr(glm::vec4(1.0f, 1.0f, 1.0f, 1.0f)), Diligent::RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
-    m_diligent->pImmediateContext->ClearDepthStencil(m_diligent->pDepthRenderbuffers[m_currentFrame]->GetDefaultView(Diligent::TEXTURE_VIEW_DEPTH_STENCIL), Diligent::CLEAR_DEPTH_FLAG, 1.0f, 0, Diligent::RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
-
-    unsigned int depthPrepassDrawCount = ReadAtomicCounter(m_diligent->pDepthPrepassAtomicCounter);
-
-    if (depthPrepassDrawCount > 0) {
-        m_diligent->pImmediateContext->SetPipelineState(m_diligent->pDepthPrepassPSO);
-
-        if (auto* var = m_diligent->pDepthPrepassSRB->GetVariableByName(Diligent::SHADER_TYPE_VERTEX, "SceneData"))
-            var->Set(m_diligent->pSceneUBO, Diligent::SET_SHADER_RESOURCE_FLAG_ALLOW_OVERWRITE);
-
-        Diligent::BufferViewDesc ObjViewDesc;
-        ObjViewDesc.ViewType = Diligent::BUFFER_VIEW_SHADER_RESOURCE;
-        ObjViewDesc.ByteOffset = frameOffset * sizeof(TransformComponent);
-        ObjViewDesc.ByteWidth = m_maxObjects * sizeof(TransformComponent);
-        Diligent::RefCntAutoPtr<Diligent::IBufferView> pObjView;
-        m_diligent->pObjectBuffer->CreateView(ObjViewDesc, &pObjView);
-        if (auto* var = m_diligent->pDepthPrepassSRB->GetVariableByName(Diligent::SHADER_TYPE_VERTEX, "ObjectBuffer"))
-            var->Set(pObjView, Diligent::SET_SHADER_RESOURCE_FLAG_ALLOW_OVERWRITE);
+        m_diligent->pImmediateContext->SetRenderTargets(1, &pSceneRTV, pSceneDSV, Diligent::RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+        if (phase == 0) {
+            m_diligent->pImmediateContext->ClearRenderTarget(pSceneRTV, glm::value_ptr(glm::vec4(0.3f, 0.3f, 0.3f, 1.0f)), Diligent::RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+            m_diligent->pImmediateContext->ClearDepthStencil(pSceneDSV, Diligent::CLEAR_DEPTH_FLAG, 1.0f, 0, Diligent::RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+        }
 
-        Diligent::BufferViewDesc VisLargeObjViewDesc;
-        VisLargeObjViewDesc.ViewType = Diligent::BUFFER_VIEW_SHADER_RESOURCE;
-        VisLargeObjViewDesc.ByteOffset = frameOffset * sizeof(unsigned int);
-        VisLargeObjViewDesc.ByteWidth = m_maxObjects * sizeof(unsigned int);
-        Diligent::RefCntAutoPtr<Diligent::IBufferView> pVisLargeObjView;
-        m_diligent->pVisibleLargeObjectBuffer->CreateView(VisLargeObjViewDesc, &pVisLargeObjView);
-        if (auto* var = m_diligent->pDepthPrepassSRB->GetVariableByName(Diligent::SHADER_TYPE_VERTEX, "VisibleLargeObjectBuffer"))
-            var->Set(pVisLargeObjView, Diligent::SET_SHADER_RESOURCE_FLAG_ALLOW_OVERWRITE);
+        // Every mesh shares the vertex buffer; the index buffer follows each bin's index type.
+        Diligent::IBuffer* pVertexBuffers[] = {m_diligent->pVBO};
+        m_diligent->pImmediateContext->SetVertexBuffers(0, 1, pVertexBuffers, nullptr, Diligent::RESOURCE_STATE_TRANSITION_MODE_TRANSITION, Diligent::SET_VERTEX_BUFFERS_FLAG_RESET);
 
-        m_diligent->pImmediateContext->CommitShaderResources(m_diligent->pDepthPrepassSRB, Diligent::RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+        for (uint32_t shaderId = 0; shaderId < m_diligent->pOpaquePSOs.size(); ++shaderId) {
+            if (!m_diligent->pOpaquePSOs[shaderId])
+                continue;
 
-        Diligent::IBuffer* pVBs[] = {m_diligent->pVBO};
-        m_diligent->pImmediateContext->SetVertexBuffers(0, 1, pVBs, nullptr, Diligent::RESOURCE_STATE_TRANSITION_MODE_TRANSITION, Diligent::SET_VERTEX_BUFFERS_FLAG_RESET);
-        m_diligent->pImmediateContext->SetIndexBuffer(m_diligent->pEBO, 0, Diligent::RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+            m_diligent->pImmediateContext->SetPipelineState(m_diligent->pOpaquePSOs[shaderId]);
 
-        for (unsigned int i = 0; i < depthPrepassDrawCount; ++i) {
             Diligent::DrawIndexedIndirectAttribs DrawAttrs;
-            DrawAttrs.IndexType = Diligent::VT_UINT32;
             DrawAttrs.Flags = Diligent::DRAW_FLAG_VERIFY_ALL;
-            DrawAttrs.DrawArgsOffset = (frameOffset * sizeof(DrawElementsIndirectCommand)) + (i * sizeof(DrawElementsIndirectCommand));
-            DrawAttrs.pAttribsBuffer = m_diligent->pDepthPrepassDrawCommandBuffer;
-            m_diligent->pImmediateContext->DrawIndexedIndirect(DrawAttrs);
-        }
-    }
-
-    m_diligent->pImmediateContext->SetRenderTargets(0, nullptr, nullptr, Diligent::RESOURCE_STATE_TRANSITION_MODE_NONE);
-
-    m_diligent->pImmediateContext->EndQuery(m_diligent->pOpaqueDrawStartQuery[m_currentFrame]);
-
-    Diligent::Viewport VP;
-    VP.Width = (float)m_windowWidth;
-    VP.Height = (float)m_windowHeight;
-    VP.MinDepth = 0.0f;
-    VP.MaxDepth = 1.0f;
-    VP.TopLeftX = 0;
-    VP.TopLeftY = 0;
-    m_diligent->pImmediateContext->SetViewports(1, &VP, m_windowWidth, m_windowHeight);
-
-    auto* pRTV = m_diligent->pSwapChain->GetCurrentBackBufferRTV();
-    auto* pDSV = m_diligent->pSwapChain->GetDepthBufferDSV();
-    m_diligent->pImmediateContext->SetRenderTargets(1, &pRTV, pDSV, Diligent::RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
-    m_diligent->pImmediateContext->ClearRenderTarget(pRTV, glm::value_ptr(glm::vec4(0.3f, 0.3f, 0.3f, 1.0f)), Diligent::RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
-    m_diligent->pImmediateContext->ClearDepthStencil(pDSV, Diligent::CLEAR_DEPTH_FLAG, 1.0f, 0, Diligent::RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
-
-    for (uint32_t shaderId = 0; shaderId < m_diligent->pOpaquePSOs.size(); ++shaderId) {
-        if (!m_diligent->pOpaquePSOs[shaderId])
-            continue;
+            DrawAttrs.DrawArgsStride = sizeof(DrawElementsIndirectCommand);
+            DrawAttrs.AttribsBufferStateTransitionMode = Diligent::RESOURCE_STATE_TRANSITION_MODE_TRANSITION;
+            DrawAttrs.CounterBufferStateTransitionMode = Diligent::RESOURCE_STATE_TRANSITION_MODE_TRANSITION;
+
+            auto DrawBins = [&](Diligent::IBuffer* pCommandBuffer, Diligent::IBuffer* pCounterBuffer, size_t frameOffset, uint32_t binCapacity) {
+                for (uint32_t indexType = 0; indexType < INDEX_TYPE_COUNT; ++indexType) {
+                    const bool shortIndices = indexType == INDEX_TYPE_UINT16;
+                    const uint32_t bin = shaderId * INDEX_TYPE_COUNT + indexType;
+                    m_diligent->pImmediateContext->SetIndexBuffer(shortIndices ? m_diligent->pShortEBO : m_diligent->pEBO, 0, Diligent::RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+                    DrawAttrs.IndexType = shortIndices ? Diligent::VT_UINT16 : Diligent::VT_UINT32;
+                    DrawAttrs.DrawArgsOffset = (frameOffset + bin * binCapacity) * sizeof(DrawElementsIndirectCommand);
+                    DrawAttrs.pAttribsBuffer = pCommandBuffer;
+                    DrawAttrs.DrawCount = binCapacity;
+                    DrawAttrs.pCounterBuffer = pCounterBuffer;
+                    DrawAttrs.CounterOffset = bin * sizeof(unsigned int);
+                    m_diligent->pImmediateContext->DrawIndexedIndirect(DrawAttrs);
+                }
+            };
 
-        m_diligent->pImmediateContext->SetPipelineState(m_diligent->pOpaquePSOs[shaderId]);
+            m_diligent->pImmediateContext->CommitShaderResources(frame.pOpaqueSRBs[shaderId], Diligent::RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+            DrawBins(m_diligent->pDrawCommandBuffer, m_diligent->pDrawAtomicCounterBuffer, m_currentFrame * m_numDrawBins * m_maxObjects, static_cast<uint32_t>(m_maxObjects));
 
-        Diligent::IShaderResourceBinding* pSRB = m_diligent->pOpaqueSRBs[shaderId];
+            // Meshlet draws carry their own instance slot in baseInstance.
+            m_diligent->pImmediateContext->CommitShaderResources(frame.pClusterSRBs[shaderId], Diligent::RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+            DrawBins(m_diligent->pClusterDrawCommandBuffer, m_diligent->pClusterDrawCounterBuffer, 0, MAX_CLUSTER_DRAWS);
+        }
 
-        if (auto* var = pSRB->GetVariableByName(Diligent::SHADER_TYPE_VERTEX, "SceneData"))
-            var->Set(m_diligent->pSceneUBO, Diligent::SET_SHADER_RESOURCE_FLAG_ALLOW_OVERWRITE);
+        m_diligent->pImmediateContext->EndQuery(queries.pDrawEnd);
+    };
 
-        Diligent::BufferViewDesc ObjViewDesc;
-        ObjViewDesc.ViewType = Diligent::BUFFER_VIEW_SHADER_RESOURCE;
-        ObjViewDesc.ByteOffset = frameOffset * sizeof(TransformComponent);
-        ObjViewDesc.ByteWidth = m_maxObjects * sizeof(TransformComponent);
-        Diligent::RefCntAutoPtr<Diligent::IBufferView> pObjView;
-        m_diligent->pObjectBuffer->CreateView(ObjViewDesc, &pObjView);
-        if (auto* var = pSRB->GetVariableByName(Diligent::SHADER_TYPE_VERTEX, "ObjectBuffer"))
-            var->Set(pObjView, Diligent::SET_SHADER_RESOURCE_FLAG_ALLOW_OVERWRITE);
+    RecordOpaquePhase(0, {m_diligent->pCullStartQuery[m_currentFrame], m_diligent->pCullEndQuery[m_currentFrame], m_diligent->pOpaqueSortStartQuery[m_currentFrame],
+                          m_diligent->pOpaqueSortEndQuery[m_currentFrame], m_diligent->pCommandGenStartQuery[m_currentFrame], m_diligent->pCommandGenEndQuery[m_currentFrame],
+                          m_diligent->pOpaqueDrawStartQuery[m_currentFrame], m_diligent->pOpaqueDrawEndQuery[m_currentFrame]});
 
-        Diligent::BufferViewDesc VisObjViewDesc;
-        VisObjViewDesc.ViewType = Diligent::BUFFER_VIEW_SHADER_RESOURCE;
-        VisObjViewDesc.ByteOffset = frameOffset * sizeof(unsigned int);
-        VisObjViewDesc.ByteWidth = m_maxObjects * sizeof(unsigned int);
-        Diligent::RefCntAutoPtr<Diligent::IBufferView> pVisObjView;
-        m_diligent->pVisibleObjectBuffer->CreateView(VisObjViewDesc, &pVisObjView);
-        if (auto* var = pSRB->GetVariableByName(Diligent::SHADER_TYPE_VERTEX, "VisibleObjectBuffer"))
-            var->Set(pVisObjView, Diligent::SET_SHADER_RESOURCE_FLAG_ALLOW_OVERWRITE);
+    m_diligent->pImmediateContext->SetRenderTargets(0, nullptr, nullptr, Diligent::RESOURCE_STATE_TRANSITION_MODE_NONE);
 
-        m_diligent->pImmediateContext->CommitShaderResources(pSRB, Diligent::RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+    m_diligent->pImmediateContext->EndQuery(m_diligent->pHizMipmapStartQuery[m_currentFrame]);
 
-        Diligent::DrawIndexedIndirectAttribs DrawAttrs;
-        DrawAttrs.IndexType = Diligent::VT_UINT32;
-        DrawAttrs.Flags = Diligent::DRAW_FLAG_VERIFY_ALL;
-        DrawAttrs.DrawArgsOffset = (m_currentFrame * m_numDrawingShaders * m_maxObjects + shaderId * m_maxObjects) * sizeof(DrawElementsIndirectCommand);
-        DrawAttrs.pAttribsBuffer = m_diligent->pDrawCommandBuffer;
-        DrawAttrs.DrawCount = m_maxObjects;
-        DrawAttrs.DrawArgsStride = sizeof(DrawElementsIndirectCommand);
-        DrawAttrs.pCounterBuffer = m_diligent->pDrawAtomicCounterBuffer;
-        DrawAttrs.CounterOffset = shaderId * sizeof(unsigned int);
-        DrawAttrs.AttribsBufferStateTransitionMode = Diligent::RESOURCE_STATE_TRANSITION_MODE_TRANSITION;
-        DrawAttrs.CounterBufferStateTransitionMode = Diligent::RESOURCE_STATE_TRANSITION_MODE_TRANSITION;
+    if (m_diligent->pHiZDownsamplePSO) {
+        m_diligent->pImmediateContext->SetPipelineState(m_diligent->pHiZDownsamplePSO);
+        m_diligent->pImmediateContext->CommitShaderResources(m_diligent->pHiZDownsampleSRBs[m_currentFrame], Diligent::RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+        m_diligent->pImmediateContext->DispatchCompute(Diligent::DispatchComputeAttribs((m_windowWidth + HIZ_DOWNSAMPLE_TILE_SIZE - 1) / HIZ_DOWNSAMPLE_TILE_SIZE,
+                                                                                        (m_windowHeight + HIZ_DOWNSAMPLE_TILE_SIZE - 1) / HIZ_DOWNSAMPLE_TILE_SIZE, 1));
 
-        m_diligent->pImmediateContext->DrawIndexedIndirect(DrawAttrs);
+        Diligent::StateTransitionDesc Barrier;
+        Barrier.pResource = m_diligent->pHiZTextures[m_currentFrame];
+        Barrier.OldState = Diligent::RESOURCE_STATE_UNORDERED_ACCESS;
+        Barrier.NewState = Diligent::RESOURCE_STATE_UNORDERED_ACCESS;
+        Barrier.TransitionType = Diligent::STATE_TRANSITION_TYPE_IMMEDIATE;
+        Barrier.Flags = Diligent::STATE_TRANSITION_FLAG_UPDATE_STATE;
+        m_diligent->pImmediateContext->TransitionResourceStates(1, &Barrier);
     }
 
-    m_diligent->pImmediateContext->EndQuery(m_diligent->pOpaqueDrawEndQuery[m_currentFrame]);
+    m_diligent->pImmediateContext->EndQuery(m_diligent->pHizMipmapEndQuery[m_currentFrame]);
+
+    RecordOpaquePhase(1, {m_diligent->pOcclusionCullStartQuery[m_currentFrame], m_diligent->pOcclusionCullEndQuery[m_currentFrame], m_diligent->pOcclusionSortStartQuery[m_currentFrame],
+                          m_diligent->pOcclusionSortEndQuery[m_currentFrame], m_diligent->pOcclusionCommandGenStartQuery[m_currentFrame], m_diligent->pOcclusionCommandGenEndQuery[m_currentFrame],
+                          m_diligent->pOcclusionDrawStartQuery[m_currentFrame], m_diligent->pOcclusionDrawEndQuery[m_currentFrame]});
 
     ResetAtomicCounter(m_diligent->pTransparentAtomicCounter);
 
     m_diligent->pImmediateContext->EndQuery(m_diligent->pTransparentCullStartQuery[m_currentFrame]);
     {
-        TransparentCullUniforms uniforms;
-        uniforms.objectCount = numObjects;
-        uniforms.cameraPos = camera.getPosition();
-        m_diligent->pImmediateContext->UpdateBuffer(m_diligent->pTransparentCullUniforms, 0, sizeof(uniforms), &uniforms, Diligent::RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
-
         m_diligent->pImmediateContext->SetPipelineState(m_diligent->pTransparentCullPSO);
 
-        if (auto* var = m_diligent->pTransparentCullSRB->GetVariableByName(Diligent::SHADER_TYPE_COMPUTE, "AtomicCounterBuffer"))
-            var->Set(m_diligent->pTransparentAtomicCounter->GetDefaultView(Diligent::BUFFER_VIEW_UNORDERED_ACCESS), Diligent::SET_SHADER_RESOURCE_FLAG_ALLOW_OVERWRITE);
-
-        Diligent::BufferViewDesc VisTransObjViewDesc;
-        VisTransObjViewDesc.ViewType = Diligent::BUFFER_VIEW_UNORDERED_ACCESS;
-        VisTransObjViewDesc.ByteOffset = frameOffset * sizeof(VisibleTransparentObject);
-        VisTransObjViewDesc.ByteWidth = m_maxObjects * sizeof(VisibleTransparentObject);
-        Diligent::RefCntAutoPtr<Diligent::IBufferView> pVisTransObjView;
-        m_diligent->pVisibleTransparentObjectIdsBuffer->CreateView(VisTransObjViewDesc, &pVisTransObjView);
-        if (auto* var = m_diligent->pTransparentCullSRB->GetVariableByName(Diligent::SHADER_TYPE_COMPUTE, "VisibleTransparentObjectBuffer"))
-            var->Set(pVisTransObjView, Diligent::SET_SHADER_RESOURCE_FLAG_ALLOW_OVERWRITE);
-
-        Diligent::BufferViewDesc ObjViewDesc;
-        ObjViewDesc.ViewType = Diligent::BUFFER_VIEW_SHADER_RESOURCE;
-        ObjViewDesc.ByteOffset = frameOffset * sizeof(TransformComponent);
-        ObjViewDesc.ByteWidth = m_maxObjects * sizeof(TransformComponent);
-        Diligent::RefCntAutoPtr<Diligent::IBufferView> pObjView;
-        m_diligent->pObjectBuffer->CreateView(ObjViewDesc, &pObjView);
-        if (auto* var = m_diligent->pTransparentCullSRB->GetVariableByName(Diligent::SHADER_TYPE_COMPUTE, "ObjectBuffer"))
-            var->Set(pObjView, Diligent::SET_SHADER_RESOURCE_FLAG_ALLOW_OVERWRITE);
-
-        if (auto* var = m_diligent->pTransparentCullSRB->GetVariableByName(Diligent::SHADER_TYPE_COMPUTE, "MeshInfoBuffer"))
-            var->Set(m_diligent->pMeshInfoBuffer->GetDefaultView(Diligent::BUFFER_VIEW_SHADER_RESOURCE), Diligent::SET_SHADER_RESOURCE_FLAG_ALLOW_OVERWRITE);
-
-        Diligent::BufferViewDesc RenderableViewDesc;
-        RenderableViewDesc.ViewType = Diligent::BUFFER_VIEW_SHADER_RESOURCE;
-        RenderableViewDesc.ByteOffset = frameOffset * sizeof(RenderableComponent);
-        RenderableViewDesc.ByteWidth = m_maxObjects * sizeof(RenderableComponent);
-        Diligent::RefCntAutoPtr<Diligent::IBufferView> pRenderableView;
-        m_diligent->pRenderableBuffer->CreateView(RenderableViewDesc, &pRenderableView);
-        if (auto* var = m_diligent->pTransparentCullSRB->GetVariableByName(Diligent::SHADER_TYPE_COMPUTE, "RenderableBuffer"))
-            var->Set(pRenderableView, Diligent::SET_SHADER_RESOURCE_FLAG_ALLOW_OVERWRITE);
-
-        if (auto* var = m_diligent->pTransparentCullSRB->GetVariableByName(Diligent::SHADER_TYPE_COMPUTE, "TransparentCullUniforms"))
-            var->Set(m_diligent->pTransparentCullUniforms, Diligent::SET_SHADER_RESOURCE_FLAG_ALLOW_OVERWRITE);
-
-        m_diligent->pImmediateContext->CommitShaderResources(m_diligent->pTransparentCullSRB, Diligent::RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+        uploads.copy(transparentKeyLayoutOffset, m_diligent->pSortKeyConstants, 0, sizeof(SortKeyConstants));
+
+        m_diligent->pImmediateContext->CommitShaderResources(frame.pTransparentCullSRB, Diligent::RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
 
         Diligent::DispatchComputeAttribs DispatchAttrs;
         DispatchAttrs.ThreadGroupCountX = numWorkgroups;
@@ -1553,116 +2199,25 @@ void Renderer::drawScene(SceneDatabase& sceneDatabase, const Camera& camera) {
         DispatchAttrs.ThreadGroupCountZ = 1;
         m_diligent->pImmediateContext->DispatchCompute(DispatchAttrs);
 
-        Diligent::StateTransitionDesc Barrier;
-        Barrier.pResource = m_diligent->pTransparentAtomicCounter;
-        Barrier.OldState = Diligent::RESOURCE_STATE_UNORDERED_ACCESS;
-        Barrier.NewState = Diligent::RESOURCE_STATE_COPY_SOURCE;
-        Barrier.TransitionType = Diligent::STATE_TRANSITION_TYPE_IMMEDIATE;
-        Barrier.Flags = Diligent::STATE_TRANSITION_FLAG_UPDATE_STATE;
-        m_diligent->pImmediateContext->TransitionResourceStates(1, &Barrier);
+        WriteDispatchArgs(m_diligent->pTransparentAtomicCounter, transparentDispatchArgsOffset);
     }
 
     m_diligent->pImmediateContext->EndQuery(m_diligent->pTransparentCullEndQuery[m_currentFrame]);
 
-    unsigned int visibleTransparentCount = ReadAtomicCounter(m_diligent->pTransparentAtomicCounter);
-
-    if (visibleTransparentCount > 1) {
-        if (false)
-            ;
-        m_diligent->pImmediateContext->EndQuery(m_diligent->pTransparentSortStartQuery[m_currentFrame]);
-        m_diligent->pImmediateContext->SetPipelineState(m_diligent->pTransparentSortPSO);
-
-        Diligent::BufferViewDesc VisTransObjViewDesc;
-        VisTransObjViewDesc.ViewType = Diligent::BUFFER_VIEW_UNORDERED_ACCESS;
-        VisTransObjViewDesc.ByteOffset = frameOffset * sizeof(VisibleTransparentObject);
-        VisTransObjViewDesc.ByteWidth = m_maxObjects * sizeof(VisibleTransparentObject);
-        Diligent::RefCntAutoPtr<Diligent::IBufferView> pVisTransObjView;
-        m_diligent->pVisibleTransparentObjectIdsBuffer->CreateView(VisTransObjViewDesc, &pVisTransObjView);
-        if (auto* var = m_diligent->pTransparentSortSRB->GetVariableByName(Diligent::SHADER_TYPE_COMPUTE, "VisibleTransparentObjectBuffer"))
-            var->Set(pVisTransObjView, Diligent::SET_SHADER_RESOURCE_FLAG_ALLOW_OVERWRITE);
-
-        if (auto* var = m_diligent->pTransparentSortSRB->GetVariableByName(Diligent::SHADER_TYPE_COMPUTE, "SortConstants"))
-            var->Set(m_diligent->pTransparentSortConstants, Diligent::SET_SHADER_RESOURCE_FLAG_ALLOW_OVERWRITE);
-
-        const unsigned int numElements = nextPowerOfTwo(visibleTransparentCount);
-
-        for (unsigned int k = 2; k <= numElements; k <<= 1) {
-            for (unsigned int j = k >> 1; j > 0; j >>= 1) {
-                SortConstants constants;
-                constants.k = k;
-                constants.j = j;
-                m_diligent->pImmediateContext->UpdateBuffer(m_diligent->pTransparentSortConstants, 0, sizeof(SortConstants), &constants, Diligent::RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
-
-                m_diligent->pImmediateContext->CommitShaderResources(m_diligent->pTransparentSortSRB, Diligent::RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
-
-                Diligent::DispatchComputeAttribs DispatchAttrs;
-                DispatchAttrs.ThreadGroupCountX = (numElements + 511) / 512;
-                DispatchAttrs.ThreadGroupCountY = 1;
-                DispatchAttrs.ThreadGroupCountZ = 1;
-                m_diligent->pImmediateContext->DispatchCompute(DispatchAttrs);
-            }
-        }
+    m_diligent->pImmediateContext->EndQuery(m_diligent->pTransparentSortStartQuery[m_currentFrame]);
+    RecordRadixSort(m_diligent->pTransparentSortPSO, frame.pTransparentSortSRB, frame.pTransparentSortValueVar, m_diligent->pTransparentSortConstants, m_diligent->pTransparentAtomicCounter,
+                    TRANSPARENT_SORT_ARGS, TRANSPARENT_COMMAND_GEN_ARGS, sortKeyBits(transparentKeyLayout));
+    m_diligent->pImmediateContext->EndQuery(m_diligent->pTransparentSortEndQuery[m_currentFrame]);
 
-        if (false)
-            ;
-        m_diligent->pImmediateContext->EndQuery(m_diligent->pTransparentSortEndQuery[m_currentFrame]);
-        m_diligent->TransparentSortActive[m_currentFrame] = true;
-    } else {
-        m_diligent->TransparentSortActive[m_currentFrame] = false;
-    }
-
-    m_diligent->pImmediateContext->EndQuery(m_diligent->pTransparentCommandGenStartQuery[m_currentFrame]);
     m_diligent->pImmediateContext->EndQuery(m_diligent->pTransparentCommandGenStartQuery[m_currentFrame]);
 
     m_diligent->pImmediateContext->SetPipelineState(m_diligent->pTransparentCommandGenPSO);
 
-    TransparentCommandGenUniforms uniforms;
-    uniforms.visibleTransparentCount = visibleTransparentCount;
-    m_diligent->pImmediateContext->UpdateBuffer(m_diligent->pTransparentCommandGenUniforms, 0, sizeof(TransparentCommandGenUniforms), &uniforms, Diligent::RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
-
-    if (auto* var = m_diligent->pTransparentCommandGenSRB->GetVariableByName(Diligent::SHADER_TYPE_COMPUTE, "TransparentCommandGenUniforms"))
-        var->Set(m_diligent->pTransparentCommandGenUniforms, Diligent::SET_SHADER_RESOURCE_FLAG_ALLOW_OVERWRITE);
-
-    Diligent::BufferViewDesc VisTransObjViewDesc;
-    VisTransObjViewDesc.ViewType = Diligent::BUFFER_VIEW_UNORDERED_ACCESS;
-    VisTransObjViewDesc.ByteOffset = frameOffset * sizeof(VisibleTransparentObject);
-    VisTransObjViewDesc.ByteWidth = m_maxObjects * sizeof(VisibleTransparentObject);
-    Diligent::RefCntAutoPtr<Diligent::IBufferView> pVisTransObjView;
-    m_diligent->pVisibleTransparentObjectIdsBuffer->CreateView(VisTransObjViewDesc, &pVisTransObjView);
-    if (auto* var = m_diligent->pTransparentCommandGenSRB->GetVariableByName(Diligent::SHADER_TYPE_COMPUTE, "VisibleTransparentObjectBuffer"))
-        var->Set(pVisTransObjView, Diligent::SET_SHADER_RESOURCE_FLAG_ALLOW_OVERWRITE);
-
-    if (auto* var = m_diligent->pTransparentCommandGenSRB->GetVariableByName(Diligent::SHADER_TYPE_COMPUTE, "MeshInfoBuffer"))
-        var->Set(m_diligent->pMeshInfoBuffer->GetDefaultView(Diligent::BUFFER_VIEW_SHADER_RESOURCE), Diligent::SET_SHADER_RESOURCE_FLAG_ALLOW_OVERWRITE);
-
-    RenderableViewDesc.ViewType = Diligent::BUFFER_VIEW_UNORDERED_ACCESS;
-    RenderableViewDesc.ByteOffset = frameOffset * sizeof(RenderableComponent);
-    RenderableViewDesc.ByteWidth = m_maxObjects * sizeof(RenderableComponent);
-    pRenderableView.Release();
-    m_diligent->pRenderableBuffer->CreateView(RenderableViewDesc, &pRenderableView);
-    if (auto* var = m_diligent->pTransparentCommandGenSRB->GetVariableByName(Diligent::SHADER_TYPE_COMPUTE, "RenderableBuffer"))
-        var->Set(pRenderableView, Diligent::SET_SHADER_RESOURCE_FLAG_ALLOW_OVERWRITE);
-
-    Diligent::BufferViewDesc TransCmdViewDesc;
-    TransCmdViewDesc.ViewType = Diligent::BUFFER_VIEW_UNORDERED_ACCESS;
-    TransCmdViewDesc.ByteOffset = frameOffset * sizeof(DrawElementsIndirectCommand);
-    TransCmdViewDesc.ByteWidth = m_maxObjects * sizeof(DrawElementsIndirectCommand);
-    Diligent::RefCntAutoPtr<Diligent::IBufferView> pTransCmdView;
-    m_diligent->pTransparentDrawCommandBuffer->CreateView(TransCmdViewDesc, &pTransCmdView);
-    if (auto* var = m_diligent->pTransparentCommandGenSRB->GetVariableByName(Diligent::SHADER_TYPE_COMPUTE, "TransparentDrawCommandBuffer"))
-        var->Set(pTransCmdView, Diligent::SET_SHADER_RESOURCE_FLAG_ALLOW_OVERWRITE);
-
-    m_diligent->pImmediateContext->CommitShaderResources(m_diligent->pTransparentCommandGenSRB, Diligent::RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
-
-    const unsigned int transparentWorkgroups = (visibleTransparentCount + workgroupSize - 1) / workgroupSize;
-    if (visibleTransparentCount > 0) {
-        Diligent::DispatchComputeAttribs DispatchAttrs;
-        DispatchAttrs.ThreadGroupCountX = transparentWorkgroups;
-        DispatchAttrs.ThreadGroupCountY = 1;
-        DispatchAttrs.ThreadGroupCountZ = 1;
-        m_diligent->pImmediateContext->DispatchCompute(DispatchAttrs);
-    }
+    m_diligent->pImmediateContext->CommitShaderResources(frame.pTransparentCommandGenSRB, Diligent::RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+
+    DispatchIndirect(TRANSPARENT_COMMAND_GEN_ARGS);
 
+    Diligent::StateTransitionDesc Barrier;
     Barrier.pResource = m_diligent->pTransparentDrawCommandBuffer;
     Barrier.OldState = Diligent::RESOURCE_STATE_UNORDERED_ACCESS;
     Barrier.NewState = Diligent::RESOURCE_STATE_INDIRECT_ARGUMENT;
@@ -1673,99 +2228,44 @@ void Renderer::drawScene(SceneDatabase& sceneDatabase, const Camera& camera) {
     m_diligent->pImmediateContext->EndQuery(m_diligent->pTransparentCommandGenEndQuery[m_currentFrame]);
 
     m_diligent->pImmediateContext->EndQuery(m_diligent->pTransparentDrawStartQuery[m_currentFrame]);
-    if (visibleTransparentCount > 0) {
+    {
+        m_diligent->pImmediateContext->SetRenderTargets(1, &pSceneRTV, pSceneDSV, Diligent::RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
         m_diligent->pImmediateContext->SetPipelineState(m_diligent->pTransparentPSO);
 
-        if (auto* var = m_diligent->pTransparentSRB->GetVariableByName(Diligent::SHADER_TYPE_VERTEX, "SceneData"))
-            var->Set(m_diligent->pSceneUBO, Diligent::SET_SHADER_RESOURCE_FLAG_ALLOW_OVERWRITE);
-
-        Diligent::BufferViewDesc ObjViewDesc;
-        ObjViewDesc.ViewType = Diligent::BUFFER_VIEW_SHADER_RESOURCE;
-        ObjViewDesc.ByteOffset = frameOffset * sizeof(TransformComponent);
-        ObjViewDesc.ByteWidth = m_maxObjects * sizeof(TransformComponent);
-        Diligent::RefCntAutoPtr<Diligent::IBufferView> pObjView;
-        m_diligent->pObjectBuffer->CreateView(ObjViewDesc, &pObjView);
-        if (auto* var = m_diligent->pTransparentSRB->GetVariableByName(Diligent::SHADER_TYPE_VERTEX, "ObjectBuffer"))
-            var->Set(pObjView, Diligent::SET_SHADER_RESOURCE_FLAG_ALLOW_OVERWRITE);
-
-        Diligent::BufferViewDesc VisObjViewDesc;
-        VisObjViewDesc.ViewType = Diligent::BUFFER_VIEW_SHADER_RESOURCE;
-        VisObjViewDesc.ByteOffset = frameOffset * sizeof(VisibleTransparentObject);
-        VisObjViewDesc.ByteWidth = m_maxObjects * sizeof(VisibleTransparentObject);
-        Diligent::RefCntAutoPtr<Diligent::IBufferView> pVisObjView;
-        m_diligent->pVisibleTransparentObjectIdsBuffer->CreateView(VisObjViewDesc, &pVisObjView);
-        if (auto* var = m_diligent->pTransparentSRB->GetVariableByName(Diligent::SHADER_TYPE_VERTEX, "VisibleObjectBuffer"))
-            var->Set(pVisObjView, Diligent::SET_SHADER_RESOURCE_FLAG_ALLOW_OVERWRITE);
-
-        m_diligent->pImmediateContext->CommitShaderResources(m_diligent->pTransparentSRB, Diligent::RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+        m_diligent->pImmediateContext->CommitShaderResources(frame.pTransparentSRB, Diligent::RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+
+        // The sorted list mixes meshes of both index types, so it draws from the 32-bit copies.
+        Diligent::IBuffer* pVertexBuffers[] = {m_diligent->pVBO};
+        m_diligent->pImmediateContext->SetVertexBuffers(0, 1, pVertexBuffers, nullptr, Diligent::RESOURCE_STATE_TRANSITION_MODE_TRANSITION, Diligent::SET_VERTEX_BUFFERS_FLAG_RESET);
+        m_diligent->pImmediateContext->SetIndexBuffer(m_diligent->pEBO, 0, Diligent::RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
 
         Diligent::DrawIndexedIndirectAttribs DrawAttrs;
         DrawAttrs.IndexType = Diligent::VT_UINT32;
         DrawAttrs.Flags = Diligent::DRAW_FLAG_VERIFY_ALL;
         DrawAttrs.DrawArgsOffset = frameOffset * sizeof(DrawElementsIndirectCommand);
         DrawAttrs.pAttribsBuffer = m_diligent->pTransparentDrawCommandBuffer;
-        DrawAttrs.DrawCount = visibleTransparentCount;
+        DrawAttrs.DrawCount = m_maxObjects;
         DrawAttrs.DrawArgsStride = sizeof(DrawElementsIndirectCommand);
+        DrawAttrs.pCounterBuffer = m_diligent->pTransparentAtomicCounter;
+        DrawAttrs.CounterOffset = 0;
         DrawAttrs.AttribsBufferStateTransitionMode = Diligent::RESOURCE_STATE_TRANSITION_MODE_TRANSITION;
+        DrawAttrs.CounterBufferStateTransitionMode = Diligent::RESOURCE_STATE_TRANSITION_MODE_TRANSITION;
 
         m_diligent->pImmediateContext->DrawIndexedIndirect(DrawAttrs);
-
-        if (false)
-            ;
-        m_diligent->pImmediateContext->EndQuery(m_diligent->pTransparentDrawEndQuery[m_currentFrame]);
-        m_diligent->TransparentDrawActive[m_currentFrame] = true;
-    } else {
-        m_diligent->TransparentDrawActive[m_currentFrame] = false;
     }
+    m_diligent->pImmediateContext->EndQuery(m_diligent->pTransparentDrawEndQuery[m_currentFrame]);
 
-    m_diligent->pImmediateContext->EndQuery(m_diligent->pHizMipmapStartQuery[m_currentFrame]);
-
-    if (m_diligent->pHiZMipmapPSO) {
-        m_diligent->pImmediateContext->SetPipelineState(m_diligent->pHiZMipmapPSO);
-        for (int i = 1; i < m_maxMipLevel; ++i) {
-            Diligent::TextureViewDesc SourceViewDesc;
-            SourceViewDesc.ViewType = Diligent::TEXTURE_VIEW_UNORDERED_ACCESS;
-            SourceViewDesc.AccessFlags = Diligent::UAV_ACCESS_FLAG_READ;
-            SourceViewDesc.MostDetailedMip = i - 1;
-            SourceViewDesc.NumMipLevels = 1;
-            Diligent::RefCntAutoPtr<Diligent::ITextureView> pSourceView;
-            m_diligent->pHiZTextures[m_currentFrame]->CreateView(SourceViewDesc, &pSourceView);
-
-            Diligent::TextureViewDesc DestViewDesc;
-            DestViewDesc.ViewType = Diligent::TEXTURE_VIEW_UNORDERED_ACCESS;
-            DestViewDesc.AccessFlags = Diligent::UAV_ACCESS_FLAG_WRITE;
-            DestViewDesc.MostDetailedMip = i;
-            DestViewDesc.NumMipLevels = 1;
-            Diligent::RefCntAutoPtr<Diligent::ITextureView> pDestView;
-            m_diligent->pHiZTextures[m_currentFrame]->CreateView(DestViewDesc, &pDestView);
-
-            m_diligent->pHiZMipmapSRB->GetVariableByName(Diligent::SHADER_TYPE_COMPUTE, "u_sourceMip")->Set(pSourceView);
-            m_diligent->pHiZMipmapSRB->GetVariableByName(Diligent::SHADER_TYPE_COMPUTE, "u_destMip")->Set(pDestView);
-
-            m_diligent->pImmediateContext->CommitShaderResources(m_diligent->pHiZMipmapSRB, Diligent::RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
-
-            const int currentMipWidth = std::max(1, m_windowWidth >> i);
-            const int currentMipHeight = std::max(1, m_windowHeight >> i);
-
-            Diligent::DispatchComputeAttribs DispatchAttrs;
-            DispatchAttrs.ThreadGroupCountX = (currentMipWidth + 7) / 8;
-            DispatchAttrs.ThreadGroupCountY = (currentMipHeight + 7) / 8;
-            DispatchAttrs.ThreadGroupCountZ = 1;
-
-            m_diligent->pImmediateContext->DispatchCompute(DispatchAttrs);
+    auto* pRTV = m_diligent->pSwapChain->GetCurrentBackBufferRTV();
+    auto* pDSV = m_diligent->pSwapChain->GetDepthBufferDSV();
+    m_diligent->pImmediateContext->SetRenderTargets(1, &pRTV, pDSV, Diligent::RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+    m_diligent->pImmediateContext->ClearDepthStencil(pDSV, Diligent::CLEAR_DEPTH_FLAG, 1.0f, 0, Diligent::RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
 
-            Diligent::StateTransitionDesc Barrier;
-            Barrier.pResource = m_diligent->pHiZTextures[m_currentFrame];
-            Barrier.OldState = Diligent::RESOURCE_STATE_UNORDERED_ACCESS;
-            Barrier.NewState = Diligent::RESOURCE_STATE_UNORDERED_ACCESS;
-            Barrier.TransitionType = Diligent::STATE_TRANSITION_TYPE_IMMEDIATE;
-            Barrier.Flags = Diligent::STATE_TRANSITION_FLAG_UPDATE_STATE;
-            m_diligent->pImmediateContext->TransitionResourceStates(1, &Barrier);
-        }
+    if (m_diligent->pPresentPSO) {
+        m_diligent->pImmediateContext->SetPipelineState(m_diligent->pPresentPSO);
+        m_diligent->pImmediateContext->CommitShaderResources(m_diligent->pPresentSRB, Diligent::RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+        m_diligent->pImmediateContext->Draw(Diligent::DrawAttribs{3, Diligent::DRAW_FLAG_VERIFY_ALL});
     }
 
-    m_diligent->pImmediateContext->EndQuery(m_diligent->pHizMipmapEndQuery[m_currentFrame]);
-
     m_diligent->pImmediateContext->EndQuery(m_diligent->pUiStartQuery[m_currentFrame]);
 
     m_uiManager->render();
@@ -1819,50 +2319,34 @@ void Renderer::drawScene(SceneDatabase& sceneDatabase, const Camera& camera) {
 
         transformTime = GetQueryDataRef(m_diligent->pTransformStartQuery[m_currentFrame], m_diligent->pTransformEndQuery[m_currentFrame]);
         opaqueCullTime = GetQueryDataRef(m_diligent->pCullStartQuery[m_currentFrame], m_diligent->pCullEndQuery[m_currentFrame]);
-        if (m_diligent->OpaqueSortActive[m_currentFrame])
-            opaqueSortTime = GetQueryDataRef(m_diligent->pOpaqueSortStartQuery[m_currentFrame], m_diligent->pOpaqueSortEndQuery[m_currentFrame]);
-        else
-            opaqueSortTime = 0.0;
-
+        opaqueSortTime = GetQueryDataRef(m_diligent->pOpaqueSortStartQuery[m_currentFrame], m_diligent->pOpaqueSortEndQuery[m_currentFrame]);
         opaqueCommandGenTime = GetQueryDataRef(m_diligent->pCommandGenStartQuery[m_currentFrame], m_diligent->pCommandGenEndQuery[m_currentFrame]);
-        largeObjectCullTime = GetQueryDataRef(m_diligent->pLargeObjectCullStartQuery[m_currentFrame], m_diligent->pLargeObjectCullEndQuery[m_currentFrame]);
-
-        if (m_diligent->LargeObjectSortActive[m_currentFrame])
-            largeObjectSortTime = GetQueryDataRef(m_diligent->pLargeObjectSortStartQuery[m_currentFrame], m_diligent->pLargeObjectSortEndQuery[m_currentFrame]);
-        else
-            largeObjectSortTime = 0.0;
-
-        largeObjectCommandGenTime = GetQueryDataRef(m_diligent->pLargeObjectCommandGenStartQuery[m_currentFrame], m_diligent->pLargeObjectCommandGenEndQuery[m_currentFrame]);
-        depthPrePassTime = GetQueryDataRef(m_diligent->pDepthPrePassStartQuery[m_currentFrame], m_diligent->pDepthPrePassEndQuery[m_currentFrame]);
         opaqueDrawTime = GetQueryDataRef(m_diligent->pOpaqueDrawStartQuery[m_currentFrame], m_diligent->pOpaqueDrawEndQuery[m_currentFrame]);
+        occlusionCullTime = GetQueryDataRef(m_diligent->pOcclusionCullStartQuery[m_currentFrame], m_diligent->pOcclusionCullEndQuery[m_currentFrame]);
+        occlusionSortTime = GetQueryDataRef(m_diligent->pOcclusionSortStartQuery[m_currentFrame], m_diligent->pOcclusionSortEndQuery[m_currentFrame]);
+        occlusionCommandGenTime = GetQueryDataRef(m_diligent->pOcclusionCommandGenStartQuery[m_currentFrame], m_diligent->pOcclusionCommandGenEndQuery[m_currentFrame]);
+        occlusionDrawTime = GetQueryDataRef(m_diligent->pOcclusionDrawStartQuery[m_currentFrame], m_diligent->pOcclusionDrawEndQuery[m_currentFrame]);
 
         transparentCullTime = GetQueryDataRef(m_diligent->pTransparentCullStartQuery[m_currentFrame], m_diligent->pTransparentCullEndQuery[m_currentFrame]);
-        if (m_diligent->TransparentSortActive[m_currentFrame])
-            transparentSortTime = GetQueryDataRef(m_diligent->pTransparentSortStartQuery[m_currentFrame], m_diligent->pTransparentSortEndQuery[m_currentFrame]);
-        else
-            transparentSortTime = 0.0;
-
+        transparentSortTime = GetQueryDataRef(m_diligent->pTransparentSortStartQuery[m_currentFrame], m_diligent->pTransparentSortEndQuery[m_currentFrame]);
         transparentCommandGenTime = GetQueryDataRef(m_diligent->pTransparentCommandGenStartQuery[m_currentFrame], m_diligent->pTransparentCommandGenEndQuery[m_currentFrame]);
-
-        if (m_diligent->TransparentDrawActive[m_currentFrame])
-            transparentDrawTime = GetQueryDataRef(m_diligent->pTransparentDrawStartQuery[m_currentFrame], m_diligent->pTransparentDrawEndQuery[m_currentFrame]);
-        else
-            transparentDrawTime = 0.0;
+        transparentDrawTime = GetQueryDataRef(m_diligent->pTransparentDrawStartQuery[m_currentFrame], m_diligent->pTransparentDrawEndQuery[m_currentFrame]);
 
         hizMipmapTime = GetQueryDataRef(m_diligent->pHizMipmapStartQuery[m_currentFrame], m_diligent->pHizMipmapEndQuery[m_currentFrame]);
         uiTime = GetQueryDataRef(m_diligent->pUiStartQuery[m_currentFrame], m_diligent->pUiEndQuery[m_currentFrame]);
 
         Lit::Log::Debug("--- Full Profiling (GPU Queries) ---");
-        Lit::Log::Debug("Sum: {} ms", transformTime + opaqueCullTime + opaqueSortTime + opaqueCommandGenTime + largeObjectCullTime + largeObjectSortTime + largeObjectCommandGenTime + depthPrePassTime + opaqueDrawTime + transparentCullTime + transparentSortTime + transparentCommandGenTime + transparentDrawTime + hizMipmapTime + uiTime);
+        Lit::Log::Debug("Sum: {} ms", transformTime + opaqueCullTime + opaqueSortTime + opaqueCommandGenTime + opaqueDrawTime + occlusionCullTime + occlusionSortTime + occlusionCommandGenTime + occlusionDrawTime + transparentCullTime + transparentSortTime + transparentCommandGenTime + transparentDrawTime + hizMipmapTime + uiTime);
         Lit::Log::Debug("Transform: {} ms", transformTime);
+        Lit::Log::Debug("CPU Propagate: {} ms", m_propagateTime);
         Lit::Log::Debug("Opaque Cull: {} ms", opaqueCullTime);
         Lit::Log::Debug("Opaque Sort: {} ms", opaqueSortTime);
         Lit::Log::Debug("Opaque Command Generation: {} ms", opaqueCommandGenTime);
-        Lit::Log::Debug("Large Object Culling: {} ms", largeObjectCullTime);
-        Lit::Log::Debug("Large Object Sort: {} ms", largeObjectSortTime);
-        Lit::Log::Debug("Large Object Command Generation: {} ms", largeObjectCommandGenTime);
-        Lit::Log::Debug("Depth Pre-Pass: {} ms", depthPrePassTime);
         Lit::Log::Debug("Opaque Draw: {} ms", opaqueDrawTime);
+        Lit::Log::Debug("Occlusion Cull: {} ms", occlusionCullTime);
+        Lit::Log::Debug("Occlusion Sort: {} ms", occlusionSortTime);
+        Lit::Log::Debug("Occlusion Command Generation: {} ms", occlusionCommandGenTime);
+        Lit::Log::Debug("Occlusion Draw: {} ms", occlusionDrawTime);
         Lit::Log::Debug("Transparent Cull: {} ms", transparentCullTime);
         Lit::Log::Debug("Transparent Sort: {} ms", transparentSortTime);
         Lit::Log::Debug("Transparent Command Generation: {} ms", transparentCommandGenTime);
@@ -1872,6 +2356,58 @@ void Renderer::drawScene(SceneDatabase& sceneDatabase, const Camera& camera) {
     }
 }
 
+void Renderer::checkTransformReadback() {
+    m_transformReadbackFrame = -1;
+
+    void* pData = nullptr;
+    m_diligent->pImmediateContext->MapBuffer(m_diligent->pTransformReadbackBuffer, Diligent::MAP_READ, Diligent::MAP_FLAG_NONE, pData);
+    if (!pData) {
+        Lit::Log::Error("Failed to map the transform readback buffer.");
+        return;
+    }
+
+    const size_t count = m_transformReadbackCount;
+    const auto* gpuWorlds = static_cast<const WorldTransform*>(pData);
+    const auto* gpuNormals = gpuWorlds + count;
+    const auto* gpuBounds = reinterpret_cast<const glm::vec4*>(gpuNormals + count);
+
+    size_t mismatches = 0;
+    for (const Entity entity : m_validationEntities) {
+        struct Field {
+            const char* name;
+            const float* gpu;
+            const float* cpu;
+            size_t size;
+        };
+        const Field fields[] = {
+            {"world transform", &gpuWorlds[entity].rows[0].x, &m_validationWorldTransforms[entity].rows[0].x, 12},
+            {"normal matrix", &gpuNormals[entity].rows[0].x, &m_validationNormalMatrices[entity].rows[0].x, 12},
+            {"bounds", &gpuBounds[entity].x, &m_validationWorldBounds[entity].x, 4},
+        };
+
+        bool matches = true;
+        for (const Field& field : fields) {
+            const float error = maxRelativeError(field.gpu, field.cpu, field.size);
+            if (error <= TRANSFORM_VALIDATION_TOLERANCE) {
+                continue;
+            }
+            if (mismatches < MAX_LOGGED_TRANSFORM_MISMATCHES) {
+                Lit::Log::Warn("Transform validation: entity {} {} is off by {} from the CPU reference.", entity, field.name, error);
+            }
+            matches = false;
+        }
+        mismatches += matches ? 0 : 1;
+    }
+
+    m_diligent->pImmediateContext->UnmapBuffer(m_diligent->pTransformReadbackBuffer, Diligent::MAP_READ);
+
+    if (mismatches > 0) {
+        Lit::Log::Warn("Transform validation: {} of {} entities differ from the CPU reference.", mismatches, m_validationEntities.size());
+    } else {
+        Lit::Log::Debug("Transform validation: {} entities match the CPU reference.", m_validationEntities.size());
+    }
+}
+
 void Renderer::AddText(const std::string& text, float x, float y, float scale, const glm::vec3& color) {
     m_uiManager->addText(text, x, y, scale, color);
 }
@@ -1962,79 +2498,28 @@ void Renderer::createTransparentCullPSO() {
     PSODesc.PSODesc.ResourceLayout.DefaultVariableType = Diligent::SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE;
 
     std::vector<Diligent::ShaderResourceVariableDesc> Vars = {
+        {Diligent::SHADER_TYPE_COMPUTE, "SceneData", Diligent::SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE},
         {Diligent::SHADER_TYPE_COMPUTE, "TransparentCullUniforms", Diligent::SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE},
+        {Diligent::SHADER_TYPE_COMPUTE, "SortKeyConstants", Diligent::SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE},
         {Diligent::SHADER_TYPE_COMPUTE, "AtomicCounterBuffer", Diligent::SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE},
-        {Diligent::SHADER_TYPE_COMPUTE, "VisibleTransparentObjectBuffer", Diligent::SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE},
-        {Diligent::SHADER_TYPE_COMPUTE, "ObjectBuffer", Diligent::SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE},
-        {Diligent::SHADER_TYPE_COMPUTE, "MeshInfoBuffer", Diligent::SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE},
+        {Diligent::SHADER_TYPE_COMPUTE, "SortKeyBuffer", Diligent::SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE},
+        {Diligent::SHADER_TYPE_COMPUTE, "SortValueBuffer", Diligent::SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE},
+        {Diligent::SHADER_TYPE_COMPUTE, "BoundsBuffer", Diligent::SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE},
         {Diligent::SHADER_TYPE_COMPUTE, "RenderableBuffer", Diligent::SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE}};
-    PSODesc.PSODesc.ResourceLayout.Variables = Vars.data();
-    PSODesc.PSODesc.ResourceLayout.NumVariables = Vars.size();
-
-    m_diligent->pTransparentCullPSO.Release();
-    m_diligent->pDevice->CreateComputePipelineState(PSODesc, &m_diligent->pTransparentCullPSO);
-    if (!m_diligent->pTransparentCullPSO) {
-        Lit::Log::Error("Failed to create Transparent Cull PSO");
-    } else {
-        m_diligent->pTransparentCullPSO->CreateShaderResourceBinding(&m_diligent->pTransparentCullSRB, true);
-    }
-}
-
-void Renderer::createTransparentSortPSO() {
-    std::string source = LoadSourceFromFile("resources/shaders/bitonic_sort.comp");
-    if (source.empty()) {
-        Lit::Log::Error("Failed to load transparent sort compute shader source.");
-        return;
-    }
-
-    size_t versionPos = source.find("#version");
-    if (versionPos != std::string::npos) {
-        size_t nextLine = source.find('\n', versionPos);
-        if (nextLine != std::string::npos) {
-            source = source.substr(nextLine + 1);
-        }
-    }
-
-    Diligent::ShaderCreateInfo ShaderCI;
-    ShaderCI.Source = source.c_str();
-    ShaderCI.Desc.ShaderType = Diligent::SHADER_TYPE_COMPUTE;
-    ShaderCI.Desc.Name = "Transparent Sort CS";
-    ShaderCI.SourceLanguage = Diligent::SHADER_SOURCE_LANGUAGE_GLSL;
-    ShaderCI.Desc.UseCombinedTextureSamplers = true;
-
-    Diligent::RefCntAutoPtr<Diligent::IShader> pCS;
-    m_diligent->pDevice->CreateShader(ShaderCI, &pCS);
-    if (!pCS) {
-        Lit::Log::Error("Failed to create transparent sort shader");
-        return;
-    }
-
-    Diligent::ComputePipelineStateCreateInfo PSODesc;
-    PSODesc.PSODesc.Name = "Transparent Sort PSO";
-    PSODesc.PSODesc.PipelineType = Diligent::PIPELINE_TYPE_COMPUTE;
-    PSODesc.pCS = pCS;
-
-    PSODesc.PSODesc.ResourceLayout.DefaultVariableType = Diligent::SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE;
-
-    std::vector<Diligent::ShaderResourceVariableDesc> Vars = {
-        {Diligent::SHADER_TYPE_COMPUTE, "SortConstants", Diligent::SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE},
-        {Diligent::SHADER_TYPE_COMPUTE, "VisibleTransparentObjectBuffer", Diligent::SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE}};
-    PSODesc.PSODesc.ResourceLayout.Variables = Vars.data();
-    PSODesc.PSODesc.ResourceLayout.NumVariables = Vars.size();
-
-    m_diligent->pTransparentSortPSO.Release();
-    m_diligent->pDevice->CreateComputePipelineState(PSODesc, &m_diligent->pTransparentSortPSO);
-    if (!m_diligent->pTransparentSortPSO) {
-        Lit::Log::Error("Failed to create Transparent Sort PSO");
-    } else {
-        m_diligent->pTransparentSortPSO->CreateShaderResourceBinding(&m_diligent->pTransparentSortSRB, true);
+    PSODesc.PSODesc.ResourceLayout.Variables = Vars.data();
+    PSODesc.PSODesc.ResourceLayout.NumVariables = Vars.size();
+
+    m_diligent->pTransparentCullPSO.Release();
+    m_diligent->pDevice->CreateComputePipelineState(PSODesc, &m_diligent->pTransparentCullPSO);
+    if (!m_diligent->pTransparentCullPSO) {
+        Lit::Log::Error("Failed to create Transparent Cull PSO");
     }
 }
 
-void Renderer::createTransparentCommandGenPSO() {
-    std::string source = LoadSourceFromFile("resources/shaders/transparent_command_gen.comp");
+void Renderer::createTransparentSortPSO() {
+    std::string source = LoadSourceFromFile("resources/shaders/transparent_sort.comp");
     if (source.empty()) {
-        Lit::Log::Error("Failed to load transparent command gen compute shader source.");
+        Lit::Log::Error("Failed to load transparent sort compute shader source.");
         return;
     }
 
@@ -2049,46 +2534,43 @@ void Renderer::createTransparentCommandGenPSO() {
     Diligent::ShaderCreateInfo ShaderCI;
     ShaderCI.Source = source.c_str();
     ShaderCI.Desc.ShaderType = Diligent::SHADER_TYPE_COMPUTE;
-    ShaderCI.Desc.Name = "Transparent Command Gen CS";
+    ShaderCI.Desc.Name = "Transparent Sort CS";
     ShaderCI.SourceLanguage = Diligent::SHADER_SOURCE_LANGUAGE_GLSL;
     ShaderCI.Desc.UseCombinedTextureSamplers = true;
 
     Diligent::RefCntAutoPtr<Diligent::IShader> pCS;
     m_diligent->pDevice->CreateShader(ShaderCI, &pCS);
     if (!pCS) {
-        Lit::Log::Error("Failed to create transparent command gen shader");
+        Lit::Log::Error("Failed to create transparent sort shader");
         return;
     }
 
     Diligent::ComputePipelineStateCreateInfo PSODesc;
-    PSODesc.PSODesc.Name = "Transparent Command Gen PSO";
+    PSODesc.PSODesc.Name = "Transparent Sort PSO";
     PSODesc.PSODesc.PipelineType = Diligent::PIPELINE_TYPE_COMPUTE;
     PSODesc.pCS = pCS;
 
     PSODesc.PSODesc.ResourceLayout.DefaultVariableType = Diligent::SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE;
 
     std::vector<Diligent::ShaderResourceVariableDesc> Vars = {
-        {Diligent::SHADER_TYPE_COMPUTE, "TransparentCommandGenUniforms", Diligent::SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE},
+        {Diligent::SHADER_TYPE_COMPUTE, "SortConstants", Diligent::SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE},
+        {Diligent::SHADER_TYPE_COMPUTE, "TransparentCountBuffer", Diligent::SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE},
         {Diligent::SHADER_TYPE_COMPUTE, "VisibleTransparentObjectBuffer", Diligent::SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE},
-        {Diligent::SHADER_TYPE_COMPUTE, "MeshInfoBuffer", Diligent::SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE},
-        {Diligent::SHADER_TYPE_COMPUTE, "RenderableBuffer", Diligent::SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE},
-        {Diligent::SHADER_TYPE_COMPUTE, "TransparentDrawCommandBuffer", Diligent::SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE}};
+        {Diligent::SHADER_TYPE_COMPUTE, "SortValueBuffer", Diligent::SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE}};
     PSODesc.PSODesc.ResourceLayout.Variables = Vars.data();
     PSODesc.PSODesc.ResourceLayout.NumVariables = Vars.size();
 
-    m_diligent->pTransparentCommandGenPSO.Release();
-    m_diligent->pDevice->CreateComputePipelineState(PSODesc, &m_diligent->pTransparentCommandGenPSO);
-    if (!m_diligent->pTransparentCommandGenPSO) {
-        Lit::Log::Error("Failed to create Transparent Command Gen PSO");
-    } else {
-        m_diligent->pTransparentCommandGenPSO->CreateShaderResourceBinding(&m_diligent->pTransparentCommandGenSRB, true);
+    m_diligent->pTransparentSortPSO.Release();
+    m_diligent->pDevice->CreateComputePipelineState(PSODesc, &m_diligent->pTransparentSortPSO);
+    if (!m_diligent->pTransparentSortPSO) {
+        Lit::Log::Error("Failed to create Transparent Sort PSO");
     }
 }
 
-void Renderer::createLargeObjectCommandGenPSO() {
-    std::string source = LoadSourceFromFile("resources/shaders/large_object_command_gen.comp");
+void Renderer::createTransparentCommandGenPSO() {
+    std::string source = LoadSourceFromFile("resources/shaders/transparent_command_gen.comp");
     if (source.empty()) {
-        Lit::Log::Error("Failed to load large object command gen compute shader source.");
+        Lit::Log::Error("Failed to load transparent command gen compute shader source.");
         return;
     }
 
@@ -2103,132 +2585,46 @@ void Renderer::createLargeObjectCommandGenPSO() {
     Diligent::ShaderCreateInfo ShaderCI;
     ShaderCI.Source = source.c_str();
     ShaderCI.Desc.ShaderType = Diligent::SHADER_TYPE_COMPUTE;
-    ShaderCI.Desc.Name = "Large Object Command Gen CS";
+    ShaderCI.Desc.Name = "Transparent Command Gen CS";
     ShaderCI.SourceLanguage = Diligent::SHADER_SOURCE_LANGUAGE_GLSL;
     ShaderCI.Desc.UseCombinedTextureSamplers = true;
 
     Diligent::RefCntAutoPtr<Diligent::IShader> pCS;
     m_diligent->pDevice->CreateShader(ShaderCI, &pCS);
     if (!pCS) {
-        Lit::Log::Error("Failed to create large object command gen shader");
+        Lit::Log::Error("Failed to create transparent command gen shader");
         return;
     }
 
     Diligent::ComputePipelineStateCreateInfo PSODesc;
-    PSODesc.PSODesc.Name = "Large Object Command Gen PSO";
+    PSODesc.PSODesc.Name = "Transparent Command Gen PSO";
     PSODesc.PSODesc.PipelineType = Diligent::PIPELINE_TYPE_COMPUTE;
     PSODesc.pCS = pCS;
 
     PSODesc.PSODesc.ResourceLayout.DefaultVariableType = Diligent::SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE;
 
     std::vector<Diligent::ShaderResourceVariableDesc> Vars = {
-        {Diligent::SHADER_TYPE_COMPUTE, "LargeObjectCommandGenUniforms", Diligent::SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE},
-        {Diligent::SHADER_TYPE_COMPUTE, "AtomicCounterBuffer", Diligent::SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE},
-        {Diligent::SHADER_TYPE_COMPUTE, "DrawCommandBuffer", Diligent::SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE},
+        {Diligent::SHADER_TYPE_COMPUTE, "TransparentCountBuffer", Diligent::SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE},
+        {Diligent::SHADER_TYPE_COMPUTE, "VisibleTransparentObjectBuffer", Diligent::SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE},
         {Diligent::SHADER_TYPE_COMPUTE, "MeshInfoBuffer", Diligent::SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE},
         {Diligent::SHADER_TYPE_COMPUTE, "RenderableBuffer", Diligent::SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE},
-        {Diligent::SHADER_TYPE_COMPUTE, "VisibleLargeObjectBuffer", Diligent::SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE}};
+        {Diligent::SHADER_TYPE_COMPUTE, "TransparentDrawCommandBuffer", Diligent::SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE},
+        {Diligent::SHADER_TYPE_COMPUTE, "ObjectBuffer", Diligent::SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE},
+        {Diligent::SHADER_TYPE_COMPUTE, "NormalMatrixBuffer", Diligent::SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE},
+        {Diligent::SHADER_TYPE_COMPUTE, "InstanceBuffer", Diligent::SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE}};
     PSODesc.PSODesc.ResourceLayout.Variables = Vars.data();
     PSODesc.PSODesc.ResourceLayout.NumVariables = Vars.size();
 
-    m_diligent->pLargeObjectCommandGenPSO.Release();
-    m_diligent->pDevice->CreateComputePipelineState(PSODesc, &m_diligent->pLargeObjectCommandGenPSO);
-    if (!m_diligent->pLargeObjectCommandGenPSO) {
-        Lit::Log::Error("Failed to create Large Object Command Gen PSO");
-    } else {
-        m_diligent->pLargeObjectCommandGenPSO->CreateShaderResourceBinding(&m_diligent->pLargeObjectCommandGenSRB, true);
-    }
-}
-
-void Renderer::createDepthPrepassPSO() {
-    Diligent::GraphicsPipelineStateCreateInfo PSOCreateInfo;
-    PSOCreateInfo.PSODesc.Name = "Depth Prepass PSO";
-    PSOCreateInfo.PSODesc.PipelineType = Diligent::PIPELINE_TYPE_GRAPHICS;
-    PSOCreateInfo.GraphicsPipeline.NumRenderTargets = 1;
-    PSOCreateInfo.GraphicsPipeline.RTVFormats[0] = Diligent::TEX_FORMAT_R32_FLOAT;
-    PSOCreateInfo.GraphicsPipeline.DSVFormat = Diligent::TEX_FORMAT_D32_FLOAT;
-    PSOCreateInfo.GraphicsPipeline.PrimitiveTopology = Diligent::PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
-    PSOCreateInfo.GraphicsPipeline.RasterizerDesc.CullMode = Diligent::CULL_MODE_BACK;
-    PSOCreateInfo.GraphicsPipeline.RasterizerDesc.FrontCounterClockwise = true;
-    PSOCreateInfo.GraphicsPipeline.DepthStencilDesc.DepthEnable = true;
-    PSOCreateInfo.GraphicsPipeline.DepthStencilDesc.DepthWriteEnable = true;
-
-    Diligent::ShaderCreateInfo ShaderCI;
-    ShaderCI.SourceLanguage = Diligent::SHADER_SOURCE_LANGUAGE_GLSL;
-    ShaderCI.Desc.UseCombinedTextureSamplers = true;
-
-    std::string vertSource = LoadSourceFromFile("resources/shaders/depth_prepass.vert");
-    std::string fragSource = LoadSourceFromFile("resources/shaders/depth_prepass.frag");
-
-    Diligent::RefCntAutoPtr<Diligent::IShader> pVS;
-    {
-        ShaderCI.Desc.ShaderType = Diligent::SHADER_TYPE_VERTEX;
-        ShaderCI.Desc.Name = "Depth Prepass VS";
-        size_t versionPos = vertSource.find("#version");
-        if (versionPos != std::string::npos) {
-            size_t nextLine = vertSource.find('\n', versionPos);
-            if (nextLine != std::string::npos)
-                vertSource = vertSource.substr(nextLine + 1);
-        }
-        ShaderCI.Source = vertSource.c_str();
-        m_diligent->pDevice->CreateShader(ShaderCI, &pVS);
-        if (!pVS) {
-            Lit::Log::Error("Failed to create Depth Prepass VS");
-            return;
-        }
-    }
-
-    Diligent::RefCntAutoPtr<Diligent::IShader> pPS;
-    {
-        ShaderCI.Desc.ShaderType = Diligent::SHADER_TYPE_PIXEL;
-        ShaderCI.Desc.Name = "Depth Prepass PS";
-        size_t versionPos = fragSource.find("#version");
-        if (versionPos != std::string::npos) {
-            size_t nextLine = fragSource.find('\n', versionPos);
-            if (nextLine != std::string::npos)
-                fragSource = fragSource.substr(nextLine + 1);
-        }
-        ShaderCI.Source = fragSource.c_str();
-        m_diligent->pDevice->CreateShader(ShaderCI, &pPS);
-        if (!pPS) {
-            Lit::Log::Error("Failed to create Depth Prepass PS");
-            return;
-        }
-    }
-
-    PSOCreateInfo.pVS = pVS;
-    PSOCreateInfo.pPS = pPS;
-
-    Diligent::LayoutElement LayoutElems[] = {
-        Diligent::LayoutElement{0, 0, 3, Diligent::VT_FLOAT32, false},
-        Diligent::LayoutElement{1, 0, 3, Diligent::VT_FLOAT32, false}};
-    PSOCreateInfo.GraphicsPipeline.InputLayout.LayoutElements = LayoutElems;
-    PSOCreateInfo.GraphicsPipeline.InputLayout.NumElements = _countof(LayoutElems);
-
-    PSOCreateInfo.PSODesc.ResourceLayout.DefaultVariableType = Diligent::SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE;
-
-    std::vector<Diligent::ShaderResourceVariableDesc> Vars = {
-        {Diligent::SHADER_TYPE_VERTEX, "SceneData", Diligent::SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE},
-        {Diligent::SHADER_TYPE_VERTEX, "ObjectBuffer", Diligent::SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE},
-        {Diligent::SHADER_TYPE_VERTEX, "VisibleLargeObjectBuffer", Diligent::SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE}};
-    PSOCreateInfo.PSODesc.ResourceLayout.Variables = Vars.data();
-    PSOCreateInfo.PSODesc.ResourceLayout.NumVariables = Vars.size();
-
-    m_diligent->pDepthPrepassPSO.Release();
-    m_diligent->pDevice->CreateGraphicsPipelineState(PSOCreateInfo, &m_diligent->pDepthPrepassPSO);
-
-    if (!m_diligent->pDepthPrepassPSO) {
-        Lit::Log::Error("Failed to create Depth Prepass PSO");
-    } else {
-        m_diligent->pDepthPrepassPSO->CreateShaderResourceBinding(&m_diligent->pDepthPrepassSRB, true);
+    m_diligent->pTransparentCommandGenPSO.Release();
+    m_diligent->pDevice->CreateComputePipelineState(PSODesc, &m_diligent->pTransparentCommandGenPSO);
+    if (!m_diligent->pTransparentCommandGenPSO) {
+        Lit::Log::Error("Failed to create Transparent Command Gen PSO");
     }
 }
 
 void Renderer::createOpaquePSOs() {
     m_diligent->pOpaquePSOs.clear();
 
-    m_diligent->pOpaqueSRBs.clear();
-
     struct ShaderInfo {
         std::string vert;
         std::string frag;
@@ -2240,7 +2636,6 @@ void Renderer::createOpaquePSOs() {
         {"resources/shaders/cube.vert", "resources/shaders/transparent.frag", "Transparent Proxy PSO"}};
 
     m_diligent->pOpaquePSOs.resize(shaderInfos.size());
-    m_diligent->pOpaqueSRBs.resize(shaderInfos.size());
 
     for (size_t i = 0; i < shaderInfos.size(); ++i) {
         Diligent::GraphicsPipelineStateCreateInfo PSOCreateInfo;
@@ -2249,7 +2644,7 @@ void Renderer::createOpaquePSOs() {
         PSOCreateInfo.GraphicsPipeline.NumRenderTargets = 1;
 
         PSOCreateInfo.GraphicsPipeline.RTVFormats[0] = Diligent::TEX_FORMAT_RGBA8_UNORM;
-        PSOCreateInfo.GraphicsPipeline.DSVFormat = Diligent::TEX_FORMAT_D24_UNORM_S8_UINT;
+        PSOCreateInfo.GraphicsPipeline.DSVFormat = Diligent::TEX_FORMAT_D32_FLOAT;
         PSOCreateInfo.GraphicsPipeline.PrimitiveTopology = Diligent::PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
         PSOCreateInfo.GraphicsPipeline.RasterizerDesc.CullMode = Diligent::CULL_MODE_BACK;
         PSOCreateInfo.GraphicsPipeline.RasterizerDesc.FrontCounterClockwise = true;
@@ -2299,9 +2694,10 @@ void Renderer::createOpaquePSOs() {
         PSOCreateInfo.pVS = pVS;
         PSOCreateInfo.pPS = pPS;
 
+        // PackedVertex: quantised position and octahedral normal, decoded in cube.vert.
         Diligent::LayoutElement LayoutElems[] = {
-            Diligent::LayoutElement{0, 0, 3, Diligent::VT_FLOAT32, false},
-            Diligent::LayoutElement{1, 0, 3, Diligent::VT_FLOAT32, false}};
+            Diligent::LayoutElement{0, 0, 4, Diligent::VT_UINT16, true},
+            Diligent::LayoutElement{1, 0, 2, Diligent::VT_INT16, true}};
         PSOCreateInfo.GraphicsPipeline.InputLayout.LayoutElements = LayoutElems;
         PSOCreateInfo.GraphicsPipeline.InputLayout.NumElements = _countof(LayoutElems);
 
@@ -2309,8 +2705,10 @@ void Renderer::createOpaquePSOs() {
 
         std::vector<Diligent::ShaderResourceVariableDesc> Vars = {
             {Diligent::SHADER_TYPE_VERTEX, "SceneData", Diligent::SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE},
-            {Diligent::SHADER_TYPE_VERTEX, "ObjectBuffer", Diligent::SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE},
-            {Diligent::SHADER_TYPE_VERTEX, "VisibleObjectBuffer", Diligent::SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE}};
+            {Diligent::SHADER_TYPE_VERTEX, "InstanceBuffer", Diligent::SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE},
+            {Diligent::SHADER_TYPE_PIXEL, "LightBuffer", Diligent::SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE},
+            {Diligent::SHADER_TYPE_PIXEL, "FroxelLightCountBuffer", Diligent::SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE},
+            {Diligent::SHADER_TYPE_PIXEL, "FroxelLightIndexBuffer", Diligent::SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE}};
         PSOCreateInfo.PSODesc.ResourceLayout.Variables = Vars.data();
         PSOCreateInfo.PSODesc.ResourceLayout.NumVariables = Vars.size();
 
@@ -2319,15 +2717,12 @@ void Renderer::createOpaquePSOs() {
 
         if (!m_diligent->pOpaquePSOs[i]) {
             Lit::Log::Error("Failed to create Opaque PSO: {}", shaderInfos[i].name);
-        } else {
-            m_diligent->pOpaquePSOs[i]->CreateShaderResourceBinding(&m_diligent->pOpaqueSRBs[i], true);
         }
     }
 }
 
 void Renderer::createTransparentPSO() {
     m_diligent->pTransparentPSO.Release();
-    m_diligent->pTransparentSRB.Release();
 
     Diligent::GraphicsPipelineStateCreateInfo PSOCreateInfo;
     PSOCreateInfo.PSODesc.Name = "Transparent PSO";
@@ -2335,7 +2730,7 @@ void Renderer::createTransparentPSO() {
     PSOCreateInfo.GraphicsPipeline.NumRenderTargets = 1;
 
     PSOCreateInfo.GraphicsPipeline.RTVFormats[0] = Diligent::TEX_FORMAT_RGBA8_UNORM;
-    PSOCreateInfo.GraphicsPipeline.DSVFormat = Diligent::TEX_FORMAT_D24_UNORM_S8_UINT;
+    PSOCreateInfo.GraphicsPipeline.DSVFormat = Diligent::TEX_FORMAT_D32_FLOAT;
     PSOCreateInfo.GraphicsPipeline.PrimitiveTopology = Diligent::PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
     PSOCreateInfo.GraphicsPipeline.RasterizerDesc.CullMode = Diligent::CULL_MODE_BACK;
 
@@ -2396,8 +2791,8 @@ void Renderer::createTransparentPSO() {
     PSOCreateInfo.pPS = pPS;
 
     Diligent::LayoutElement LayoutElems[] = {
-        Diligent::LayoutElement{0, 0, 3, Diligent::VT_FLOAT32, false},
-        Diligent::LayoutElement{1, 0, 3, Diligent::VT_FLOAT32, false}};
+        Diligent::LayoutElement{0, 0, 4, Diligent::VT_UINT16, true},
+        Diligent::LayoutElement{1, 0, 2, Diligent::VT_INT16, true}};
     PSOCreateInfo.GraphicsPipeline.InputLayout.LayoutElements = LayoutElems;
     PSOCreateInfo.GraphicsPipeline.InputLayout.NumElements = _countof(LayoutElems);
 
@@ -2405,35 +2800,107 @@ void Renderer::createTransparentPSO() {
 
     std::vector<Diligent::ShaderResourceVariableDesc> Vars = {
         {Diligent::SHADER_TYPE_VERTEX, "SceneData", Diligent::SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE},
-        {Diligent::SHADER_TYPE_VERTEX, "ObjectBuffer", Diligent::SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE},
-        {Diligent::SHADER_TYPE_VERTEX, "VisibleObjectBuffer", Diligent::SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE}};
+        {Diligent::SHADER_TYPE_VERTEX, "InstanceBuffer", Diligent::SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE},
+        {Diligent::SHADER_TYPE_PIXEL, "LightBuffer", Diligent::SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE},
+        {Diligent::SHADER_TYPE_PIXEL, "FroxelLightCountBuffer", Diligent::SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE},
+        {Diligent::SHADER_TYPE_PIXEL, "FroxelLightIndexBuffer", Diligent::SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE}};
     PSOCreateInfo.PSODesc.ResourceLayout.Variables = Vars.data();
     PSOCreateInfo.PSODesc.ResourceLayout.NumVariables = Vars.size();
 
     m_diligent->pDevice->CreateGraphicsPipelineState(PSOCreateInfo, &m_diligent->pTransparentPSO);
 
-    if (m_diligent->pTransparentPSO) {
-        m_diligent->pTransparentPSO->CreateShaderResourceBinding(&m_diligent->pTransparentSRB, true);
-    } else {
+    if (!m_diligent->pTransparentPSO) {
         Lit::Log::Error("Failed to create Transparent PSO");
     }
 }
 
-void Renderer::createHiZPSO() {
+void Renderer::createPresentPSO() {
+    m_diligent->pPresentPSO.Release();
+    m_diligent->pPresentSRB.Release();
+
+    Diligent::GraphicsPipelineStateCreateInfo PSOCreateInfo;
+    PSOCreateInfo.PSODesc.Name = "Present PSO";
+    PSOCreateInfo.PSODesc.PipelineType = Diligent::PIPELINE_TYPE_GRAPHICS;
+    PSOCreateInfo.GraphicsPipeline.NumRenderTargets = 1;
+    PSOCreateInfo.GraphicsPipeline.RTVFormats[0] = Diligent::TEX_FORMAT_RGBA8_UNORM;
+    PSOCreateInfo.GraphicsPipeline.DSVFormat = Diligent::TEX_FORMAT_D24_UNORM_S8_UINT;
+    PSOCreateInfo.GraphicsPipeline.PrimitiveTopology = Diligent::PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+    PSOCreateInfo.GraphicsPipeline.RasterizerDesc.CullMode = Diligent::CULL_MODE_NONE;
+    PSOCreateInfo.GraphicsPipeline.DepthStencilDesc.DepthEnable = false;
+
+    Diligent::ShaderCreateInfo ShaderCI;
+    ShaderCI.SourceLanguage = Diligent::SHADER_SOURCE_LANGUAGE_GLSL;
+    ShaderCI.Desc.UseCombinedTextureSamplers = true;
+
+    std::string vertSource = LoadSourceFromFile("resources/shaders/present.vert");
+    std::string fragSource = LoadSourceFromFile("resources/shaders/present.frag");
+
+    Diligent::RefCntAutoPtr<Diligent::IShader> pVS;
+    {
+        ShaderCI.Desc.ShaderType = Diligent::SHADER_TYPE_VERTEX;
+        ShaderCI.Desc.Name = "Present VS";
+        size_t versionPos = vertSource.find("#version");
+        if (versionPos != std::string::npos) {
+            size_t nextLine = vertSource.find('\n', versionPos);
+            if (nextLine != std::string::npos)
+                vertSource = vertSource.substr(nextLine + 1);
+        }
+        ShaderCI.Source = vertSource.c_str();
+        m_diligent->pDevice->CreateShader(ShaderCI, &pVS);
+    }
+
+    Diligent::RefCntAutoPtr<Diligent::IShader> pPS;
+    {
+        ShaderCI.Desc.ShaderType = Diligent::SHADER_TYPE_PIXEL;
+        ShaderCI.Desc.Name = "Present PS";
+        size_t versionPos = fragSource.find("#version");
+        if (versionPos != std::string::npos) {
+            size_t nextLine = fragSource.find('\n', versionPos);
+            if (nextLine != std::string::npos)
+                fragSource = fragSource.substr(nextLine + 1);
+        }
+        ShaderCI.Source = fragSource.c_str();
+        m_diligent->pDevice->CreateShader(ShaderCI, &pPS);
+    }
+
+    if (!pVS || !pPS) {
+        Lit::Log::Error("Failed to create Present shaders");
+        return;
+    }
+
+    PSOCreateInfo.pVS = pVS;
+    PSOCreateInfo.pPS = pPS;
+
+    Diligent::ShaderResourceVariableDesc Vars[] = {
+        {Diligent::SHADER_TYPE_PIXEL, "u_sceneColor", Diligent::SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE}};
+    PSOCreateInfo.PSODesc.ResourceLayout.Variables = Vars;
+    PSOCreateInfo.PSODesc.ResourceLayout.NumVariables = _countof(Vars);
+
+    m_diligent->pDevice->CreateGraphicsPipelineState(PSOCreateInfo, &m_diligent->pPresentPSO);
+
+    if (m_diligent->pPresentPSO) {
+        m_diligent->pPresentPSO->CreateShaderResourceBinding(&m_diligent->pPresentSRB, true);
+    } else {
+        Lit::Log::Error("Failed to create Present PSO");
+    }
+}
+
+void Renderer::createHiZDownsamplePSO() {
     Diligent::ComputePipelineStateCreateInfo PSOCreateInfo;
-    PSOCreateInfo.PSODesc.Name = "Hi-Z Mipmap PSO";
+    PSOCreateInfo.PSODesc.Name = "Hi-Z Downsample PSO";
     PSOCreateInfo.PSODesc.PipelineType = Diligent::PIPELINE_TYPE_COMPUTE;
 
     Diligent::ShaderResourceVariableDesc Vars[] = {
-        {Diligent::SHADER_TYPE_COMPUTE, "u_sourceMip", Diligent::SHADER_RESOURCE_VARIABLE_TYPE_DYNAMIC},
-        {Diligent::SHADER_TYPE_COMPUTE, "u_destMip", Diligent::SHADER_RESOURCE_VARIABLE_TYPE_DYNAMIC}};
+        {Diligent::SHADER_TYPE_COMPUTE, "u_depthTexture", Diligent::SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE},
+        {Diligent::SHADER_TYPE_COMPUTE, "u_hizMips", Diligent::SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE},
+        {Diligent::SHADER_TYPE_COMPUTE, "DownsampleCounterBuffer", Diligent::SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE}};
 
     PSOCreateInfo.PSODesc.ResourceLayout.Variables = Vars;
     PSOCreateInfo.PSODesc.ResourceLayout.NumVariables = _countof(Vars);
 
-    std::string source = LoadSourceFromFile("resources/shaders/hiz_mipmap.comp");
+    std::string source = LoadSourceFromFile("resources/shaders/hiz_downsample.comp");
     if (source.empty()) {
-        Lit::Log::Error("Failed to load Hi-Z Mipmap compute shader source.");
+        Lit::Log::Error("Failed to load Hi-Z Downsample compute shader source.");
         return;
     }
 
@@ -2444,28 +2911,42 @@ void Renderer::createHiZPSO() {
             source = source.substr(nextLine + 1);
         }
     }
+    source = "#define HIZ_MIP_COUNT " + std::to_string(m_hizMipCount) + "\n" + source;
 
     Diligent::ShaderCreateInfo ShaderCI;
     ShaderCI.Source = source.c_str();
     ShaderCI.SourceLanguage = Diligent::SHADER_SOURCE_LANGUAGE_GLSL;
     ShaderCI.Desc.UseCombinedTextureSamplers = true;
     ShaderCI.Desc.ShaderType = Diligent::SHADER_TYPE_COMPUTE;
-    ShaderCI.Desc.Name = "Hi-Z Mipmap CS";
+    ShaderCI.Desc.Name = "Hi-Z Downsample CS";
 
     Diligent::RefCntAutoPtr<Diligent::IShader> pCS;
     m_diligent->pDevice->CreateShader(ShaderCI, &pCS);
     if (!pCS) {
-        Lit::Log::Error("Failed to create Hi-Z Mipmap shader.");
+        Lit::Log::Error("Failed to create Hi-Z Downsample shader.");
         return;
     }
     PSOCreateInfo.pCS = pCS;
 
-    m_diligent->pDevice->CreateComputePipelineState(PSOCreateInfo, &m_diligent->pHiZMipmapPSO);
-    if (!m_diligent->pHiZMipmapPSO) {
-        Lit::Log::Error("Failed to create Hi-Z Mipmap PSO.");
+    m_diligent->pDevice->CreateComputePipelineState(PSOCreateInfo, &m_diligent->pHiZDownsamplePSO);
+    if (!m_diligent->pHiZDownsamplePSO) {
+        Lit::Log::Error("Failed to create Hi-Z Downsample PSO.");
         return;
     }
-    m_diligent->pHiZMipmapPSO->CreateShaderResourceBinding(&m_diligent->pHiZMipmapSRB, true);
+
+    for (int i = 0; i < NUM_FRAMES_IN_FLIGHT; ++i) {
+        auto& pSRB = m_diligent->pHiZDownsampleSRBs[i];
+        pSRB.Release();
+        m_diligent->pHiZDownsamplePSO->CreateShaderResourceBinding(&pSRB, true);
+
+        Diligent::IDeviceObject* pMipViews[HIZ_MAX_MIP_COUNT] = {};
+        for (int mip = 0; mip < m_hizMipCount; ++mip) {
+            pMipViews[mip] = m_diligent->pHiZMipViews[i][mip];
+        }
+        pSRB->GetVariableByName(Diligent::SHADER_TYPE_COMPUTE, "u_depthTexture")->Set(m_diligent->pDepthRenderbuffers[i]->GetDefaultView(Diligent::TEXTURE_VIEW_SHADER_RESOURCE));
+        pSRB->GetVariableByName(Diligent::SHADER_TYPE_COMPUTE, "u_hizMips")->SetArray(pMipViews, 0, m_hizMipCount);
+        pSRB->GetVariableByName(Diligent::SHADER_TYPE_COMPUTE, "DownsampleCounterBuffer")->Set(m_diligent->pHiZDownsampleCounter->GetDefaultView(Diligent::BUFFER_VIEW_UNORDERED_ACCESS));
+    }
 }
 
 void Renderer::createCullingPSO() {
@@ -2498,7 +2979,7 @@ void Renderer::createCullingPSO() {
     }
 
     Diligent::ShaderResourceVariableDesc Vars[] = {
-        {Diligent::SHADER_TYPE_COMPUTE, "u_hizTexture", Diligent::SHADER_RESOURCE_VARIABLE_TYPE_DYNAMIC}};
+        {Diligent::SHADER_TYPE_COMPUTE, "u_hizTexture", Diligent::SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE}};
 
     Diligent::ComputePipelineStateCreateInfo PSOCI;
     PSOCI.PSODesc.Name = "Culling compute PSO";
@@ -2522,63 +3003,61 @@ void Renderer::createCullingPSO() {
     m_diligent->pDevice->CreateBuffer(BuffDesc, nullptr, &m_diligent->pCullingUniforms);
 }
 
-void Renderer::createOpaqueSortPSO() {
-    std::string source = LoadSourceFromFile("resources/shaders/opaque_sort.comp");
+void Renderer::createClusterCullPSO() {
+    std::string source = LoadSourceFromFile("resources/shaders/cluster_cull.comp");
     if (source.empty()) {
-        Lit::Log::Error("Failed to load opaque sort compute shader source.");
+        Lit::Log::Error("Failed to load cluster culling compute shader source.");
         return;
     }
 
     size_t versionPos = source.find("#version");
     if (versionPos != std::string::npos) {
         size_t nextLine = source.find('\n', versionPos);
-        if (nextLine != std::string::npos)
+        if (nextLine != std::string::npos) {
             source = source.substr(nextLine + 1);
+        }
     }
 
     Diligent::ShaderCreateInfo ShaderCI;
     ShaderCI.Source = source.c_str();
     ShaderCI.SourceLanguage = Diligent::SHADER_SOURCE_LANGUAGE_GLSL;
+    ShaderCI.Desc.UseCombinedTextureSamplers = true;
     ShaderCI.Desc.ShaderType = Diligent::SHADER_TYPE_COMPUTE;
-    ShaderCI.Desc.Name = "Opaque Sort CS";
+    ShaderCI.Desc.Name = "Cluster culling compute shader";
 
     Diligent::RefCntAutoPtr<Diligent::IShader> pCS;
     m_diligent->pDevice->CreateShader(ShaderCI, &pCS);
-    if (!pCS)
+    if (!pCS) {
+        Lit::Log::Error("Failed to create cluster culling compute shader.");
         return;
+    }
 
     Diligent::ShaderResourceVariableDesc Vars[] = {
-        {Diligent::SHADER_TYPE_COMPUTE, "VisibleObjectBuffer", Diligent::SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE},
-        {Diligent::SHADER_TYPE_COMPUTE, "RenderableBuffer", Diligent::SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE},
-        {Diligent::SHADER_TYPE_COMPUTE, "SortConstants", Diligent::SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE}};
+        {Diligent::SHADER_TYPE_COMPUTE, "u_hizTexture", Diligent::SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE}};
 
     Diligent::ComputePipelineStateCreateInfo PSOCI;
-    PSOCI.PSODesc.Name = "Opaque Sort PSO";
+    PSOCI.PSODesc.Name = "Cluster culling compute PSO";
     PSOCI.PSODesc.PipelineType = Diligent::PIPELINE_TYPE_COMPUTE;
     PSOCI.pCS = pCS;
+    PSOCI.PSODesc.ResourceLayout.DefaultVariableType = Diligent::SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE;
     PSOCI.PSODesc.ResourceLayout.Variables = Vars;
     PSOCI.PSODesc.ResourceLayout.NumVariables = _countof(Vars);
 
-    m_diligent->pDevice->CreateComputePipelineState(PSOCI, &m_diligent->pOpaqueSortPSO);
-
-    Diligent::BufferDesc CBDesc;
-    CBDesc.Name = "Sort Constants";
-    CBDesc.Usage = Diligent::USAGE_DYNAMIC;
-    CBDesc.BindFlags = Diligent::BIND_UNIFORM_BUFFER;
-    CBDesc.CPUAccessFlags = Diligent::CPU_ACCESS_WRITE;
-    CBDesc.Size = sizeof(SortConstants);
-    m_diligent->pDevice->CreateBuffer(CBDesc, nullptr, &m_diligent->pOpaqueSortConstants);
-
-    m_diligent->pOpaqueSortPSO->CreateShaderResourceBinding(&m_diligent->pOpaqueSortSRB, true);
+    m_diligent->pDevice->CreateComputePipelineState(PSOCI, &m_diligent->pClusterCullPSO);
+    if (!m_diligent->pClusterCullPSO) {
+        Lit::Log::Error("Failed to create cluster culling compute PSO.");
+    }
+}
 
-    if (auto* var = m_diligent->pOpaqueSortSRB->GetVariableByName(Diligent::SHADER_TYPE_COMPUTE, "SortConstants"))
-        var->Set(m_diligent->pOpaqueSortConstants);
+void Renderer::createLightBinPSO() {
+    CreateComputePipeline(m_diligent->pDevice, "resources/shaders/light_bin.comp", "Light Bin", {"SceneData", "LightBuffer", "FroxelLightCountBuffer", "FroxelLightIndexBuffer"},
+                          m_diligent->pLightBinPSO);
 }
 
-void Renderer::createCommandGenPSO() {
-    std::string source = LoadSourceFromFile("resources/shaders/command_gen.comp");
+void Renderer::createOpaqueSortPSO() {
+    std::string source = LoadSourceFromFile("resources/shaders/opaque_sort.comp");
     if (source.empty()) {
-        Lit::Log::Error("Failed to load command generation compute shader source.");
+        Lit::Log::Error("Failed to load opaque sort compute shader source.");
         return;
     }
 
@@ -2593,7 +3072,7 @@ void Renderer::createCommandGenPSO() {
     ShaderCI.Source = source.c_str();
     ShaderCI.SourceLanguage = Diligent::SHADER_SOURCE_LANGUAGE_GLSL;
     ShaderCI.Desc.ShaderType = Diligent::SHADER_TYPE_COMPUTE;
-    ShaderCI.Desc.Name = "Command Gen CS";
+    ShaderCI.Desc.Name = "Opaque Sort CS";
 
     Diligent::RefCntAutoPtr<Diligent::IShader> pCS;
     m_diligent->pDevice->CreateShader(ShaderCI, &pCS);
@@ -2601,35 +3080,33 @@ void Renderer::createCommandGenPSO() {
         return;
 
     Diligent::ShaderResourceVariableDesc Vars[] = {
-        {Diligent::SHADER_TYPE_COMPUTE, "DrawAtomicCounterBuffer", Diligent::SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE},
-        {Diligent::SHADER_TYPE_COMPUTE, "DrawCommandBuffer", Diligent::SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE},
-        {Diligent::SHADER_TYPE_COMPUTE, "MeshInfoBuffer", Diligent::SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE},
-        {Diligent::SHADER_TYPE_COMPUTE, "RenderableBuffer", Diligent::SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE},
         {Diligent::SHADER_TYPE_COMPUTE, "VisibleObjectBuffer", Diligent::SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE},
-        {Diligent::SHADER_TYPE_COMPUTE, "CommandGenConstants", Diligent::SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE}};
+        {Diligent::SHADER_TYPE_COMPUTE, "VisibleObjectCountBuffer", Diligent::SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE},
+        {Diligent::SHADER_TYPE_COMPUTE, "SortConstants", Diligent::SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE},
+        {Diligent::SHADER_TYPE_COMPUTE, "SortValueBuffer", Diligent::SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE}};
 
     Diligent::ComputePipelineStateCreateInfo PSOCI;
-    PSOCI.PSODesc.Name = "Command Gen PSO";
+    PSOCI.PSODesc.Name = "Opaque Sort PSO";
     PSOCI.PSODesc.PipelineType = Diligent::PIPELINE_TYPE_COMPUTE;
     PSOCI.pCS = pCS;
     PSOCI.PSODesc.ResourceLayout.Variables = Vars;
     PSOCI.PSODesc.ResourceLayout.NumVariables = _countof(Vars);
 
-    m_diligent->pDevice->CreateComputePipelineState(PSOCI, &m_diligent->pCommandGenPSO);
+    m_diligent->pDevice->CreateComputePipelineState(PSOCI, &m_diligent->pOpaqueSortPSO);
 
     Diligent::BufferDesc CBDesc;
-    CBDesc.Name = "Command Gen Constants";
-    CBDesc.Usage = Diligent::USAGE_DYNAMIC;
+    CBDesc.Name = "Sort Constants";
+    CBDesc.Usage = Diligent::USAGE_DEFAULT;
     CBDesc.BindFlags = Diligent::BIND_UNIFORM_BUFFER;
-    CBDesc.CPUAccessFlags = Diligent::CPU_ACCESS_WRITE;
-    CBDesc.Size = sizeof(CommandGenUniforms);
-    m_diligent->pDevice->CreateBuffer(CBDesc, nullptr, &m_diligent->pCommandGenConstants);
+    CBDesc.CPUAccessFlags = Diligent::CPU_ACCESS_NONE;
+    CBDesc.Size = sizeof(SortConstants);
+    m_diligent->pDevice->CreateBuffer(CBDesc, nullptr, &m_diligent->pOpaqueSortConstants);
 }
 
-void Renderer::createLargeObjectCullPSO() {
-    std::string source = LoadSourceFromFile("resources/shaders/large_object_cull.comp");
+void Renderer::createCommandGenPSO() {
+    std::string source = LoadSourceFromFile("resources/shaders/command_gen.comp");
     if (source.empty()) {
-        Lit::Log::Error("Failed to load large object cull compute shader source.");
+        Lit::Log::Error("Failed to load command generation compute shader source.");
         return;
     }
 
@@ -2644,7 +3121,7 @@ void Renderer::createLargeObjectCullPSO() {
     ShaderCI.Source = source.c_str();
     ShaderCI.SourceLanguage = Diligent::SHADER_SOURCE_LANGUAGE_GLSL;
     ShaderCI.Desc.ShaderType = Diligent::SHADER_TYPE_COMPUTE;
-    ShaderCI.Desc.Name = "Large Object Cull CS";
+    ShaderCI.Desc.Name = "Command Gen CS";
 
     Diligent::RefCntAutoPtr<Diligent::IShader> pCS;
     m_diligent->pDevice->CreateShader(ShaderCI, &pCS);
@@ -2652,36 +3129,44 @@ void Renderer::createLargeObjectCullPSO() {
         return;
 
     Diligent::ShaderResourceVariableDesc Vars[] = {
-        {Diligent::SHADER_TYPE_COMPUTE, "SceneUniforms", Diligent::SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE},
-        {Diligent::SHADER_TYPE_COMPUTE, "VisibleLargeObjectAtomicCounter", Diligent::SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE},
-        {Diligent::SHADER_TYPE_COMPUTE, "VisibleLargeObjectBuffer", Diligent::SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE},
-        {Diligent::SHADER_TYPE_COMPUTE, "ObjectBuffer", Diligent::SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE},
+        {Diligent::SHADER_TYPE_COMPUTE, "DrawAtomicCounterBuffer", Diligent::SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE},
+        {Diligent::SHADER_TYPE_COMPUTE, "DrawCommandBuffer", Diligent::SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE},
         {Diligent::SHADER_TYPE_COMPUTE, "MeshInfoBuffer", Diligent::SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE},
         {Diligent::SHADER_TYPE_COMPUTE, "RenderableBuffer", Diligent::SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE},
-        {Diligent::SHADER_TYPE_COMPUTE, "LargeObjectCullConstants", Diligent::SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE}};
+        {Diligent::SHADER_TYPE_COMPUTE, "VisibleObjectBuffer", Diligent::SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE},
+        {Diligent::SHADER_TYPE_COMPUTE, "RunStartBuffer", Diligent::SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE},
+        {Diligent::SHADER_TYPE_COMPUTE, "RunCountBuffer", Diligent::SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE},
+        {Diligent::SHADER_TYPE_COMPUTE, "LodStateBuffer", Diligent::SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE},
+        {Diligent::SHADER_TYPE_COMPUTE, "CommandGenConstants", Diligent::SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE},
+        {Diligent::SHADER_TYPE_COMPUTE, "VisibleObjectCountBuffer", Diligent::SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE},
+        {Diligent::SHADER_TYPE_COMPUTE, "ObjectBuffer", Diligent::SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE},
+        {Diligent::SHADER_TYPE_COMPUTE, "NormalMatrixBuffer", Diligent::SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE},
+        {Diligent::SHADER_TYPE_COMPUTE, "InstanceBuffer", Diligent::SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE}};
 
     Diligent::ComputePipelineStateCreateInfo PSOCI;
-    PSOCI.PSODesc.Name = "Large Object Cull PSO";
+    PSOCI.PSODesc.Name = "Command Gen PSO";
     PSOCI.PSODesc.PipelineType = Diligent::PIPELINE_TYPE_COMPUTE;
     PSOCI.pCS = pCS;
     PSOCI.PSODesc.ResourceLayout.Variables = Vars;
     PSOCI.PSODesc.ResourceLayout.NumVariables = _countof(Vars);
 
-    m_diligent->pDevice->CreateComputePipelineState(PSOCI, &m_diligent->pLargeObjectCullPSO);
+    m_diligent->pDevice->CreateComputePipelineState(PSOCI, &m_diligent->pCommandGenPSO);
 
     Diligent::BufferDesc CBDesc;
-    CBDesc.Name = "Large Object Cull Constants";
-    CBDesc.Usage = Diligent::USAGE_DYNAMIC;
+    CBDesc.Name = "Command Gen Constants";
+    CBDesc.Usage = Diligent::USAGE_DEFAULT;
     CBDesc.BindFlags = Diligent::BIND_UNIFORM_BUFFER;
-    CBDesc.CPUAccessFlags = Diligent::CPU_ACCESS_WRITE;
-    CBDesc.Size = sizeof(LargeObjectCullUniforms);
-    m_diligent->pDevice->CreateBuffer(CBDesc, nullptr, &m_diligent->pLargeObjectCullConstants);
+    CBDesc.CPUAccessFlags = Diligent::CPU_ACCESS_NONE;
+    CBDesc.Size = sizeof(CommandGenUniforms);
+    m_diligent->pDevice->CreateBuffer(CBDesc, nullptr, &m_diligent->pCommandGenConstants);
 }
 
-void Renderer::createLargeObjectSortPSO() {
-    std::string source = LoadSourceFromFile("resources/shaders/large_object_sort.comp");
-    if (source.empty())
+void Renderer::createDispatchArgsPSO() {
+    std::string source = LoadSourceFromFile("resources/shaders/dispatch_args.comp");
+    if (source.empty()) {
+        Lit::Log::Error("Failed to load dispatch args compute shader source.");
         return;
+    }
 
     size_t versionPos = source.find("#version");
     if (versionPos != std::string::npos) {
@@ -2694,43 +3179,126 @@ void Renderer::createLargeObjectSortPSO() {
     ShaderCI.Source = source.c_str();
     ShaderCI.SourceLanguage = Diligent::SHADER_SOURCE_LANGUAGE_GLSL;
     ShaderCI.Desc.ShaderType = Diligent::SHADER_TYPE_COMPUTE;
-    ShaderCI.Desc.Name = "Large Object Sort CS";
+    ShaderCI.Desc.Name = "Dispatch Args CS";
 
     Diligent::RefCntAutoPtr<Diligent::IShader> pCS;
     m_diligent->pDevice->CreateShader(ShaderCI, &pCS);
     if (!pCS) {
-        Lit::Log::Error("Failed to compile Large Object Sort Shader");
+        Lit::Log::Error("Failed to create dispatch args shader");
         return;
     }
 
     Diligent::ShaderResourceVariableDesc Vars[] = {
-        {Diligent::SHADER_TYPE_COMPUTE, "VisibleLargeObjectBuffer", Diligent::SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE},
-        {Diligent::SHADER_TYPE_COMPUTE, "RenderableBuffer", Diligent::SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE},
-        {Diligent::SHADER_TYPE_COMPUTE, "SortConstants", Diligent::SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE}};
+        {Diligent::SHADER_TYPE_COMPUTE, "CountBuffer", Diligent::SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE},
+        {Diligent::SHADER_TYPE_COMPUTE, "DispatchArgsBuffer", Diligent::SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE},
+        {Diligent::SHADER_TYPE_COMPUTE, "DispatchArgsConstants", Diligent::SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE}};
 
     Diligent::ComputePipelineStateCreateInfo PSOCI;
-    PSOCI.PSODesc.Name = "Large Object Sort PSO";
+    PSOCI.PSODesc.Name = "Dispatch Args PSO";
     PSOCI.PSODesc.PipelineType = Diligent::PIPELINE_TYPE_COMPUTE;
     PSOCI.pCS = pCS;
     PSOCI.PSODesc.ResourceLayout.Variables = Vars;
     PSOCI.PSODesc.ResourceLayout.NumVariables = _countof(Vars);
 
-    m_diligent->pDevice->CreateComputePipelineState(PSOCI, &m_diligent->pLargeObjectSortPSO);
-    if (!m_diligent->pLargeObjectSortPSO) {
-        Lit::Log::Error("Failed to create Large Object Sort PSO");
+    m_diligent->pDevice->CreateComputePipelineState(PSOCI, &m_diligent->pDispatchArgsPSO);
+    if (!m_diligent->pDispatchArgsPSO) {
+        Lit::Log::Error("Failed to create Dispatch Args PSO");
         return;
     }
 
     Diligent::BufferDesc CBDesc;
-    CBDesc.Name = "Large Object Sort Constants";
-    CBDesc.Usage = Diligent::USAGE_DYNAMIC;
+    CBDesc.Name = "Dispatch Args Constants";
+    CBDesc.Usage = Diligent::USAGE_DEFAULT;
     CBDesc.BindFlags = Diligent::BIND_UNIFORM_BUFFER;
-    CBDesc.CPUAccessFlags = Diligent::CPU_ACCESS_WRITE;
-    CBDesc.Size = sizeof(SortConstants);
-    m_diligent->pDevice->CreateBuffer(CBDesc, nullptr, &m_diligent->pLargeObjectSortConstants);
+    CBDesc.Size = sizeof(DispatchArgsConstants);
+    m_diligent->pDevice->CreateBuffer(CBDesc, nullptr, &m_diligent->pDispatchArgsConstants);
+
+    m_diligent->pDispatchArgsPSO->CreateShaderResourceBinding(&m_diligent->pDispatchArgsSRB, true);
 
-    m_diligent->pLargeObjectSortPSO->CreateShaderResourceBinding(&m_diligent->pLargeObjectSortSRB, true);
+    if (auto* var = m_diligent->pDispatchArgsSRB->GetVariableByName(Diligent::SHADER_TYPE_COMPUTE, "DispatchArgsConstants"))
+        var->Set(m_diligent->pDispatchArgsConstants);
+    m_diligent->pDispatchArgsCountVar = m_diligent->pDispatchArgsSRB->GetVariableByName(Diligent::SHADER_TYPE_COMPUTE, "CountBuffer");
+}
+
+void Renderer::createDrawRunPSOs() {
+    auto CreateDrawRunPSO = [&](const char* path, const char* name, std::initializer_list<const char*> variableNames, Diligent::RefCntAutoPtr<Diligent::IPipelineState>& pPSO,
+                                Diligent::RefCntAutoPtr<Diligent::IShaderResourceBinding>& pSRB) {
+        pSRB.Release();
+        if (CreateComputePipeline(m_diligent->pDevice, path, name, variableNames, pPSO))
+            pPSO->CreateShaderResourceBinding(&pSRB, true);
+    };
+
+    CreateDrawRunPSO("resources/shaders/draw_run_scan.comp", "Draw Run Scan", {"SortKeyBuffer", "VisibleCountBuffer", "RunScanBuffer", "RunGroupBuffer", "DrawRunConstants"},
+                     m_diligent->pDrawRunScanPSO, m_diligent->pDrawRunScanSRB);
+    CreateDrawRunPSO("resources/shaders/draw_run_group_scan.comp", "Draw Run Group Scan", {"VisibleCountBuffer", "RunGroupBuffer", "RunCountBuffer", "DrawRunConstants"}, m_diligent->pDrawRunGroupScanPSO,
+                     m_diligent->pDrawRunGroupScanSRB);
+    CreateDrawRunPSO("resources/shaders/draw_run_compact.comp", "Draw Run Compact", {"VisibleCountBuffer", "RunScanBuffer", "RunGroupBuffer", "RunStartBuffer", "DrawRunConstants"}, m_diligent->pDrawRunCompactPSO,
+                     m_diligent->pDrawRunCompactSRB);
+
+    Diligent::BufferDesc CBDesc;
+    CBDesc.Name = "Draw Run Constants";
+    CBDesc.Usage = Diligent::USAGE_DEFAULT;
+    CBDesc.BindFlags = Diligent::BIND_UNIFORM_BUFFER;
+    CBDesc.CPUAccessFlags = Diligent::CPU_ACCESS_NONE;
+    CBDesc.Size = sizeof(DrawRunConstants);
+    m_diligent->pDevice->CreateBuffer(CBDesc, nullptr, &m_diligent->pDrawRunConstants);
+
+    Diligent::IShaderResourceBinding* pSRBs[] = {m_diligent->pDrawRunScanSRB, m_diligent->pDrawRunGroupScanSRB, m_diligent->pDrawRunCompactSRB};
+    for (size_t i = 0; i < _countof(pSRBs); ++i) {
+        m_diligent->pDrawRunCountVars[i] = nullptr;
+        if (!pSRBs[i])
+            continue;
+        if (auto* var = pSRBs[i]->GetVariableByName(Diligent::SHADER_TYPE_COMPUTE, "DrawRunConstants"))
+            var->Set(m_diligent->pDrawRunConstants);
+        m_diligent->pDrawRunCountVars[i] = pSRBs[i]->GetVariableByName(Diligent::SHADER_TYPE_COMPUTE, "VisibleCountBuffer");
+    }
+    m_diligent->pDrawRunSortKeyVar = m_diligent->pDrawRunScanSRB ? m_diligent->pDrawRunScanSRB->GetVariableByName(Diligent::SHADER_TYPE_COMPUTE, "SortKeyBuffer") : nullptr;
+}
 
-    if (auto* var = m_diligent->pLargeObjectSortSRB->GetVariableByName(Diligent::SHADER_TYPE_COMPUTE, "SortConstants"))
-        var->Set(m_diligent->pLargeObjectSortConstants);
-}
\ No newline at end of file
+void Renderer::createRadixSortPSOs() {
+    CreateComputePipeline(m_diligent->pDevice, "resources/shaders/radix_histogram.comp", "Radix Histogram", {"VisibleCountBuffer", "SortKeyBuffer", "SortHistogramBuffer", "RadixSortConstants"},
+                          m_diligent->pRadixHistogramPSO);
+    CreateComputePipeline(m_diligent->pDevice, "resources/shaders/radix_scan.comp", "Radix Scan", {"VisibleCountBuffer", "SortHistogramBuffer", "RadixSortConstants"}, m_diligent->pRadixScanPSO);
+    CreateComputePipeline(m_diligent->pDevice, "resources/shaders/radix_scatter.comp", "Radix Scatter",
+                          {"VisibleCountBuffer", "SortKeyBuffer", "SortValueBuffer", "SortHistogramBuffer", "SortedKeyBuffer", "SortedValueBuffer", "RadixSortConstants"},
+                          m_diligent->pRadixScatterPSO);
+
+    Diligent::BufferDesc CBDesc;
+    CBDesc.Name = "Radix Sort Constants";
+    CBDesc.Usage = Diligent::USAGE_DEFAULT;
+    CBDesc.BindFlags = Diligent::BIND_UNIFORM_BUFFER;
+    CBDesc.CPUAccessFlags = Diligent::CPU_ACCESS_NONE;
+    CBDesc.Size = sizeof(RadixSortConstants);
+    m_diligent->pDevice->CreateBuffer(CBDesc, nullptr, &m_diligent->pRadixSortConstants);
+
+    // Rewritten before each cull pass, so it is updated rather than mapped.
+    CBDesc.Name = "Sort Key Constants";
+    CBDesc.Usage = Diligent::USAGE_DEFAULT;
+    CBDesc.CPUAccessFlags = Diligent::CPU_ACCESS_NONE;
+    CBDesc.Size = sizeof(SortKeyConstants);
+    m_diligent->pDevice->CreateBuffer(CBDesc, nullptr, &m_diligent->pSortKeyConstants);
+
+    // The histogram and scatter passes get one SRB per ping-pong direction.
+    for (int p = 0; p < 2; ++p) {
+        m_diligent->pRadixHistogramSRBs[p].Release();
+        m_diligent->pRadixScatterSRBs[p].Release();
+        if (m_diligent->pRadixHistogramPSO)
+            m_diligent->pRadixHistogramPSO->CreateShaderResourceBinding(&m_diligent->pRadixHistogramSRBs[p], true);
+        if (m_diligent->pRadixScatterPSO)
+            m_diligent->pRadixScatterPSO->CreateShaderResourceBinding(&m_diligent->pRadixScatterSRBs[p], true);
+    }
+    m_diligent->pRadixScanSRB.Release();
+    if (m_diligent->pRadixScanPSO)
+        m_diligent->pRadixScanPSO->CreateShaderResourceBinding(&m_diligent->pRadixScanSRB, true);
+
+    Diligent::IShaderResourceBinding* pSRBs[] = {m_diligent->pRadixHistogramSRBs[0], m_diligent->pRadixHistogramSRBs[1], m_diligent->pRadixScanSRB, m_diligent->pRadixScatterSRBs[0],
+                                                 m_diligent->pRadixScatterSRBs[1]};
+    for (size_t i = 0; i < _countof(pSRBs); ++i) {
+        m_diligent->pRadixCountVars[i] = nullptr;
+        if (!pSRBs[i])
+            continue;
+        if (auto* var = pSRBs[i]->GetVariableByName(Diligent::SHADER_TYPE_COMPUTE, "RadixSortConstants"))
+            var->Set(m_diligent->pRadixSortConstants);
+        m_diligent->pRadixCountVars[i] = pSRBs[i]->GetVariableByName(Diligent::SHADER_TYPE_COMPUTE, "VisibleCountBuffer");
+    }
+}
@@ -4,6 +4,7 @@ module;
 #include <vector>
 #include <string>
 #include <cstdint>
+#include <memory>
 
 struct GLFWwindow;
 struct DiligentData;
@@ -11,11 +12,37 @@ struct DiligentData;
 export module Engine.renderer;
 
 import Engine.camera;
+import Engine.Render.entity;
 import Engine.Render.scenedatabase;
+import Engine.Render.component;
+import Engine.Render.transformpropagator;
 import Engine.mesh;
 import Engine.UI.manager;
 import Engine.glm;
 
+// Where world transforms are computed each frame. Cpu runs TransformPropagator and uploads the
+// results, which also serves as a reference when checking transform.comp.
+export enum class TransformBackend { Gpu, Cpu };
+
+// Bit budgets of the packed sort keys the cull passes emit. Opaque keys order by shader, material,
+// mesh and then front-to-back depth, transparent keys by back-to-front depth alone. Shader and
+// mesh ids always get the bits they need; material ids are truncated to materialBits and depth is
+// quantised over the camera range to at most 24 bits. Every 8 key bits cost one radix pass.
+export struct SortKeyBudget {
+    uint32_t materialBits = 8;
+    uint32_t depthBits = 16;
+    uint32_t transparentDepthBits = 24;
+};
+
+// Screen-size LOD selection in the cull pass. An object switches from LOD i to LOD i + 1 once its
+// projected size (bounding radius over distance) drops below thresholds[i]; hysteresis widens
+// each boundary by that fraction on the side of the LOD the object already uses. The small object
+// threshold still culls whatever is smaller than that.
+export struct LodSelection {
+    float thresholds[3] = {0.06f, 0.025f, 0.01f};
+    float hysteresis = 0.1f;
+};
+
 export class Renderer {
   public:
     Renderer();
@@ -27,24 +54,37 @@ export class Renderer {
     void uploadMesh(const Mesh& mesh);
     void AddText(const std::string& text, float x, float y, float scale, const glm::vec3& color);
     void setSmallObjectThreshold(float threshold);
-    void setLargeObjectThreshold(float threshold);
+    void setClusterCullThreshold(float threshold);
+    void setTransformBackend(TransformBackend backend);
+    // While enabled, the GPU backend's world, normal and bounds slices of a frame are read back
+    // once that frame's fence has passed and compared with TransformPropagator's results for the
+    // same scene state; the first mismatches are logged.
+    void setTransformValidation(bool enabled);
+    // Milliseconds the last TransformPropagator pass took, on the CPU backend or for validation.
+    double getPropagateTime() const { return m_propagateTime; }
+    void setSortKeyBudget(const SortKeyBudget& budget);
+    void setLodSelection(const LodSelection& selection);
 
   private:
     void createTransformPSO();
-    void createHiZPSO();
+    void createHiZDownsamplePSO();
     void createCullingPSO();
+    void createClusterCullPSO();
+    void createLightBinPSO();
     void createOpaqueSortPSO();
     void createCommandGenPSO();
-    void createLargeObjectCullPSO();
-    void createLargeObjectSortPSO();
+    void createDispatchArgsPSO();
+    void createDrawRunPSOs();
+    void createRadixSortPSOs();
     void createTransparentCullPSO();
     void createTransparentSortPSO();
     void createTransparentCommandGenPSO();
-    void createLargeObjectCommandGenPSO();
-    void createDepthPrepassPSO();
     void createOpaquePSOs();
     void createTransparentPSO();
+    void createPresentPSO();
     void reallocateBuffers(size_t numObjects);
+    void createFrameBindings();
+    void checkTransformReadback();
 
     unsigned int m_vao = 0;
     unsigned int m_vbo = 0;
@@ -61,6 +101,7 @@ export class Renderer {
     static constexpr int NUM_FRAMES_IN_FLIGHT = 3;
     size_t m_vboSize = 0;
     size_t m_eboSize = 0;
+    size_t m_shortEboSize = 0;
 
     unsigned int m_visibleObjectBuffer = 0;
     unsigned int m_visibleTransparentObjectIdsBuffer = 0;
@@ -73,14 +114,12 @@ export class Renderer {
     unsigned int m_hizFbo = 0;
     unsigned int m_hizTexture[NUM_FRAMES_IN_FLIGHT] = {0};
 
-    unsigned int m_depthPrepassAtomicCounter = 0;
-    unsigned int m_depthPrepassDrawCommandBuffer = 0;
-    unsigned int m_visibleLargeObjectBuffer = 0;
-    unsigned int m_visibleLargeObjectAtomicCounter = 0;
-
     int m_maxMipLevel = 0;
+    int m_hizMipCount = 0;
 
     size_t m_numDrawingShaders = 0;
+    // Opaque and meshlet draw bins: one per shader and index type.
+    size_t m_numDrawBins = 0;
 
     bool m_initialized = false;
     bool m_meshInfoDirty = true;
@@ -98,12 +137,6 @@ export class Renderer {
     unsigned int m_queryOpaqueSortEnd[NUM_FRAMES_IN_FLIGHT] = {0};
     unsigned int m_queryCommandGenStart[NUM_FRAMES_IN_FLIGHT] = {0};
     unsigned int m_queryCommandGenEnd[NUM_FRAMES_IN_FLIGHT] = {0};
-    unsigned int m_queryLargeObjectSortStart[NUM_FRAMES_IN_FLIGHT] = {0};
-    unsigned int m_queryLargeObjectSortEnd[NUM_FRAMES_IN_FLIGHT] = {0};
-    unsigned int m_queryLargeObjectCommandGenStart[NUM_FRAMES_IN_FLIGHT] = {0};
-    unsigned int m_queryLargeObjectCommandGenEnd[NUM_FRAMES_IN_FLIGHT] = {0};
-    unsigned int m_queryDepthPrePassStart[NUM_FRAMES_IN_FLIGHT] = {0};
-    unsigned int m_queryDepthPrePassEnd[NUM_FRAMES_IN_FLIGHT] = {0};
     unsigned int m_queryTransparentCullStart[NUM_FRAMES_IN_FLIGHT] = {0};
     unsigned int m_queryTransparentCullEnd[NUM_FRAMES_IN_FLIGHT] = {0};
     unsigned int m_queryTransparentSortStart[NUM_FRAMES_IN_FLIGHT] = {0};
@@ -122,6 +155,9 @@ export class Renderer {
     unsigned int m_currentFrame = 0;
 
     size_t m_objectBufferSize = 0;
+    size_t m_localTransformBufferSize = 0;
+    size_t m_boundsBufferSize = 0;
+    size_t m_normalMatrixBufferSize = 0;
     size_t m_hierarchyBufferSize = 0;
     size_t m_renderableBufferSize = 0;
     size_t m_sortedHierarchyBufferSize = 0;
@@ -129,23 +165,56 @@ export class Renderer {
     size_t m_visibleObjectBufferSize = 0;
     size_t m_visibleTransparentObjectIdsBufferSize = 0;
     size_t m_transparentDrawCommandBufferSize = 0;
-    size_t m_depthPrepassDrawCommandBufferSize = 0;
-    size_t m_visibleLargeObjectBufferSize = 0;
     size_t m_sceneUBOSize = 0;
     size_t m_maxObjects = 0;
+    size_t m_meshletCapacity = 0;
+    size_t m_lightCapacity = 0;
+    // Longest LOD chain among the uploaded meshes; sizes the LOD field of the sort keys.
+    size_t m_maxLodCount = 1;
 
     uint64_t m_processedHierarchyVersion = 0;
     uint64_t m_processedDataVersion = 0;
-    int m_hierarchyUpdateCounter = 0;
-    int m_dataUpdateCounter = 0;
+    // Entity ranges each frame's copy of the object/renderable/hierarchy buffers still has to
+    // receive.
+    std::vector<DirtyRange> m_pendingTransformRanges[NUM_FRAMES_IN_FLIGHT];
+    std::vector<DirtyRange> m_pendingRenderableRanges[NUM_FRAMES_IN_FLIGHT];
+    std::vector<DirtyRange> m_pendingHierarchyRanges[NUM_FRAMES_IN_FLIGHT];
+    std::vector<DirtyRange> m_dirtyTransformRanges;
+    std::vector<DirtyRange> m_dirtyRenderableRanges;
+    std::vector<DirtyRange> m_dirtyHierarchyRanges;
+    // Frames left that must recompute every world transform instead of only changed subtrees.
+    int m_fullTransformUpdateCounter = 0;
+    std::vector<DirtyRange> m_transformUpdateRanges;
+    std::vector<Entity> m_transformUpdateList;
+    std::vector<uint32_t> m_transformUpdateLevelOffsets;
+
+    TransformBackend m_transformBackend = TransformBackend::Gpu;
+    std::unique_ptr<TransformPropagator> m_transformPropagator;
+    std::vector<WorldTransform> m_cpuWorldTransforms;
+    std::vector<glm::vec4> m_cpuWorldBounds;
+    std::vector<WorldTransform> m_cpuNormalMatrices;
+    std::vector<DirtyRange> m_cpuUploadRanges;
+    double m_propagateTime = 0.0;
+
+    bool m_transformValidation = false;
+    // Frame slot whose transforms are being read back, or -1. The reference below is computed when
+    // the copy is recorded.
+    int m_transformReadbackFrame = -1;
+    size_t m_transformReadbackCount = 0;
+    std::vector<Entity> m_validationEntities;
+    std::vector<WorldTransform> m_validationWorldTransforms;
+    std::vector<WorldTransform> m_validationNormalMatrices;
+    std::vector<glm::vec4> m_validationWorldBounds;
 
     float m_smallObjectThreshold = 0.005f;
-    float m_largeObjectThreshold = 0.1f;
+    // Objects whose bounding radius is at least this fraction of their distance are culled per
+    // meshlet.
+    float m_clusterCullThreshold = 0.05f;
+    SortKeyBudget m_sortKeyBudget;
+    LodSelection m_lodSelection;
     int m_windowWidth = 0;
     int m_windowHeight = 0;
 
-    bool m_renderPrePass = true;
-    float m_prePassToggleTimer = 0.0f;
     float m_lastFrameTime = 0.0f;
 
     DiligentData* m_diligent = nullptr;
@@ -0,0 +1,826 @@
+module;
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <cstddef>
+#include <span>
+#include <vector>
+
+module Engine.Render.scenedatabase;
+
+import Engine.Render.entity;
+import Engine.Render.component;
+import Engine.Render.componentstorage;
+import Engine.glm;
+
+namespace {
+void setDirtyBit(std::vector<uint64_t>& bits, Entity entity) {
+    const size_t word = entity / 64;
+    if (word >= bits.size()) {
+        bits.resize(word + 1, 0);
+    }
+    bits[word] |= uint64_t{1} << (entity % 64);
+}
+
+void setDirtyRange(std::vector<uint64_t>& bits, Entity begin, Entity end) {
+    if (begin >= end) {
+        return;
+    }
+    const size_t lastWord = (end - 1) / 64;
+    if (lastWord >= bits.size()) {
+        bits.resize(lastWord + 1, 0);
+    }
+    for (Entity entity = begin; entity < end;) {
+        const size_t word = entity / 64;
+        const uint32_t firstBit = entity % 64;
+        const uint32_t bitCount = std::min<uint32_t>(64 - firstBit, end - entity);
+        const uint64_t mask = bitCount == 64 ? ~uint64_t{0} : ((uint64_t{1} << bitCount) - 1) << firstBit;
+        bits[word] |= mask;
+        entity += bitCount;
+    }
+}
+
+// Converts set bits into runs of consecutive entities and clears the bitset.
+void collectDirtyRanges(std::vector<uint64_t>& bits, std::vector<DirtyRange>& ranges) {
+    for (size_t word = 0; word < bits.size(); ++word) {
+        uint64_t mask = bits[word];
+        bits[word] = 0;
+
+        while (mask != 0) {
+            const int first = std::countr_zero(mask);
+            const int length = std::countr_one(mask >> first);
+            const auto begin = static_cast<Entity>(word * 64 + first);
+            const auto end = static_cast<Entity>(begin + length);
+
+            if (!ranges.empty() && ranges.back().end == begin) {
+                ranges.back().end = end;
+            } else {
+                ranges.push_back({begin, end});
+            }
+
+            mask = first + length >= 64 ? 0 : mask & (~uint64_t{0} << (first + length));
+        }
+    }
+}
+} // namespace
+
+void coalesceDirtyRanges(std::vector<DirtyRange>& ranges, size_t maxRanges) {
+    if (ranges.empty()) {
+        return;
+    }
+
+    std::sort(ranges.begin(), ranges.end(), [](const DirtyRange& a, const DirtyRange& b) { return a.begin < b.begin; });
+
+    auto mergeWithin = [&](uint64_t gap) {
+        size_t out = 0;
+        for (size_t i = 1; i < ranges.size(); ++i) {
+            if (ranges[i].begin <= ranges[out].end + gap) {
+                ranges[out].end = std::max(ranges[out].end, ranges[i].end);
+            } else {
+                ranges[++out] = ranges[i];
+            }
+        }
+        ranges.resize(out + 1);
+    };
+
+    mergeWithin(0);
+    for (uint64_t gap = 16; ranges.size() > maxRanges && maxRanges > 0; gap *= 2) {
+        mergeWithin(gap);
+    }
+}
+
+Entity SceneDatabase::createEntity() {
+    Entity entity;
+    if (!m_freeEntities.empty()) {
+        entity = m_freeEntities.back();
+        m_freeEntities.pop_back();
+        components.resetRow(entity);
+        m_links[entity] = HierarchyLinks{};
+    } else {
+        entity = static_cast<Entity>(components.emplaceBack());
+        m_links.emplace_back();
+        m_entityHandles.push_back(INVALID_ENTITY);
+        m_orderPositions.push_back(INVALID_ORDER_POSITION);
+    }
+    renderables[entity].objectId = entity;
+    allocateHandle(entity);
+
+    linkChild(entity, INVALID_ENTITY);
+    if (m_levelCounts.empty()) {
+        m_levelCounts.push_back(0);
+    }
+    m_levelCounts[0]++;
+    insertIntoLevelOrder(entity, 0);
+
+    setDirtyBit(m_transformDirtyBits, entity);
+    setDirtyBit(m_renderableDirtyBits, entity);
+    setDirtyBit(m_hierarchyDirtyBits, entity);
+    m_transformsDirty = true;
+    m_renderablesDirty = true;
+    m_hierarchiesDirty = true;
+
+    m_hierarchyVersion++;
+    m_dataVersion++;
+    return entity;
+}
+
+Entity SceneDatabase::createEntities(size_t count) {
+    if (count == 0) {
+        return INVALID_ENTITY;
+    }
+
+    const Entity first = appendEntities(count);
+    const auto end = static_cast<Entity>(first + count);
+    if (m_levelCounts.empty()) {
+        m_levelCounts.push_back(0);
+    }
+    m_levelCounts[0] += static_cast<uint32_t>(count);
+
+    for (Entity entity = first; entity < end; ++entity) {
+        linkChild(entity, INVALID_ENTITY);
+        insertIntoLevelOrder(entity, 0);
+    }
+
+    m_hierarchyVersion++;
+    m_dataVersion++;
+    return first;
+}
+
+Entity SceneDatabase::instantiatePrefab(const Prefab& prefab, size_t instanceCount, Entity parent) {
+    const size_t prefabSize = prefab.hierarchies.size();
+    if (prefabSize == 0 || instanceCount == 0 || prefab.transforms.size() != prefabSize || prefab.renderables.size() != prefabSize) {
+        return INVALID_ENTITY;
+    }
+    if (parent != INVALID_ENTITY && !isAlive(parent)) {
+        return INVALID_ENTITY;
+    }
+
+    if (m_linksDirty) {
+        rebuildHierarchyLinks();
+    }
+
+    const uint32_t baseLevel = parent == INVALID_ENTITY ? 0 : hierarchies[parent].level + 1;
+    m_prefabLevels.resize(prefabSize);
+    for (size_t i = 0; i < prefabSize; ++i) {
+        const Entity localParent = prefab.hierarchies[i].parent;
+        if (localParent != INVALID_ENTITY && localParent >= i) {
+            return INVALID_ENTITY;
+        }
+        m_prefabLevels[i] = localParent == INVALID_ENTITY ? baseLevel : m_prefabLevels[localParent] + 1;
+    }
+
+    const Entity first = appendEntities(prefabSize * instanceCount);
+    for (size_t instance = 0; instance < instanceCount; ++instance) {
+        const auto base = static_cast<Entity>(first + instance * prefabSize);
+        std::copy(prefab.transforms.begin(), prefab.transforms.end(), transforms.begin() + base);
+        std::copy(prefab.renderables.begin(), prefab.renderables.end(), renderables.begin() + base);
+
+        for (size_t i = 0; i < prefabSize; ++i) {
+            const auto entity = static_cast<Entity>(base + i);
+            const Entity localParent = prefab.hierarchies[i].parent;
+            const Entity entityParent = localParent == INVALID_ENTITY ? parent : base + localParent;
+            hierarchies[entity] = HierarchyComponent{entityParent, m_prefabLevels[i]};
+            renderables[entity].objectId = entity;
+            linkChild(entity, entityParent);
+            insertIntoLevelOrder(entity, m_prefabLevels[i]);
+        }
+    }
+
+    for (const uint32_t level : m_prefabLevels) {
+        if (level >= m_levelCounts.size()) {
+            m_levelCounts.resize(level + 1, 0);
+        }
+        m_levelCounts[level] += static_cast<uint32_t>(instanceCount);
+    }
+    refreshMaxDepth();
+
+    m_hierarchyVersion++;
+    m_dataVersion++;
+    return first;
+}
+
+bool SceneDatabase::destroyEntity(Entity entity) {
+    if (!isAlive(entity)) {
+        return false;
+    }
+
+    if (m_linksDirty) {
+        rebuildHierarchyLinks();
+    }
+
+    m_subtreeScratch.clear();
+    walkSubtree(entity, [&](Entity member, uint32_t) { m_subtreeScratch.push_back(member); });
+    unlinkChild(entity);
+
+    for (const Entity member : m_subtreeScratch) {
+        m_levelCounts[hierarchies[member].level]--;
+        removeFromLevelOrder(member, hierarchies[member].level);
+
+        HandleSlot& slot = m_handleSlots[m_entityHandles[member]];
+        slot.entity = INVALID_ENTITY;
+        slot.generation++;
+        m_freeHandles.push_back(m_entityHandles[member]);
+        m_entityHandles[member] = INVALID_ENTITY;
+
+        hierarchies[member] = HierarchyComponent{INVALID_ENTITY, 0};
+        markHierarchyRowDirty(member);
+        m_links[member] = HierarchyLinks{};
+        renderables[member].mesh_uuid = INVALID_MESH;
+        markRenderableDirty(member);
+        m_freeEntities.push_back(member);
+    }
+
+    refreshMaxDepth();
+    m_hierarchyVersion++;
+    return true;
+}
+
+EntityHandle SceneDatabase::getHandle(Entity entity) const {
+    if (!isAlive(entity)) {
+        return INVALID_ENTITY_HANDLE;
+    }
+    const uint32_t handleIndex = m_entityHandles[entity];
+    return EntityHandle{handleIndex, m_handleSlots[handleIndex].generation};
+}
+
+Entity SceneDatabase::resolve(EntityHandle handle) const {
+    if (handle.index >= m_handleSlots.size() || m_handleSlots[handle.index].generation != handle.generation) {
+        return INVALID_ENTITY;
+    }
+    return m_handleSlots[handle.index].entity;
+}
+
+bool SceneDatabase::compact(size_t maxMoves) {
+    if (m_freeEntities.empty()) {
+        return true;
+    }
+
+    if (m_linksDirty) {
+        rebuildHierarchyLinks();
+    }
+
+    // Fill the lowest holes first; the highest free slots are trimmed off the end instead.
+    std::sort(m_freeEntities.begin(), m_freeEntities.end());
+    size_t nextHole = 0;
+    size_t moves = 0;
+    while (true) {
+        while (!components.empty() && !isAlive(static_cast<Entity>(components.size() - 1))) {
+            popEntitySlot();
+            m_freeEntities.pop_back();
+        }
+
+        if (nextHole >= m_freeEntities.size() || moves >= maxMoves) {
+            break;
+        }
+
+        moveEntity(static_cast<Entity>(components.size() - 1), m_freeEntities[nextHole++]);
+        popEntitySlot();
+        moves++;
+    }
+    m_freeEntities.erase(m_freeEntities.begin(), m_freeEntities.begin() + std::min(nextHole, m_freeEntities.size()));
+
+    m_hierarchyVersion++;
+    m_dataVersion++;
+    return m_freeEntities.empty();
+}
+
+void SceneDatabase::defragment() {
+    if (m_linksDirty) {
+        rebuildHierarchyLinks();
+    }
+
+    // m_subtreeScratch maps new index -> old index, m_updateScratch old -> new.
+    m_subtreeScratch.clear();
+    m_subtreeScratch.reserve(liveEntityCount());
+    for (Entity root = m_firstRoot; root != INVALID_ENTITY; root = m_links[root].nextSibling) {
+        walkSubtree(root, [&](Entity entity, uint32_t) { m_subtreeScratch.push_back(entity); });
+    }
+
+    m_updateScratch.assign(components.size(), INVALID_ENTITY);
+    for (Entity entity = 0; entity < m_subtreeScratch.size(); ++entity) {
+        m_updateScratch[m_subtreeScratch[entity]] = entity;
+    }
+
+    components.gather(std::span<const Entity>(m_subtreeScratch));
+
+    std::vector<uint32_t> entityHandles(m_subtreeScratch.size());
+    for (Entity entity = 0; entity < m_subtreeScratch.size(); ++entity) {
+        entityHandles[entity] = m_entityHandles[m_subtreeScratch[entity]];
+        m_handleSlots[entityHandles[entity]].entity = entity;
+
+        HierarchyComponent& hierarchy = hierarchies[entity];
+        if (hierarchy.parent != INVALID_ENTITY) {
+            hierarchy.parent = m_updateScratch[hierarchy.parent];
+        }
+        renderables[entity].objectId = entity;
+    }
+    m_entityHandles.swap(entityHandles);
+    m_freeEntities.clear();
+    m_orderPositions.assign(m_subtreeScratch.size(), INVALID_ORDER_POSITION);
+
+    std::erase_if(m_dynamicEntities, [&](Entity entity) { return entity >= m_updateScratch.size() || m_updateScratch[entity] == INVALID_ENTITY; });
+    for (Entity& entity : m_dynamicEntities) {
+        entity = m_updateScratch[entity];
+    }
+
+    // Pre-order keeps children in their old sibling order when the links are rebuilt by index.
+    rebuildHierarchyLinks();
+    markDataDirty();
+    m_hierarchyVersion++;
+}
+
+bool SceneDatabase::setParent(Entity child, Entity parent) {
+    if (!isAlive(child) || (parent != INVALID_ENTITY && !isAlive(parent))) {
+        return false;
+    }
+
+    if (m_linksDirty) {
+        rebuildHierarchyLinks();
+    }
+
+    for (Entity ancestor = parent; ancestor != INVALID_ENTITY; ancestor = hierarchies[ancestor].parent) {
+        if (ancestor == child) {
+            return false;
+        }
+    }
+
+    if (hierarchies[child].parent == parent) {
+        return true;
+    }
+
+    unlinkChild(child);
+    hierarchies[child].parent = parent;
+    markHierarchyRowDirty(child);
+    linkChild(child, parent);
+
+    // Only a level change moves entries of sortedHierarchyList; see moveInLevelOrder().
+    relevelSubtree(child, parent == INVALID_ENTITY ? 0 : hierarchies[parent].level + 1);
+    markTransformDirty(child);
+
+    m_hierarchyVersion++;
+    return true;
+}
+
+void SceneDatabase::setLocalTransform(Entity entity, const TransformComponent& transform) {
+    transforms[entity] = transform;
+    markTransformDirty(entity);
+}
+
+void SceneDatabase::setTranslation(Entity entity, const glm::vec3& translation) {
+    transforms[entity].translation = translation;
+    markTransformDirty(entity);
+}
+
+void SceneDatabase::markTransformDirty(Entity entity) {
+    setDirtyBit(m_transformDirtyBits, entity);
+    m_transformsDirty = true;
+    m_dataVersion++;
+}
+
+void SceneDatabase::markRenderableDirty(Entity entity) {
+    setDirtyBit(m_renderableDirtyBits, entity);
+    m_renderablesDirty = true;
+    m_dataVersion++;
+}
+
+void SceneDatabase::markHierarchyRowDirty(Entity entity) {
+    setDirtyBit(m_hierarchyDirtyBits, entity);
+    m_hierarchiesDirty = true;
+    m_dataVersion++;
+}
+
+void SceneDatabase::markDataDirty() {
+    m_allDataDirty = true;
+    m_dataVersion++;
+}
+
+void SceneDatabase::setMobility(Entity entity, Mobility mobility) {
+    if (!isAlive(entity) || mobilities[entity] == mobility) {
+        return;
+    }
+
+    mobilities[entity] = mobility;
+    if (mobility == Mobility::Dynamic) {
+        m_dynamicEntities.push_back(entity);
+    }
+    markTransformDirty(entity);
+}
+
+void SceneDatabase::consumeDirtyRanges(std::vector<DirtyRange>& transformRanges, std::vector<DirtyRange>& renderableRanges, std::vector<DirtyRange>& hierarchyRanges) {
+    transformRanges.clear();
+    renderableRanges.clear();
+    hierarchyRanges.clear();
+
+    if (!m_dynamicEntities.empty()) {
+        // Entries go stale when an entity turns static, is destroyed or is moved by compact().
+        std::erase_if(m_dynamicEntities, [&](Entity entity) { return !isAlive(entity) || mobilities[entity] != Mobility::Dynamic; });
+        std::sort(m_dynamicEntities.begin(), m_dynamicEntities.end());
+        m_dynamicEntities.erase(std::unique(m_dynamicEntities.begin(), m_dynamicEntities.end()), m_dynamicEntities.end());
+
+        for (const Entity entity : m_dynamicEntities) {
+            setDirtyBit(m_transformDirtyBits, entity);
+        }
+        m_transformsDirty = m_transformsDirty || !m_dynamicEntities.empty();
+    }
+
+    if (m_allDataDirty) {
+        std::fill(m_transformDirtyBits.begin(), m_transformDirtyBits.end(), 0);
+        std::fill(m_renderableDirtyBits.begin(), m_renderableDirtyBits.end(), 0);
+        std::fill(m_hierarchyDirtyBits.begin(), m_hierarchyDirtyBits.end(), 0);
+        if (!transforms.empty()) {
+            transformRanges.push_back({0, static_cast<Entity>(transforms.size())});
+        }
+        if (!renderables.empty()) {
+            renderableRanges.push_back({0, static_cast<Entity>(renderables.size())});
+        }
+        if (!hierarchies.empty()) {
+            hierarchyRanges.push_back({0, static_cast<Entity>(hierarchies.size())});
+        }
+    } else {
+        if (m_transformsDirty) {
+            collectDirtyRanges(m_transformDirtyBits, transformRanges);
+        }
+        if (m_renderablesDirty) {
+            collectDirtyRanges(m_renderableDirtyBits, renderableRanges);
+        }
+        if (m_hierarchiesDirty) {
+            collectDirtyRanges(m_hierarchyDirtyBits, hierarchyRanges);
+        }
+    }
+
+    m_allDataDirty = false;
+    m_transformsDirty = false;
+    m_renderablesDirty = false;
+    m_hierarchiesDirty = false;
+}
+
+bool SceneDatabase::collectTransformUpdates(std::span<const DirtyRange> changed, std::vector<Entity>& entities, std::vector<uint32_t>& levelOffsets) {
+    entities.clear();
+    levelOffsets.clear();
+
+    const auto numEntities = static_cast<Entity>(components.size());
+    size_t changedCount = 0;
+    for (const DirtyRange& range : changed) {
+        changedCount += std::min(range.end, numEntities) - std::min(range.begin, numEntities);
+    }
+    if (changedCount == 0) {
+        return true;
+    }
+    // Past this point walking the subtrees costs more than processing every entity.
+    if (changedCount * 2 >= liveEntityCount()) {
+        return false;
+    }
+
+    if (m_linksDirty) {
+        rebuildHierarchyLinks();
+    }
+
+    if (m_visitMarks.size() < numEntities) {
+        m_visitMarks.resize(numEntities, 0);
+    }
+    if (++m_visitGeneration == 0) {
+        std::fill(m_visitMarks.begin(), m_visitMarks.end(), 0);
+        m_visitGeneration = 1;
+    }
+
+    m_subtreeScratch.clear();
+    for (const DirtyRange& range : changed) {
+        const Entity end = std::min(range.end, numEntities);
+        for (Entity entity = range.begin; entity < end; ++entity) {
+            if (isAlive(entity)) {
+                m_subtreeScratch.push_back(entity);
+            }
+        }
+    }
+
+    // Walking the shallowest roots first means a changed entity inside an already collected
+    // subtree is marked by the time it comes up and is skipped.
+    std::sort(m_subtreeScratch.begin(), m_subtreeScratch.end(), [&](Entity a, Entity b) { return hierarchies[a].level < hierarchies[b].level; });
+
+    m_updateScratch.clear();
+    m_levelCursors.clear();
+    for (const Entity root : m_subtreeScratch) {
+        if (m_visitMarks[root] == m_visitGeneration) {
+            continue;
+        }
+        walkSubtree(root, [&](Entity entity, uint32_t) {
+            m_visitMarks[entity] = m_visitGeneration;
+            m_updateScratch.push_back(entity);
+
+            const uint32_t level = hierarchies[entity].level;
+            if (level >= m_levelCursors.size()) {
+                m_levelCursors.resize(level + 1, 0);
+            }
+            m_levelCursors[level]++;
+        });
+    }
+
+    levelOffsets.assign(m_levelCursors.size() + 1, 0);
+    for (size_t level = 0; level < m_levelCursors.size(); ++level) {
+        levelOffsets[level + 1] = levelOffsets[level] + m_levelCursors[level];
+    }
+
+    entities.resize(m_updateScratch.size());
+    std::copy(levelOffsets.begin(), levelOffsets.end() - 1, m_levelCursors.begin());
+    for (const Entity entity : m_updateScratch) {
+        entities[m_levelCursors[hierarchies[entity].level]++] = entity;
+    }
+    return true;
+}
+
+void SceneDatabase::updateHierarchy() {
+    if (m_linksDirty) {
+        rebuildHierarchyLinks();
+    }
+
+    if (m_orderDirty) {
+        flattenHierarchy();
+    }
+}
+
+void SceneDatabase::linkChild(Entity child, Entity parent) {
+    Entity& first = parent == INVALID_ENTITY ? m_firstRoot : m_links[parent].firstChild;
+    Entity& last = parent == INVALID_ENTITY ? m_lastRoot : m_links[parent].lastChild;
+
+    m_links[child].prevSibling = last;
+    m_links[child].nextSibling = INVALID_ENTITY;
+    if (last != INVALID_ENTITY) {
+        m_links[last].nextSibling = child;
+    } else {
+        first = child;
+    }
+    last = child;
+}
+
+void SceneDatabase::unlinkChild(Entity child) {
+    const Entity parent = hierarchies[child].parent;
+    Entity& first = parent == INVALID_ENTITY ? m_firstRoot : m_links[parent].firstChild;
+    Entity& last = parent == INVALID_ENTITY ? m_lastRoot : m_links[parent].lastChild;
+
+    HierarchyLinks& links = m_links[child];
+    if (links.prevSibling != INVALID_ENTITY) {
+        m_links[links.prevSibling].nextSibling = links.nextSibling;
+    } else {
+        first = links.nextSibling;
+    }
+
+    if (links.nextSibling != INVALID_ENTITY) {
+        m_links[links.nextSibling].prevSibling = links.prevSibling;
+    } else {
+        last = links.prevSibling;
+    }
+
+    links.prevSibling = INVALID_ENTITY;
+    links.nextSibling = INVALID_ENTITY;
+}
+
+// Appends value-initialised rows with live handles and dirty bits set, but leaves linking and
+// level bookkeeping to the caller.
+Entity SceneDatabase::appendEntities(size_t count) {
+    const auto first = static_cast<Entity>(components.size());
+    const auto end = static_cast<Entity>(first + count);
+
+    components.resize(end);
+    m_links.resize(end);
+    m_entityHandles.resize(end);
+    m_orderPositions.resize(end, INVALID_ORDER_POSITION);
+    m_handleSlots.reserve(m_handleSlots.size() + (count > m_freeHandles.size() ? count - m_freeHandles.size() : 0));
+
+    for (Entity entity = first; entity < end; ++entity) {
+        renderables[entity].objectId = entity;
+        allocateHandle(entity);
+    }
+
+    setDirtyRange(m_transformDirtyBits, first, end);
+    setDirtyRange(m_renderableDirtyBits, first, end);
+    setDirtyRange(m_hierarchyDirtyBits, first, end);
+    m_transformsDirty = true;
+    m_renderablesDirty = true;
+    m_hierarchiesDirty = true;
+    return first;
+}
+
+void SceneDatabase::allocateHandle(Entity entity) {
+    uint32_t handleIndex;
+    if (!m_freeHandles.empty()) {
+        handleIndex = m_freeHandles.back();
+        m_freeHandles.pop_back();
+    } else {
+        handleIndex = static_cast<uint32_t>(m_handleSlots.size());
+        m_handleSlots.emplace_back();
+    }
+    m_handleSlots[handleIndex].entity = entity;
+    m_entityHandles[entity] = handleIndex;
+}
+
+void SceneDatabase::moveEntity(Entity from, Entity to) {
+    components.copyRow(from, to);
+    renderables[to].objectId = to;
+    m_links[to] = m_links[from];
+
+    m_entityHandles[to] = m_entityHandles[from];
+    m_entityHandles[from] = INVALID_ENTITY;
+    m_handleSlots[m_entityHandles[to]].entity = to;
+
+    m_orderPositions[to] = m_orderPositions[from];
+    m_orderPositions[from] = INVALID_ORDER_POSITION;
+    if (!m_orderDirty && m_orderPositions[to] != INVALID_ORDER_POSITION) {
+        sortedHierarchyList[m_orderPositions[to]] = to;
+    }
+
+    const Entity parent = hierarchies[to].parent;
+    const HierarchyLinks& links = m_links[to];
+    if (links.prevSibling != INVALID_ENTITY) {
+        m_links[links.prevSibling].nextSibling = to;
+    } else {
+        (parent == INVALID_ENTITY ? m_firstRoot : m_links[parent].firstChild) = to;
+    }
+    if (links.nextSibling != INVALID_ENTITY) {
+        m_links[links.nextSibling].prevSibling = to;
+    } else {
+        (parent == INVALID_ENTITY ? m_lastRoot : m_links[parent].lastChild) = to;
+    }
+
+    for (Entity child = links.firstChild; child != INVALID_ENTITY; child = m_links[child].nextSibling) {
+        hierarchies[child].parent = to;
+        markHierarchyRowDirty(child);
+    }
+
+    if (mobilities[to] == Mobility::Dynamic) {
+        m_dynamicEntities.push_back(to);
+    }
+
+    markTransformDirty(to);
+    markRenderableDirty(to);
+    markHierarchyRowDirty(to);
+}
+
+void SceneDatabase::popEntitySlot() {
+    components.popBack();
+    m_links.pop_back();
+    m_entityHandles.pop_back();
+    m_orderPositions.pop_back();
+}
+
+void SceneDatabase::setLevel(Entity entity, uint32_t level) {
+    const uint32_t oldLevel = hierarchies[entity].level;
+    if (oldLevel < m_levelCounts.size()) {
+        m_levelCounts[oldLevel]--;
+    }
+
+    if (level >= m_levelCounts.size()) {
+        m_levelCounts.resize(level + 1, 0);
+    }
+    m_levelCounts[level]++;
+    hierarchies[entity].level = level;
+    markHierarchyRowDirty(entity);
+    moveInLevelOrder(entity, oldLevel, level);
+}
+
+void SceneDatabase::relevelSubtree(Entity root, uint32_t level) {
+    if (hierarchies[root].level == level) {
+        return;
+    }
+
+    walkSubtree(root, [&](Entity entity, uint32_t depth) { setLevel(entity, level + depth); });
+    refreshMaxDepth();
+}
+
+void SceneDatabase::refreshMaxDepth() {
+    while (m_levelCounts.size() > 1 && m_levelCounts.back() == 0) {
+        m_levelCounts.pop_back();
+    }
+    m_maxHierarchyDepth = m_levelCounts.empty() ? 0 : static_cast<uint32_t>(m_levelCounts.size() - 1);
+    // Levels emptied at the bottom of the hierarchy hold no entries, so their offsets just go.
+    if (!m_orderDirty && hierarchyLevelOffsets.size() > m_levelCounts.size() + 1) {
+        hierarchyLevelOffsets.resize(m_levelCounts.size() + 1);
+    }
+}
+
+void SceneDatabase::rebuildHierarchyLinks() {
+    constexpr uint32_t UNVISITED_LEVEL = UINT32_MAX;
+    const size_t numEntities = hierarchies.size();
+
+    // Levels are reassigned from scratch below, so the level order is rebuilt in full afterwards.
+    m_orderDirty = true;
+    m_links.assign(numEntities, HierarchyLinks{});
+    m_levelCounts.clear();
+    m_firstRoot = INVALID_ENTITY;
+    m_lastRoot = INVALID_ENTITY;
+
+    for (Entity i = 0; i < numEntities; ++i) {
+        auto& hier = hierarchies[i];
+        if (!isAlive(i)) {
+            hier = HierarchyComponent{INVALID_ENTITY, 0};
+            continue;
+        }
+        if (hier.parent != INVALID_ENTITY && !isAlive(hier.parent)) {
+            hier.parent = INVALID_ENTITY;
+        }
+        hier.level = UNVISITED_LEVEL;
+        linkChild(i, hier.parent);
+    }
+
+    for (Entity root = m_firstRoot; root != INVALID_ENTITY; root = m_links[root].nextSibling) {
+        walkSubtree(root, [&](Entity entity, uint32_t depth) { setLevel(entity, depth); });
+    }
+
+    // Anything still unvisited hangs off a parent cycle written directly into the components.
+    // Break the cycle by promoting the first unvisited entity of each one to a root.
+    for (Entity i = 0; i < numEntities; ++i) {
+        if (!isAlive(i) || hierarchies[i].level != UNVISITED_LEVEL) {
+            continue;
+        }
+
+        unlinkChild(i);
+        hierarchies[i].parent = INVALID_ENTITY;
+        linkChild(i, INVALID_ENTITY);
+        walkSubtree(i, [&](Entity entity, uint32_t depth) { setLevel(entity, depth); });
+    }
+
+    refreshMaxDepth();
+    m_linksDirty = false;
+
+    // Parents were rewritten behind our back, so any world transform may be stale.
+    setDirtyRange(m_transformDirtyBits, 0, static_cast<Entity>(numEntities));
+    setDirtyRange(m_hierarchyDirtyBits, 0, static_cast<Entity>(numEntities));
+    m_transformsDirty = true;
+    m_hierarchiesDirty = true;
+    m_dataVersion++;
+}
+
+void SceneDatabase::flattenHierarchy() {
+    const size_t numLevels = m_levelCounts.size();
+    hierarchyLevelOffsets.assign(numLevels + 1, 0);
+    for (size_t level = 0; level < numLevels; ++level) {
+        hierarchyLevelOffsets[level + 1] = hierarchyLevelOffsets[level] + m_levelCounts[level];
+    }
+
+    // Bucket by level; within a level entities keep pre-order, so siblings start out adjacent.
+    sortedHierarchyList.resize(hierarchyLevelOffsets.back());
+    m_orderPositions.assign(components.size(), INVALID_ORDER_POSITION);
+    m_levelCursors.assign(hierarchyLevelOffsets.begin(), hierarchyLevelOffsets.end() - 1);
+    for (Entity root = m_firstRoot; root != INVALID_ENTITY; root = m_links[root].nextSibling) {
+        walkSubtree(root, [&](Entity entity, uint32_t depth) {
+            m_orderPositions[entity] = m_levelCursors[depth];
+            sortedHierarchyList[m_levelCursors[depth]++] = entity;
+        });
+    }
+
+    m_orderDirty = false;
+}
+
+void SceneDatabase::swapOrderSlots(uint32_t a, uint32_t b) {
+    std::swap(sortedHierarchyList[a], sortedHierarchyList[b]);
+    m_orderPositions[sortedHierarchyList[a]] = a;
+    m_orderPositions[sortedHierarchyList[b]] = b;
+}
+
+// The entity crosses one level boundary per step: going deeper it is swapped to the end of its
+// level and the boundary moves in front of it, going shallower the same happens at the front.
+// Moving k levels therefore costs k swaps whatever the scene size.
+void SceneDatabase::moveInLevelOrder(Entity entity, uint32_t fromLevel, uint32_t toLevel) {
+    if (m_orderDirty || fromLevel == toLevel) {
+        return;
+    }
+
+    if (hierarchyLevelOffsets.size() < toLevel + 2) {
+        hierarchyLevelOffsets.resize(toLevel + 2, hierarchyLevelOffsets.back());
+    }
+    for (uint32_t level = fromLevel; level < toLevel; ++level) {
+        swapOrderSlots(m_orderPositions[entity], hierarchyLevelOffsets[level + 1] - 1);
+        hierarchyLevelOffsets[level + 1]--;
+    }
+    for (uint32_t level = fromLevel; level > toLevel; --level) {
+        swapOrderSlots(m_orderPositions[entity], hierarchyLevelOffsets[level]);
+        hierarchyLevelOffsets[level]++;
+    }
+}
+
+// New entries are appended to the deepest level and moved up from there.
+void SceneDatabase::insertIntoLevelOrder(Entity entity, uint32_t level) {
+    if (m_orderDirty) {
+        return;
+    }
+
+    if (hierarchyLevelOffsets.size() < 2) {
+        hierarchyLevelOffsets.assign(2, static_cast<uint32_t>(sortedHierarchyList.size()));
+    }
+    m_orderPositions[entity] = static_cast<uint32_t>(sortedHierarchyList.size());
+    sortedHierarchyList.push_back(entity);
+    hierarchyLevelOffsets.back()++;
+    moveInLevelOrder(entity, static_cast<uint32_t>(hierarchyLevelOffsets.size() - 2), level);
+}
+
+void SceneDatabase::removeFromLevelOrder(Entity entity, uint32_t level) {
+    if (m_orderDirty || m_orderPositions[entity] == INVALID_ORDER_POSITION) {
+        return;
+    }
+
+    moveInLevelOrder(entity, level, static_cast<uint32_t>(hierarchyLevelOffsets.size() - 2));
+    swapOrderSlots(m_orderPositions[entity], static_cast<uint32_t>(sortedHierarchyList.size() - 1));
+    sortedHierarchyList.pop_back();
+    hierarchyLevelOffsets.back()--;
+    m_orderPositions[entity] = INVALID_ORDER_POSITION;
+}
@@ -1,85 +1,215 @@
 module;
 
 #include <cstdint>
+#include <cstddef>
+#include <span>
 #include <vector>
-#include <stack>
-#include <algorithm>
-#include <stack>
 
 export module Engine.Render.scenedatabase;
 
 import Engine.Render.entity;
 import Engine.Render.component;
+import Engine.Render.componentstorage;
+import Engine.glm;
 
-export class SceneDatabase {
-  public:
+// Half-open range [begin, end) of entity slots whose component data changed.
+export struct DirtyRange {
+    Entity begin;
+    Entity end;
+};
+
+// Sorts and merges overlapping or touching ranges. If more than `maxRanges` remain, nearby
+// ranges are merged across progressively larger gaps so uploads stay at a bounded call count.
+export void coalesceDirtyRanges(std::vector<DirtyRange>& ranges, size_t maxRanges);
+
+// Template subtree for SceneDatabase::instantiatePrefab. HierarchyComponent::parent holds an index
+// into the prefab itself and must precede the child; INVALID_ENTITY marks a prefab root. Levels
+// are ignored and recomputed.
+export struct Prefab {
     std::vector<TransformComponent> transforms;
     std::vector<HierarchyComponent> hierarchies;
     std::vector<RenderableComponent> renderables;
+};
+
+export class SceneDatabase {
+  public:
+    using Storage = ComponentStorage<TransformComponent, HierarchyComponent, RenderableComponent, Mobility>;
+
+    SceneDatabase() = default;
+    // The column aliases below point into `components`, so the database is not copyable.
+    SceneDatabase(const SceneDatabase&) = delete;
+    SceneDatabase& operator=(const SceneDatabase&) = delete;
+
+    Storage components;
+    std::vector<TransformComponent>& transforms = components.column<TransformComponent>();
+    std::vector<HierarchyComponent>& hierarchies = components.column<HierarchyComponent>();
+    std::vector<RenderableComponent>& renderables = components.column<RenderableComponent>();
+    std::vector<Mobility>& mobilities = components.column<Mobility>();
+    // Live entities ordered by hierarchy level. Level L occupies
+    // [hierarchyLevelOffsets[L], hierarchyLevelOffsets[L + 1]), so each level can be processed
+    // as one contiguous batch once all of its parents are done. Edits keep both up to date in
+    // place at a cost that follows the entities touched; the order within a level is unspecified.
     std::vector<Entity> sortedHierarchyList;
+    std::vector<uint32_t> hierarchyLevelOffsets;
     uint64_t m_hierarchyVersion = 1;
     uint64_t m_dataVersion = 1;
     uint32_t m_maxHierarchyDepth = 0;
+    // Every point light of the scene, re-uploaded and binned each frame; edit it freely.
+    std::vector<PointLight> lights;
+
+    // Reuses a destroyed slot when one is free. The returned index stays valid until the next
+    // compact(); hold an EntityHandle to refer to the entity across compactions.
+    Entity createEntity();
+
+    // Appends `count` root entities with default components and returns the first one; the new
+    // entities occupy [first, first + count). Free slots are not reused so the range is contiguous.
+    Entity createEntities(size_t count);
+
+    // Stamps `instanceCount` copies of `prefab` in one pass. Copy i occupies
+    // [first + i * size, first + (i + 1) * size) in prefab order and its roots are attached to
+    // `parent`. Returns the first entity, or INVALID_ENTITY if the prefab is malformed.
+    Entity instantiatePrefab(const Prefab& prefab, size_t instanceCount, Entity parent = INVALID_ENTITY);
+
+    // Destroys `entity` together with its whole subtree. The freed slots are reused by
+    // createEntity() and culled on the GPU until compact() removes them.
+    bool destroyEntity(Entity entity);
+    bool destroyEntity(EntityHandle handle) { return destroyEntity(resolve(handle)); }
+
+    bool isAlive(Entity entity) const { return entity < m_entityHandles.size() && m_entityHandles[entity] != INVALID_ENTITY; }
+    EntityHandle getHandle(Entity entity) const;
+    // Returns INVALID_ENTITY if the handle is stale.
+    Entity resolve(EntityHandle handle) const;
+    size_t liveEntityCount() const { return components.size() - m_freeEntities.size(); }
 
-    Entity createEntity() {
-        transforms.emplace_back();
-        hierarchies.emplace_back(HierarchyComponent{INVALID_ENTITY, 0});
-        renderables.emplace_back();
-        const auto entity = static_cast<Entity>(transforms.size() - 1);
-        renderables.back().objectId = entity;
+    // Moves up to `maxMoves` live entities from the end of the component arrays into free slots
+    // and trims the arrays, remapping parent references. Can be run with a small budget every
+    // frame. Returns true once the arrays are dense.
+    bool compact(size_t maxMoves = SIZE_MAX);
+
+    // Rewrites every column in depth-first order and drops destroyed slots, so each subtree
+    // occupies a contiguous range with its parent first and siblings adjacent. Every Entity index
+    // changes; EntityHandles stay valid and are the way to find entities again afterwards.
+    void defragment();
+
+    // Attaches `child` (and its subtree) under `parent`, or detaches it to the root level when
+    // `parent` is INVALID_ENTITY. Only the moved subtree is re-levelled and re-spliced.
+    // Returns false if either entity is out of range or the link would create a cycle.
+    bool setParent(Entity child, Entity parent);
+    void detach(Entity child) { setParent(child, INVALID_ENTITY); }
+
+    // Call after writing HierarchyComponent::parent directly; the links are rebuilt from scratch
+    // on the next updateHierarchy().
+    void markHierarchyDirty() {
+        m_linksDirty = true;
         m_hierarchyVersion++;
-        m_dataVersion++;
-        return entity;
     }
 
-    void markHierarchyDirty() { m_hierarchyVersion++; }
-    void markDataDirty() { m_dataVersion++; }
+    void setLocalTransform(Entity entity, const TransformComponent& transform);
+    void setTranslation(Entity entity, const glm::vec3& translation);
+    void markTransformDirty(Entity entity);
+    void markRenderableDirty(Entity entity);
+    // Flags every entity's transform and renderable data for upload.
+    void markDataDirty();
 
-    void updateHierarchy() {
-        if (transforms.empty()) {
-            sortedHierarchyList.clear();
-            m_maxHierarchyDepth = 0;
-            return;
-        }
+    // Dynamic entities are reported as transform-dirty by every consumeDirtyRanges() call.
+    void setMobility(Entity entity, Mobility mobility);
+    bool hasDynamicEntities() const { return !m_dynamicEntities.empty(); }
 
-        const size_t numEntities = transforms.size();
-        if (sortedHierarchyList.capacity() < numEntities) {
-            sortedHierarchyList.reserve(numEntities);
-        }
-        sortedHierarchyList.clear();
-
-        std::vector<std::vector<Entity>> children(numEntities);
-        std::vector<Entity> roots;
-        roots.reserve(numEntities);
-
-        for (Entity i = 0; i < numEntities; ++i) {
-            hierarchies[i].level = 0;
-            const auto& hier = hierarchies[i];
-            if (hier.parent != INVALID_ENTITY && hier.parent < numEntities) {
-                children[hier.parent].push_back(i);
-            } else {
-                roots.push_back(i);
-            }
-        }
+    // Moves the dirty entity ranges accumulated since the last call into the output vectors.
+    void consumeDirtyRanges(std::vector<DirtyRange>& transformRanges, std::vector<DirtyRange>& renderableRanges, std::vector<DirtyRange>& hierarchyRanges);
 
-        m_maxHierarchyDepth = 0;
-        std::stack<std::pair<Entity, uint32_t>> stack;
+    // Gathers the entities whose world transform must be recomputed after the entities in
+    // `changed` were modified: each of them and its whole subtree, bucketed by level in the same
+    // layout as sortedHierarchyList. Call after updateHierarchy(). Returns false when the changes
+    // cover most of the scene; the caller should then process sortedHierarchyList instead.
+    bool collectTransformUpdates(std::span<const DirtyRange> changed, std::vector<Entity>& entities, std::vector<uint32_t>& levelOffsets);
 
-        for (auto it = roots.rbegin(); it != roots.rend(); ++it) {
-            stack.push({*it, 0});
-        }
+    void updateHierarchy();
 
-        while (!stack.empty()) {
-            auto [current, currentLevel] = stack.top();
-            stack.pop();
+  private:
+    struct HierarchyLinks {
+        Entity firstChild = INVALID_ENTITY;
+        Entity lastChild = INVALID_ENTITY;
+        Entity prevSibling = INVALID_ENTITY;
+        Entity nextSibling = INVALID_ENTITY;
+    };
 
-            hierarchies[current].level = currentLevel;
-            sortedHierarchyList.push_back(current);
-            m_maxHierarchyDepth = std::max(m_maxHierarchyDepth, currentLevel);
+    // Pre-order walk of the subtree rooted at `root` without an explicit stack. `visit` receives
+    // each entity and its depth relative to `root`.
+    template <typename Visitor>
+    void walkSubtree(Entity root, Visitor&& visit) const {
+        Entity current = root;
+        uint32_t depth = 0;
+        while (true) {
+            visit(current, depth);
 
-            for (auto it = children[current].rbegin(); it != children[current].rend(); ++it) {
-                stack.push({*it, currentLevel + 1});
+            if (m_links[current].firstChild != INVALID_ENTITY) {
+                current = m_links[current].firstChild;
+                depth++;
+                continue;
             }
+
+            while (current != root && m_links[current].nextSibling == INVALID_ENTITY) {
+                current = hierarchies[current].parent;
+                depth--;
+            }
+
+            if (current == root) {
+                return;
+            }
+            current = m_links[current].nextSibling;
         }
     }
+
+    struct HandleSlot {
+        Entity entity = INVALID_ENTITY;
+        uint32_t generation = 0;
+    };
+
+    void linkChild(Entity child, Entity parent);
+    void unlinkChild(Entity child);
+    void setLevel(Entity entity, uint32_t level);
+    void relevelSubtree(Entity root, uint32_t level);
+    void refreshMaxDepth();
+    void rebuildHierarchyLinks();
+    void flattenHierarchy();
+    void swapOrderSlots(uint32_t a, uint32_t b);
+    void moveInLevelOrder(Entity entity, uint32_t fromLevel, uint32_t toLevel);
+    void insertIntoLevelOrder(Entity entity, uint32_t level);
+    void removeFromLevelOrder(Entity entity, uint32_t level);
+    void markHierarchyRowDirty(Entity entity);
+    Entity appendEntities(size_t count);
+    void allocateHandle(Entity entity);
+    void moveEntity(Entity from, Entity to);
+    void popEntitySlot();
+
+    std::vector<HierarchyLinks> m_links;
+    std::vector<HandleSlot> m_handleSlots;
+    std::vector<uint32_t> m_entityHandles;
+    // Index of each entity in sortedHierarchyList; only meaningful while m_orderDirty is false.
+    static constexpr uint32_t INVALID_ORDER_POSITION = UINT32_MAX;
+    std::vector<uint32_t> m_orderPositions;
+    std::vector<uint32_t> m_freeHandles;
+    std::vector<Entity> m_freeEntities;
+    std::vector<Entity> m_subtreeScratch;
+    std::vector<uint32_t> m_prefabLevels;
+    std::vector<uint32_t> m_levelCursors;
+    std::vector<Entity> m_dynamicEntities;
+    std::vector<Entity> m_updateScratch;
+    std::vector<uint32_t> m_visitMarks;
+    uint32_t m_visitGeneration = 0;
+    std::vector<uint64_t> m_transformDirtyBits;
+    std::vector<uint64_t> m_renderableDirtyBits;
+    std::vector<uint64_t> m_hierarchyDirtyBits;
+    bool m_transformsDirty = false;
+    bool m_renderablesDirty = false;
+    bool m_hierarchiesDirty = false;
+    bool m_allDataDirty = false;
+    std::vector<uint32_t> m_levelCounts;
+    Entity m_firstRoot = INVALID_ENTITY;
+    Entity m_lastRoot = INVALID_ENTITY;
+    bool m_linksDirty = false;
+    // Set until the first updateHierarchy() and after rebuildHierarchyLinks(); the next
+    // updateHierarchy() then rebuilds sortedHierarchyList in full.
+    bool m_orderDirty = true;
 };
@@ -0,0 +1,176 @@
+module;
+
+#include <algorithm>
+#include <atomic>
+#include <barrier>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <span>
+#include <stop_token>
+#include <thread>
+#include <vector>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#include <xmmintrin.h>
+#define LIT_TRANSFORM_SSE 1
+#endif
+
+module Engine.Render.transformpropagator;
+
+import Engine.Render.entity;
+import Engine.Render.component;
+import Engine.Render.scenedatabase;
+import Engine.glm;
+
+namespace {
+constexpr uint32_t CHUNK_SIZE = 1024;
+// Below this many entities the pool costs more than it saves.
+constexpr size_t PARALLEL_THRESHOLD = 16 * 1024;
+
+unsigned int resolveWorkerCount(unsigned int requested) {
+    if (requested != 0) {
+        return requested;
+    }
+    const unsigned int hardwareThreads = std::thread::hardware_concurrency();
+    return hardwareThreads > 1 ? hardwareThreads - 1 : 0;
+}
+
+// Same expansion as composeLocal() in transform.comp.
+WorldTransform composeLocal(const TransformComponent& t) {
+    const glm::quat& q = t.rotation;
+    const float xx = q.x * q.x, yy = q.y * q.y, zz = q.z * q.z;
+    const float xy = q.x * q.y, xz = q.x * q.z, yz = q.y * q.z;
+    const float wx = q.w * q.x, wy = q.w * q.y, wz = q.w * q.z;
+
+    const glm::vec3 axisX = glm::vec3(1.0f - 2.0f * (yy + zz), 2.0f * (xy + wz), 2.0f * (xz - wy)) * t.scale.x;
+    const glm::vec3 axisY = glm::vec3(2.0f * (xy - wz), 1.0f - 2.0f * (xx + zz), 2.0f * (yz + wx)) * t.scale.y;
+    const glm::vec3 axisZ = glm::vec3(2.0f * (xz + wy), 2.0f * (yz - wx), 1.0f - 2.0f * (xx + yy)) * t.scale.z;
+
+    WorldTransform m;
+    m.rows[0] = glm::vec4(axisX.x, axisY.x, axisZ.x, t.translation.x);
+    m.rows[1] = glm::vec4(axisX.y, axisY.y, axisZ.y, t.translation.y);
+    m.rows[2] = glm::vec4(axisX.z, axisY.z, axisZ.z, t.translation.z);
+    return m;
+}
+
+// a * b for affine matrices stored as rows: row_i = a_i.x * b_0 + a_i.y * b_1 + a_i.z * b_2 + (0, 0, 0, a_i.w).
+WorldTransform multiplyAffine(const WorldTransform& a, const WorldTransform& b) {
+    WorldTransform m;
+#if defined(LIT_TRANSFORM_SSE)
+    const __m128 b0 = _mm_loadu_ps(&b.rows[0].x);
+    const __m128 b1 = _mm_loadu_ps(&b.rows[1].x);
+    const __m128 b2 = _mm_loadu_ps(&b.rows[2].x);
+    const __m128 b3 = _mm_set_ps(1.0f, 0.0f, 0.0f, 0.0f);
+    for (int i = 0; i < 3; ++i) {
+        const __m128 row = _mm_loadu_ps(&a.rows[i].x);
+        __m128 result = _mm_mul_ps(_mm_shuffle_ps(row, row, _MM_SHUFFLE(0, 0, 0, 0)), b0);
+        result = _mm_add_ps(result, _mm_mul_ps(_mm_shuffle_ps(row, row, _MM_SHUFFLE(1, 1, 1, 1)), b1));
+        result = _mm_add_ps(result, _mm_mul_ps(_mm_shuffle_ps(row, row, _MM_SHUFFLE(2, 2, 2, 2)), b2));
+        result = _mm_add_ps(result, _mm_mul_ps(_mm_shuffle_ps(row, row, _MM_SHUFFLE(3, 3, 3, 3)), b3));
+        _mm_storeu_ps(&m.rows[i].x, result);
+    }
+#else
+    for (int i = 0; i < 3; ++i) {
+        const glm::vec4& row = a.rows[i];
+        m.rows[i] = row.x * b.rows[0] + row.y * b.rows[1] + row.z * b.rows[2] + glm::vec4(0.0f, 0.0f, 0.0f, row.w);
+    }
+#endif
+    return m;
+}
+} // namespace
+
+TransformPropagator::TransformPropagator(unsigned int workerCount)
+    : m_participantCount(resolveWorkerCount(workerCount) + 1), m_levelBarrier(m_participantCount, LevelCompletion{this}) {
+    m_workers.reserve(m_participantCount - 1);
+    for (unsigned int i = 0; i + 1 < m_participantCount; ++i) {
+        m_workers.emplace_back([this](std::stop_token stopToken) { workerLoop(stopToken); });
+    }
+}
+
+TransformPropagator::~TransformPropagator() {
+    for (auto& worker : m_workers) {
+        worker.request_stop();
+    }
+    m_workers.clear();
+}
+
+void TransformPropagator::propagate(const SceneDatabase& scene, std::vector<WorldTransform>& worldTransforms) {
+    propagate(scene, scene.sortedHierarchyList, scene.hierarchyLevelOffsets, worldTransforms);
+}
+
+void TransformPropagator::propagate(const SceneDatabase& scene, std::span<const Entity> order, std::span<const uint32_t> levelOffsets, std::vector<WorldTransform>& worldTransforms) {
+    worldTransforms.resize(scene.transforms.size());
+
+    if (levelOffsets.size() < 2) {
+        return;
+    }
+
+    Job job;
+    job.locals = scene.transforms.data();
+    job.hierarchies = scene.hierarchies.data();
+    job.order = order.data();
+    job.levelOffsets = levelOffsets.data();
+    job.levelCount = levelOffsets.size() - 1;
+    job.worlds = worldTransforms.data();
+
+    if (m_workers.empty() || order.size() < PARALLEL_THRESHOLD) {
+        for (size_t level = 0; level < job.levelCount; ++level) {
+            processRange(job, levelOffsets[level], levelOffsets[level + 1]);
+        }
+        return;
+    }
+
+    {
+        std::lock_guard lock(m_mutex);
+        m_job = job;
+        m_jobGeneration++;
+    }
+    m_jobReady.notify_all();
+    runJob(job);
+}
+
+void TransformPropagator::LevelCompletion::operator()() noexcept { owner->m_nextChunk.store(0, std::memory_order_relaxed); }
+
+void TransformPropagator::workerLoop(std::stop_token stopToken) {
+    uint64_t seenGeneration = 0;
+    while (true) {
+        Job job;
+        {
+            std::unique_lock lock(m_mutex);
+            if (!m_jobReady.wait(lock, stopToken, [&] { return m_jobGeneration != seenGeneration; })) {
+                return;
+            }
+            seenGeneration = m_jobGeneration;
+            job = m_job;
+        }
+        runJob(job);
+    }
+}
+
+// Every participant walks the levels in lockstep; the barrier between levels publishes the parent
+// results of level L before any thread reads them for level L + 1.
+void TransformPropagator::runJob(const Job& job) {
+    for (size_t level = 0; level < job.levelCount; ++level) {
+        const uint32_t begin = job.levelOffsets[level];
+        const uint32_t end = job.levelOffsets[level + 1];
+        const uint32_t chunkCount = (end - begin + CHUNK_SIZE - 1) / CHUNK_SIZE;
+
+        for (uint32_t chunk = m_nextChunk.fetch_add(1, std::memory_order_relaxed); chunk < chunkCount; chunk = m_nextChunk.fetch_add(1, std::memory_order_relaxed)) {
+            const uint32_t chunkBegin = begin + chunk * CHUNK_SIZE;
+            processRange(job, chunkBegin, std::min(end, chunkBegin + CHUNK_SIZE));
+        }
+
+        m_levelBarrier.arrive_and_wait();
+    }
+}
+
+void TransformPropagator::processRange(const Job& job, uint32_t begin, uint32_t end) {
+    for (uint32_t i = begin; i < end; ++i) {
+        const Entity entity = job.order[i];
+        const WorldTransform local = composeLocal(job.locals[entity]);
+        const Entity parent = job.hierarchies[entity].parent;
+        job.worlds[entity] = parent == INVALID_ENTITY ? local : multiplyAffine(job.worlds[parent], local);
+    }
+}
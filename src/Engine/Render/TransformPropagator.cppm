@@ -0,0 +1,72 @@
+module;
+
+#include <atomic>
+#include <barrier>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <span>
+#include <stop_token>
+#include <thread>
+#include <vector>
+
+export module Engine.Render.transformpropagator;
+
+import Engine.Render.entity;
+import Engine.Render.component;
+import Engine.Render.scenedatabase;
+
+// CPU counterpart of transform.comp. Walks SceneDatabase's level-ordered hierarchy one level at a
+// time, splitting each level into chunks that a small worker pool and the calling thread process
+// in parallel. Used by builds without a GPU, as a per-frame alternative backend in the renderer,
+// and as a reference when checking the GPU path.
+export class TransformPropagator {
+  public:
+    // 0 picks hardware_concurrency() - 1 workers. The calling thread always takes part.
+    explicit TransformPropagator(unsigned int workerCount = 0);
+    ~TransformPropagator();
+
+    TransformPropagator(const TransformPropagator&) = delete;
+    TransformPropagator& operator=(const TransformPropagator&) = delete;
+
+    // Computes the world transform of every live entity into `worldTransforms`, indexed by
+    // Entity and resized to the entity count. Call after SceneDatabase::updateHierarchy().
+    void propagate(const SceneDatabase& scene, std::vector<WorldTransform>& worldTransforms);
+
+    // Same, restricted to `order`: level-ordered entities whose levels start at `levelOffsets`, as
+    // built by SceneDatabase::collectTransformUpdates(). Parents outside `order` must already hold
+    // their current world transform in `worldTransforms`; everything else is left untouched.
+    void propagate(const SceneDatabase& scene, std::span<const Entity> order, std::span<const uint32_t> levelOffsets, std::vector<WorldTransform>& worldTransforms);
+
+    unsigned int workerCount() const { return static_cast<unsigned int>(m_workers.size()); }
+
+  private:
+    struct Job {
+        const TransformComponent* locals = nullptr;
+        const HierarchyComponent* hierarchies = nullptr;
+        const Entity* order = nullptr;
+        const uint32_t* levelOffsets = nullptr;
+        size_t levelCount = 0;
+        WorldTransform* worlds = nullptr;
+    };
+
+    // Runs once per level after every participant has arrived at the barrier.
+    struct LevelCompletion {
+        TransformPropagator* owner;
+        void operator()() noexcept;
+    };
+
+    void workerLoop(std::stop_token stopToken);
+    void runJob(const Job& job);
+    static void processRange(const Job& job, uint32_t begin, uint32_t end);
+
+    unsigned int m_participantCount;
+    std::mutex m_mutex;
+    std::condition_variable_any m_jobReady;
+    uint64_t m_jobGeneration = 0;
+    Job m_job;
+    std::atomic<uint32_t> m_nextChunk{0};
+    std::barrier<LevelCompletion> m_levelBarrier;
+    std::vector<std::jthread> m_workers;
+};